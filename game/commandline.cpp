@@ -122,6 +122,55 @@ CommandLine::CommandLine(int argc, const char** argv) {
           }
         }
       }
+    else if(arg=="-luacache") {
+      ++i;
+      if(i<argc)
+        luaCache = boolArg(argv[i]);
+      }
+    else if(arg=="-luabudget") {
+      ++i;
+      if(i<argc) {
+        try {
+          luaBudget = uint32_t(std::stoul(std::string(argv[i])));
+          }
+        catch (const std::exception& e) {
+          Log::i("failed to read lua budget: \"", std::string(argv[i]), "\"");
+          }
+        }
+      }
+    else if(arg=="-luamem") {
+      // per script limits in MB: <soft>[,<hard>], 0 disables a limit
+      ++i;
+      if(i<argc) {
+        std::string_view v     = argv[i];
+        const size_t     comma = v.find(',');
+        try {
+          luaMemSoft = uint32_t(std::stoul(std::string(v.substr(0, comma))));
+          if(comma!=std::string_view::npos)
+            luaMemHard = uint32_t(std::stoul(std::string(v.substr(comma+1))));
+          }
+        catch (const std::exception& e) {
+          Log::i("failed to read lua memory limits: \"", std::string(v), "\"");
+          }
+        }
+      }
+    else if(arg=="-luanative") {
+      ++i;
+      if(i<argc) {
+        std::string_view v = argv[i];
+        if(v=="all")
+          luaNativeMode = LuaNative::NativeAll;
+        else if(v=="annotated")
+          luaNativeMode = LuaNative::NativeAnnotated;
+        else if(v=="off" || !boolArg(v))
+          luaNativeMode = LuaNative::NativeOff;
+        else
+          Log::i("unknown lua native mode: \"", std::string(v), "\"");
+        }
+      }
+    else if(arg=="-luawatch") {
+      luaWatch = true;
+      }
     else if(arg=="-gi") {
       ++i;
       if(i<argc)
@@ -23,6 +23,11 @@ class CommandLine {
       Vulkan,
       DirectX12
       };
+    enum LuaNative : uint8_t {
+      NativeAll,
+      NativeAnnotated,
+      NativeOff,
+      };
     auto                graphicsApi() const -> GraphicBackend;
     std::u16string_view rootPath() const;
     std::u16string      scriptPath() const;
@@ -47,6 +52,12 @@ class CommandLine {
     bool                doForceG2()        const { return forceG2;      }
     bool                doForceG2NR()      const { return forceG2NR;    }
     bool                aaPreset()         const { return aaPresetId;   }
+    bool                isLuaBytecodeCache() const { return luaCache;   }
+    uint32_t            luaBudgetMs()      const { return luaBudget;    }
+    uint32_t            luaMemSoftMb()     const { return luaMemSoft;   }
+    uint32_t            luaMemHardMb()     const { return luaMemHard;   }
+    LuaNative           luaNative()        const { return luaNativeMode; }
+    bool                isLuaWatch()       const { return luaWatch;     }
     std::string_view    defaultSave()      const { return saveDef;    }
 
     std::string         wrldDef;
@@ -78,6 +89,12 @@ class CommandLine {
     bool                forceG1      = false;
     bool                forceG2      = false;
     bool                forceG2NR    = false;
+    bool                luaCache     = true;
+    uint32_t            luaBudget    = 50;
+    uint32_t            luaMemSoft   = 64;
+    uint32_t            luaMemHard   = 256;
+    LuaNative           luaNativeMode = LuaNative::NativeAll;
+    bool                luaWatch     = false;
     uint32_t            aaPresetId = 0;
   };
 
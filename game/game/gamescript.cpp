@@ -835,6 +835,29 @@ size_t GameScript::symbolsCount() const {
   return vm.symbols().size();
   }
 
+std::span<const uint32_t> GameScript::symbolsWithParent(size_t parent) {
+  auto& sym = vm.symbols();
+  if(symParentBegin.size()!=sym.size()+1) {
+    // counting sort by parent: one flat array, a lookup is O(matches)
+    symParentBegin.assign(sym.size()+1, 0);
+    for(auto& s:sym)
+      if(s.parent()<sym.size())
+        ++symParentBegin[s.parent()+1];
+    for(size_t i=1; i<symParentBegin.size(); ++i)
+      symParentBegin[i] += symParentBegin[i-1];
+
+    std::vector<uint32_t> at(symParentBegin.begin(), symParentBegin.end()-1);
+    symByParent.resize(symParentBegin.back());
+    for(auto& s:sym)
+      if(s.parent()<sym.size())
+        symByParent[at[s.parent()]++] = s.index();
+    }
+
+  if(parent>=sym.size())
+    return {};
+  return std::span<const uint32_t>(symByParent).subspan(symParentBegin[parent], symParentBegin[parent+1]-symParentBegin[parent]);
+  }
+
 const AiState& GameScript::aiState(ScriptFn id) {
   auto it = aiStates.find(id.ptr);
   if(it!=aiStates.end())
@@ -7,6 +7,7 @@
 #include <memory>
 #include <set>
 #include <random>
+#include <span>
 
 #include <Tempest/Matrix4x4>
 #include <Tempest/Painter>
@@ -112,6 +113,8 @@ class GameScript final {
     zenkit::DaedalusSymbol*     findSymbol(const size_t s);
     size_t                      findSymbolIndex(std::string_view s);
     size_t                      symbolsCount() const;
+    // indices of all symbols whose parent is `parent` (class or prototype), in symbol order
+    auto                        symbolsWithParent(size_t parent) -> std::span<const uint32_t>;
 
     const AiState&              aiState  (ScriptFn id);
     const zenkit::ISpell&       spellDesc(int32_t splId);
@@ -482,6 +485,8 @@ class GameScript final {
     float                                                       viewTimePerChar = 0.5;
     int32_t                                                     damCriticalMultiplier = 2;
     mutable std::unordered_map<std::string,uint32_t>            msgTimings;
+    std::vector<uint32_t>                                       symParentBegin; // built on first symbolsWithParent
+    std::vector<uint32_t>                                       symByParent;
     size_t                                                      gilTblSize=0;
     size_t                                                      gilCount=0;
     std::vector<int32_t>                                        gilAttitudes;
@@ -169,9 +169,16 @@ GameSession::GameSession(Serialize &fin) {
   // Always clear storage first to avoid leaking values across sessions.
   if(auto* lua = Gothic::inst().luaScript()) {
     lua->deserialize({});
-    if(fin.setEntry("game/lua")) {
+    if(fin.setEntry("game/lua_storage")) {
       lua->load(fin);
       }
+    else if(fin.setEntry("game/lua")) {
+      lua->loadLegacy(fin);
+      }
+    lua->dropTasks();
+    if(fin.setEntry("game/lua_async")) {
+      lua->loadTasks(fin);
+      }
     }
 
   if(auto hero = wrld->player())
@@ -238,8 +245,10 @@ void GameSession::save(Serialize &fout, std::string_view name, const Pixmap& scr
 
   // Save Lua script state
   if(auto* lua = Gothic::inst().luaScript()) {
-    fout.setEntry("game/lua");
+    fout.setEntry("game/lua_storage");
     lua->save(fout);
+    fout.setEntry("game/lua_async");
+    lua->saveTasks(fout);
     }
 
   Gothic::inst().setLoadingProgress(80);
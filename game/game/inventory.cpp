@@ -87,6 +87,12 @@ Inventory::Inventory() {
 Inventory::~Inventory() {
   }
 
+// inventory item is about to be destroyed: scripts may still hold it
+static void notifyItemRemove(const Item& it) {
+  if(Gothic::inst().onItemRemove)
+    Gothic::inst().onItemRemove(it);
+  }
+
 bool Inventory::isEmpty() const {
   return items.size()==0 && active==nullptr;
   }
@@ -236,6 +242,7 @@ Item* Inventory::addItem(std::unique_ptr<Item> &&p) {
     it->setCount(it->count()+p->count());
     it->handle().owner       = p->handle().owner;
     it->handle().owner_guild = p->handle().owner_guild;
+    notifyItemRemove(*p);
     return p.get();
     }
   }
@@ -304,6 +311,7 @@ void Inventory::delItem(Item *it, size_t count, Npc& owner) {
 
   for(size_t i=0;i<items.size();++i)
     if(items[i]->clsId()==it->clsId()){
+      notifyItemRemove(*items[i]);
       items.erase(items.begin()+int(i));
       break;
       }
@@ -581,6 +589,8 @@ void Inventory::clear(GameScript&, Npc&, bool includeMissionItm) {
   for(auto& i:items)
     if(i->isEquipped() || (i->isMission() && !includeMissionItm)){
       used.emplace_back(std::move(i));
+      } else {
+      notifyItemRemove(*i);
       }
   items = std::move(used); // Gothic don't clear items, which are in use
   }
@@ -590,6 +600,8 @@ void Inventory::clear(GameScript& vm, Interactive& owner, bool includeMissionItm
   for(auto& i:items)
     if(i->isMission() && !includeMissionItm){
       used.emplace_back(std::move(i));
+      } else {
+      notifyItemRemove(*i);
       }
   items = std::move(used); // Gothic don't clear items, which are in use
   }
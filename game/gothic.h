@@ -192,6 +192,7 @@ class Gothic final {
     std::function<bool(Npc&, Npc&, size_t, size_t, bool)>               onTrade;         // buyer, seller, itemId, count, isBuying
     std::function<void(Npc&)>                                           onNpcSpawn;      // npc (notification only)
     std::function<void(Npc&)>                                           onNpcRemove;     // npc (notification only)
+    std::function<void(const Item&)>                                    onItemRemove;    // item (notification only, removed from world or destroyed in an inventory)
     std::function<bool(Npc&, Interactive&)>                             onMobInteract;   // npc, mob (before using non-container interactive)
     std::function<bool(Npc&)>                                           onJump;          // npc
     std::function<void(Npc&)>                                           onSwimStart;     // npc (notification only)
@@ -3,6 +3,8 @@
 #include <charconv>
 #include <cstdint>
 #include <cctype>
+#include <cstdio>
+#include <fstream>
 
 #include "utils/string_frm.h"
 #include "world/objects/npc.h"
@@ -150,10 +152,27 @@ Marvin::Marvin() {
     {"toggle gi",                  C_ToggleGI},
     {"toggle vsm",                 C_ToggleVsm},
     {"toggle rtsm",                C_ToggleRtsm},
+    {"waybench",                   C_WayBench},
+    {"npcthink %s",                C_NpcThink},
+    {"npcthink",                   C_NpcThink},
+    {"worldhash",                  C_WorldHash},
+    {"ailod budget %d %d",         C_AiLodBudget},
+    {"ailod %d %d",                C_AiLod},
+    {"ailod",                      C_AiLod},
 
     // luau scripting
+    {"reloadlua %s",               C_LuaReload},
     {"reloadlua",                  C_LuaReload},
     {"listlua",                    C_LuaList},
+    {"luaevents",                  C_LuaEvents},
+    {"luamem",                     C_LuaMem},
+    {"luaprof budget %f",          C_LuaProfBudget},
+    {"luaprof %s",                 C_LuaProf},
+    {"luaprof",                    C_LuaProf},
+    {"luacache",                   C_LuaCache},
+    {"luaexpr del %d",             C_LuaExprDel},
+    {"luaexpr clear",              C_LuaExprClear},
+    {"luaexpr",                    C_LuaExpr},
     };
   }
 
@@ -270,6 +289,15 @@ bool Marvin::exec(std::string_view v) {
       print(result);
     return true;
     }
+  if(v.size() > 12 && v.substr(0, 12) == "luaexpr add ") {
+    auto* luaVm = Gothic::inst().luaScript();
+    if(luaVm == nullptr)
+      return false;
+    std::string err;
+    auto id = luaVm->addWatchExpr(std::string(v.substr(12)), err);
+    print(id!=0 ? string_frm("Lua expression ", id, " added") : string_frm("Error: ", err));
+    return true;
+    }
 
   auto ret = recognize(v);
   switch(ret.cmd.type) {
@@ -481,6 +509,79 @@ bool Marvin::exec(std::string_view v) {
     case C_ToggleRtsm:
       Gothic::inst().toggleRtsm();
       return true;
+    case C_WayBench: {
+      World* world = Gothic::inst().world();
+      if(world==nullptr)
+        return false;
+      auto b = world->wayBenchmark();
+      print(string_frm("waynet: ", b.queries, " routine paths (", b.noPath, " unreachable), ",
+                       b.queries>0 ? size_t(b.expanded/b.queries) : size_t(0), " nodes expanded per query"));
+      print(string_frm("  ", b.coldUs, " us per query, ", b.warmUs, " us cached"));
+      return true;
+      }
+
+    case C_NpcThink: {
+      World* world = Gothic::inst().world();
+      if(world==nullptr)
+        return false;
+      static const char* names[] = {"serial", "parallel", "verify"};
+      auto arg = ret.argv[0];
+      for(uint8_t i=0; i<3; ++i) {
+        if(arg!=names[i])
+          continue;
+        world->setNpcThink(WorldObjects::NpcThink(i));
+        world->resetThinkStats();
+        print(string_frm("npc think: ", names[i]));
+        return true;
+        }
+      if(!arg.empty())
+        return false;
+      auto& st = world->thinkStats();
+      print(string_frm("npc think: ", names[uint8_t(world->npcThink())], ", ", st.ticks, " ticks, ", st.npcs, " npcs"));
+      print(string_frm("  rays ahead ", st.thinkRays, ", reused ", st.hits, ", cast late ", st.misses, ", mismatches ", st.mismatches));
+      return true;
+      }
+    case C_WorldHash: {
+      World* world = Gothic::inst().world();
+      if(world==nullptr)
+        return false;
+      char buf[32] = {};
+      std::snprintf(buf,sizeof(buf),"%016llx",static_cast<unsigned long long>(world->stateHash()));
+      print(string_frm("world state: ", buf));
+      return true;
+      }
+
+    case C_AiLod: {
+      World* world = Gothic::inst().world();
+      if(world==nullptr)
+        return false;
+      if(!ret.argv[0].empty()) {
+        auto lod = world->aiLod();
+        if(!fromString(ret.argv[0],lod.farPeriod) || !fromString(ret.argv[1],lod.far2Period))
+          return false;
+        world->setAiLod(lod);
+        world->resetAiLodStats();
+        }
+      auto& lod = world->aiLod();
+      auto& st  = world->aiLodStats();
+      print(string_frm("ai lod: far every ", lod.farPeriod, ", far2 every ", lod.far2Period, " frames, budget ",
+                       lod.farBudget, "/", lod.far2Budget));
+      print(string_frm("  ticked: player ", st.ticked[0], ", normal ", st.ticked[1], ", far ", st.ticked[2], ", far2 ", st.ticked[3],
+                       "; skipped ", st.skipped[2]+st.skipped[3], ", deferred ", st.deferred));
+      return true;
+      }
+    case C_AiLodBudget: {
+      World* world = Gothic::inst().world();
+      if(world==nullptr)
+        return false;
+      auto lod = world->aiLod();
+      if(!fromString(ret.argv[0],lod.farBudget) || !fromString(ret.argv[1],lod.far2Budget))
+        return false;
+      world->setAiLod(lod);
+      world->resetAiLodStats();
+      print(string_frm("ai lod budget: far ", lod.farBudget, ", far2 ", lod.far2Budget, " (0 - unlimited)"));
+      return true;
+      }
 
     case C_Lua:
       // Handled specially before recognize() to capture full line
@@ -489,6 +590,11 @@ bool Marvin::exec(std::string_view v) {
       auto* luaVm = Gothic::inst().luaScript();
       if(luaVm==nullptr)
         return false;
+      if(!ret.argv[0].empty()) {
+        const bool ok = luaVm->reloadScript(std::string(ret.argv[0]));
+        print(ok ? "Lua script reloaded" : "Lua script not reloaded (unchanged or failed)");
+        return true;
+        }
       luaVm->reloadAllScripts();
       print("Lua scripts reloaded");
       return true;
@@ -507,6 +613,119 @@ bool Marvin::exec(std::string_view v) {
         }
       return true;
       }
+    case C_LuaEvents: {
+      auto* luaVm = Gothic::inst().luaScript();
+      if(luaVm==nullptr)
+        return false;
+      print("Lua events (dispatched / skipped-empty / filtered):");
+      for(const auto& e : luaVm->eventStats()) {
+        if(e.dispatched==0 && e.skippedEmpty==0 && e.skippedFiltered==0)
+          continue;
+        print(string_frm("  ", e.name, ": ", size_t(e.dispatched), " / ", size_t(e.skippedEmpty), " / ", size_t(e.skippedFiltered)));
+        }
+      return true;
+      }
+    case C_LuaMem: {
+      auto* luaVm = Gothic::inst().luaScript();
+      if(luaVm==nullptr)
+        return false;
+      auto& st = luaVm->scriptAllocator().stats();
+      print(string_frm("Lua memory: ", st.liveBytes/1024, " KB in use, ", st.reservedBytes/1024, " KB reserved, ",
+                       st.arenas, " arenas"));
+      for(const auto& m : luaVm->memoryStats()) {
+        if(m.bytes==0)
+          continue;
+        print(string_frm("  ", m.module.empty() ? std::string("(engine)") : m.module, ": ", m.bytes/1024, " KB",
+                         m.disabled ? " (disabled)" : ""));
+        }
+      return true;
+      }
+    case C_LuaProf: {
+      auto* luaVm = Gothic::inst().luaScript();
+      if(luaVm==nullptr)
+        return false;
+      auto& prof = luaVm->scriptProfiler();
+      auto  arg  = ret.argv[0];
+      if(arg=="on" || arg=="off") {
+        luaVm->setProfiling(arg=="on");
+        print(string_frm("Lua profiler: ", arg));
+        return true;
+        }
+      if(arg=="reset") {
+        prof.reset();
+        return true;
+        }
+      if(arg=="csv" || arg=="json") {
+        const char*   path = (arg=="csv") ? "luaprof.csv" : "luaprof.json";
+        std::ofstream fout(path, std::ios::binary | std::ios::trunc);
+        if(!fout)
+          return false;
+        fout << (arg=="csv" ? prof.toCsv() : prof.toJson());
+        print(string_frm("Lua profile written to ", path));
+        return true;
+        }
+      if(!arg.empty())
+        return false;
+      if(!prof.isEnabled()) {
+        print("Lua profiler is off, use 'luaprof on'");
+        return true;
+        }
+      print(string_frm("Lua profile, last ", prof.windowFrames(), " frames, budget ", prof.frameBudget(), " ms:"));
+      for(auto& ln:prof.report(16))
+        print(ln);
+      return true;
+      }
+    case C_LuaProfBudget: {
+      auto* luaVm = Gothic::inst().luaScript();
+      if(luaVm==nullptr)
+        return false;
+      float ms = 0;
+      if(!fromString(ret.argv[0], ms) || ms<0)
+        return false;
+      luaVm->scriptProfiler().setFrameBudget(ms);
+      print(string_frm("Lua frame budget: ", ms, " ms"));
+      return true;
+      }
+    case C_LuaCache: {
+      auto* luaVm = Gothic::inst().luaScript();
+      if(luaVm==nullptr)
+        return false;
+      auto   st    = luaVm->consoleStats();
+      auto   total = st.hits+st.misses;
+      size_t rate  = total>0 ? size_t(st.hits*100/total) : 0;
+      print(string_frm("Lua console cache: ", st.entries, "/", st.capacity, " snippets, ", size_t(st.hits), " hits, ",
+                       size_t(st.misses), " misses (", rate, "% hit rate), compile ", st.compileMs, " ms"));
+      return true;
+      }
+    case C_LuaExpr: {
+      auto* luaVm = Gothic::inst().luaScript();
+      if(luaVm==nullptr)
+        return false;
+      auto ws = luaVm->watchExprs();
+      if(ws.empty()) {
+        print("No Lua watch expressions, use 'luaexpr add <expr>'");
+        return true;
+        }
+      for(auto& w:ws)
+        print(string_frm("  [", w.id, "] ", w.expr, " = ", w.value));
+      return true;
+      }
+    case C_LuaExprDel: {
+      auto* luaVm = Gothic::inst().luaScript();
+      if(luaVm==nullptr)
+        return false;
+      int id = 0;
+      if(!fromString(ret.argv[0], id) || id<=0)
+        return false;
+      return luaVm->removeWatchExpr(uint32_t(id));
+      }
+    case C_LuaExprClear: {
+      auto* luaVm = Gothic::inst().luaScript();
+      if(luaVm==nullptr)
+        return false;
+      luaVm->clearWatchExprs();
+      return true;
+      }
     }
 
   return true;
@@ -63,11 +63,24 @@ class Marvin {
       C_ToggleGI,
       C_ToggleVsm,
       C_ToggleRtsm,
+      C_WayBench,
+      C_NpcThink,
+      C_WorldHash,
+      C_AiLod,
+      C_AiLodBudget,
 
       // luau scripting
       C_Lua,
       C_LuaReload,
       C_LuaList,
+      C_LuaEvents,
+      C_LuaMem,
+      C_LuaProf,
+      C_LuaProfBudget,
+      C_LuaCache,
+      C_LuaExpr,
+      C_LuaExprDel,
+      C_LuaExprClear,
       };
 
     struct Cmd {
@@ -5,29 +5,12 @@
 -- Persistent Storage System
 -- ============================================================
 
--- Storage table - modders put persistent data here
+-- Storage table - modders put persistent data here; strings, numbers, booleans
+-- and (nested) tables are saved
 opengothic.storage = {}
 
--- Serialize storage to string map (called from C++)
-function opengothic._serializeStorage()
-    local result = {}
-    for key, value in pairs(opengothic.storage) do
-        if type(key) == "string" then
-            local t = type(value)
-            if t == "string" then
-                result[key] = "s:" .. value
-            elseif t == "number" then
-                result[key] = "n:" .. tostring(value)
-            elseif t == "boolean" then
-                result[key] = "b:" .. (value and "1" or "0")
-            -- Ignore other types (functions, tables, userdata)
-            end
-        end
-    end
-    return result
-end
-
--- Deserialize storage from string map (called from C++)
+-- Load storage from the legacy string map of 'game/lua' (called from C++);
+-- current saves are encoded in C++ (storagecodec)
 function opengothic._deserializeStorage(data)
     opengothic.storage = {}
     if not data then return end
@@ -52,10 +35,112 @@ opengothic.events = {
     _nextHandlerId = 1
 }
 
-function opengothic.events.register(eventName, callback)
+-- Hand the handler list of an event to C++: dispatch goes straight to the list
+-- through a registry ref and is skipped entirely while no live handler exists
+local function _publishHandlers(eventName, handlers)
+    local live = 0
+    for _, entry in ipairs(handlers) do
+        if entry.callback ~= nil then
+            live = live + 1
+        end
+    end
+    opengothic._setEventHandlers(eventName, handlers, live)
+end
+
+-- Handler filter of events.register: instance names are resolved once here, the
+-- engine compiles the result into a C++ predicate (see ScriptEngine::EventFilter).
+-- Returns nil, true for "no filter" and nil, false for invalid options.
+local function _compileFilter(eventName, options)
+    local filter = {}
+    local any = false
+    for _, key in ipairs({"npcInstance", "itemInstance"}) do
+        local value = options[key]
+        if type(value) == "string" then
+            value = opengothic.resolve(value)
+            if value == nil then
+                return nil, false
+            end
+        end
+        if value ~= nil then
+            if type(value) ~= "number" then
+                return nil, false
+            end
+            filter[key] = value
+            any = true
+        end
+    end
+    if options.isPlayer ~= nil then
+        if type(options.isPlayer) ~= "boolean" then
+            return nil, false
+        end
+        filter.isPlayer = options.isPlayer
+        any = true
+    end
+    if options.percType ~= nil then
+        if eventName ~= "onNpcPerception" or type(options.percType) ~= "number" then
+            return nil, false
+        end
+        filter.percType = options.percType
+        any = true
+    end
+    if not any then
+        return nil, true
+    end
+    return filter, true
+end
+
+-- Lua-side test of a filter, for dispatches that did not go through the C++ predicate
+-- (_dispatchEvent). Same rules: the first Npc and the first Item argument, the first number
+local function _filterMatches(filter, ...)
+    local isNpc, isItem = opengothic.core.isNpc, opengothic.core.isItem
+    local npc, item, code
+    for i = 1, select("#", ...) do
+        local value = select(i, ...)
+        if npc == nil and isNpc(value) then
+            npc = value
+        elseif item == nil and isItem(value) then
+            item = value
+        elseif code == nil and type(value) == "number" then
+            code = value
+        end
+    end
+
+    if filter.npcInstance ~= nil and (npc == nil or npc:instanceId() ~= filter.npcInstance) then
+        return false
+    end
+    if filter.isPlayer ~= nil and (npc == nil or npc:isPlayer() ~= filter.isPlayer) then
+        return false
+    end
+    if filter.itemInstance ~= nil and (item == nil or item:clsId() ~= filter.itemInstance) then
+        return false
+    end
+    if filter.percType ~= nil and code ~= filter.percType then
+        return false
+    end
+    return true
+end
+
+-- options.coroutine: run the handler as a coroutine; it may yield (or be preempted by
+-- the execution budget) and is resumed on the next update, such a dispatch counts as not handled
+-- options.npcInstance / itemInstance (symbol id or name), options.isPlayer, options.percType
+-- (onNpcPerception only): the handler runs only for events whose first Npc / first Item /
+-- perception type match; engine hooks test this before entering Lua
+function opengothic.events.register(eventName, callback, options)
     if type(eventName) ~= "string" or type(callback) ~= "function" then
         return nil
     end
+    if options ~= nil and type(options) ~= "table" then
+        return nil
+    end
+
+    local filter = nil
+    if options ~= nil then
+        local valid
+        filter, valid = _compileFilter(eventName, options)
+        if not valid then
+            return nil
+        end
+    end
 
     if not opengothic.events._handlers[eventName] then
         opengothic.events._handlers[eventName] = {}
@@ -65,8 +150,13 @@ function opengothic.events.register(eventName, callback)
     opengothic.events._nextHandlerId = handlerId + 1
     table.insert(opengothic.events._handlers[eventName], {
         id = handlerId,
-        callback = callback
+        event = eventName,
+        callback = callback,
+        coroutine = (options ~= nil and options.coroutine == true) or nil,
+        filter = filter,
+        module = opengothic._callerModule()
     })
+    _publishHandlers(eventName, opengothic.events._handlers[eventName])
 
     return handlerId
 end
@@ -87,6 +177,7 @@ function opengothic.events.unregister(eventName, handlerId)
                 return false
             end
             entry.callback = nil
+            _publishHandlers(eventName, handlers)
             return true
         end
     end
@@ -94,24 +185,147 @@ function opengothic.events.unregister(eventName, handlerId)
     return false
 end
 
--- Called from C++ to dispatch events
-function opengothic._dispatchEvent(eventName, ...)
-    local handlers = opengothic.events._handlers[eventName]
-    if not handlers then
-        return false
+-- Called from C++ when a script is reloaded or disabled: drops the handlers it registered,
+-- handlers of other scripts keep their ids. 'fromId'/'toId' (optional) limit it to ids in [fromId, toId)
+function opengothic.events._unregisterModule(module, fromId, toId)
+    local count = 0
+    fromId = fromId or 0
+    toId = toId or math.huge
+    for eventName, handlers in pairs(opengothic.events._handlers) do
+        local changed = false
+        for _, entry in ipairs(handlers) do
+            if entry.module == module and entry.callback ~= nil and entry.id >= fromId and entry.id < toId then
+                entry.callback = nil
+                changed = true
+                count = count + 1
+            end
+        end
+        if changed then
+            _publishHandlers(eventName, handlers)
+        end
+    end
+    return count
+end
+
+-- Per-event counters: { [eventName] = { dispatched, skipped, handlers } }
+-- 'skipped' counts hook calls that never entered Lua because no handler was registered
+function opengothic.events.stats()
+    return opengothic._eventStats()
+end
+
+-- 'matched' is the result of the C++ filter test: true when every live handler passed,
+-- a table of handler index -> boolean when only some did, nil when filters were not tested
+local function _selected(entry, index, matched, ...)
+    if matched ~= nil then
+        return matched[index] ~= false
     end
+    return _filterMatches(entry.filter, ...)
+end
 
-    for _, entry in ipairs(handlers) do
-        if entry.callback ~= nil then
-            local handled = entry.callback(...)
+-- Called from C++ with the handler list of an interned event. Each handler allocates
+-- for the module that registered it; the caller's module is restored on return
+function opengothic._dispatchHandlers(handlers, matched, ...)
+    local enterModule = opengothic._enterModule
+    local entered, outer, current = false, nil, nil
+    for i, entry in ipairs(handlers) do
+        local callback = entry.callback
+        if callback ~= nil and (matched == true or entry.filter == nil or _selected(entry, i, matched, ...)) then
+            if not entered or entry.module ~= current then
+                local prev = enterModule(entry.module)
+                if not entered then
+                    entered, outer = true, prev
+                end
+                current = entry.module
+            end
+            local handled
+            if entry.coroutine then
+                handled = opengothic._runHandlerThread(entry.id, entry.event, callback, ...)
+            else
+                handled = callback(...)
+            end
             if handled then
+                enterModule(outer)
                 return true
             end
         end
     end
+    if entered then
+        enterModule(outer)
+    end
     return false
 end
 
+-- Used instead of _dispatchHandlers while the profiler is on (luaprof console command)
+function opengothic._dispatchHandlersProfiled(handlers, matched, ...)
+    local profileCall = opengothic._profileCall
+    local enterModule = opengothic._enterModule
+    local entered, outer = false, nil
+    for i, entry in ipairs(handlers) do
+        if entry.callback ~= nil and (matched == true or entry.filter == nil or _selected(entry, i, matched, ...)) then
+            local prev = enterModule(entry.module)
+            if not entered then
+                entered, outer = true, prev
+            end
+            local handled
+            if entry.coroutine then
+                handled = profileCall("handler", entry.id, entry.event, opengothic._runHandlerThread, entry.id, entry.event, entry.callback, ...)
+            else
+                handled = profileCall("handler", entry.id, entry.event, entry.callback, ...)
+            end
+            if handled then
+                enterModule(outer)
+                return true
+            end
+        end
+    end
+    if entered then
+        enterModule(outer)
+    end
+    return false
+end
+
+-- Dispatch by name (custom events, tests); also wakes async.waitEvent(eventName)
+function opengothic._dispatchEvent(eventName, ...)
+    local handlers = opengothic.events._handlers[eventName]
+    local handled = false
+    if handlers then
+        handled = opengothic._dispatchHandlers(handlers, nil, ...)
+    end
+    opengothic.async._signal(eventName, ...)
+    return handled
+end
+
+-- ============================================================
+-- Async tasks: run/wait/waitGameMinutes/waitEvent/cancel/count are native,
+-- see ScriptEngine. Persistent tasks are declared here.
+-- ============================================================
+
+opengothic.async._entries = {}
+
+-- Declare a persistent task entry point. Must happen at script load time,
+-- so that saved tasks can find their entry again after loading a game.
+function opengothic.async.define(name, fn)
+    if type(name) ~= "string" or type(fn) ~= "function" then
+        return false
+    end
+    opengothic.async._entries[name] = fn
+    return true
+end
+
+-- Start a persistent task: fn(state) of a defined entry. 'state' (flat table of
+-- strings, numbers, booleans) is saved with the game together with the pending wait;
+-- after loading, the entry function is started again with it once that wait completes.
+function opengothic.async.start(name, state)
+    local fn = opengothic.async._entries[name]
+    if fn == nil then
+        return nil, "unknown_task"
+    end
+    if state ~= nil and type(state) ~= "table" then
+        return nil, "invalid_state"
+    end
+    return opengothic.async._start(name, fn, state or {}), nil
+end
+
 -- Print message to game screen
 function opengothic.printMessage(msg)
     opengothic._printMessage(msg)
@@ -189,144 +403,15 @@ function opengothic.ui.debug(text)
     print(tostring(text))
 end
 
--- Timer helper module (safe scheduler on top of onUpdate hook)
-opengothic.timer = {
-    _nextId = 1,
-    _tasks = {},
-    _order = {},
-    _dirtyOrder = false,
-    _updateHookId = nil,
-    _minuteHookId = nil
-}
-
-local function _timerRunTask(taskId, task)
-    local ok, err = pcall(task.fn, taskId)
-    if not ok then
-        print("[Timer] callback error (" .. tostring(taskId) .. "): " .. tostring(err))
-    end
-end
-
-local function _timerCompactOrder()
-    if not opengothic.timer._dirtyOrder then
-        return
-    end
-
-    local compact = {}
-    for _, taskId in ipairs(opengothic.timer._order) do
-        if opengothic.timer._tasks[taskId] ~= nil then
-            table.insert(compact, taskId)
-        end
-    end
-    opengothic.timer._order = compact
-    opengothic.timer._dirtyOrder = false
-end
-
-local function _timerMarkRemoved(taskId)
-    if opengothic.timer._tasks[taskId] ~= nil then
-        opengothic.timer._tasks[taskId] = nil
-        opengothic.timer._dirtyOrder = true
-    end
-end
-
-local function _timerHasTasks()
-    return next(opengothic.timer._tasks) ~= nil
-end
-
-local _timerMaybeReleaseHooks
-
-local function _timerOnUpdate(dt)
-    if type(dt) ~= "number" or dt < 0 then
-        dt = 0
-    end
-
-    _timerCompactOrder()
-
-    for _, taskId in ipairs(opengothic.timer._order) do
-        local task = opengothic.timer._tasks[taskId]
-        if task and task.kind == "realtime" then
-            task.remaining = task.remaining - dt
-
-            if task.repeatEvery ~= nil then
-                local guard = 0
-                while task.remaining <= 0 and opengothic.timer._tasks[taskId] ~= nil and guard < 8 do
-                    _timerRunTask(taskId, task)
-                    guard = guard + 1
-                    if opengothic.timer._tasks[taskId] ~= nil then
-                        task.remaining = task.remaining + task.repeatEvery
-                    end
-                end
-            elseif task.remaining <= 0 then
-                _timerRunTask(taskId, task)
-                _timerMarkRemoved(taskId)
-            end
-        end
-    end
-
-    _timerCompactOrder()
-    _timerMaybeReleaseHooks()
-    return false
-end
-
-local function _timerOnGameMinuteChanged(day, hour, minute)
-    _timerCompactOrder()
-
-    for _, taskId in ipairs(opengothic.timer._order) do
-        local task = opengothic.timer._tasks[taskId]
-        if task and task.kind == "game_minute" then
-            _timerRunTask(taskId, task)
-        end
-    end
-
-    _timerCompactOrder()
-    _timerMaybeReleaseHooks()
-    return false
-end
-
-local function _timerEnsureHooks()
-    if opengothic.timer._updateHookId == nil then
-        opengothic.timer._updateHookId = opengothic.events.register("onUpdate", _timerOnUpdate)
-    end
-    if opengothic.timer._minuteHookId == nil then
-        opengothic.timer._minuteHookId = opengothic.events.register("onGameMinuteChanged", _timerOnGameMinuteChanged)
-    end
-end
-
-_timerMaybeReleaseHooks = function()
-    if _timerHasTasks() then
-        return
-    end
-
-    if opengothic.timer._updateHookId ~= nil then
-        opengothic.events.unregister("onUpdate", opengothic.timer._updateHookId)
-        opengothic.timer._updateHookId = nil
-    end
-    if opengothic.timer._minuteHookId ~= nil then
-        opengothic.events.unregister("onGameMinuteChanged", opengothic.timer._minuteHookId)
-        opengothic.timer._minuteHookId = nil
-    end
-end
-
-local function _timerCreateTask(task)
-    local taskId = opengothic.timer._nextId
-    opengothic.timer._nextId = taskId + 1
-    opengothic.timer._tasks[taskId] = task
-    table.insert(opengothic.timer._order, taskId)
-    _timerEnsureHooks()
-    return taskId
-end
+-- Timer helper module (argument checks over the engine timer wheel)
+opengothic.timer = opengothic.timer or {}
 
 function opengothic.timer.after(seconds, fn)
     if type(seconds) ~= "number" or seconds < 0 or type(fn) ~= "function" then
         return nil, "invalid_args"
     end
 
-    local taskId = _timerCreateTask({
-        kind = "realtime",
-        fn = fn,
-        remaining = seconds,
-        repeatEvery = nil
-    })
-    return taskId, nil
+    return opengothic.timer._schedule("after", seconds, fn), nil
 end
 
 function opengothic.timer.every(seconds, fn)
@@ -334,13 +419,7 @@ function opengothic.timer.every(seconds, fn)
         return nil, "invalid_args"
     end
 
-    local taskId = _timerCreateTask({
-        kind = "realtime",
-        fn = fn,
-        remaining = seconds,
-        repeatEvery = seconds
-    })
-    return taskId, nil
+    return opengothic.timer._schedule("every", seconds, fn), nil
 end
 
 function opengothic.timer.everyGameMinute(fn)
@@ -348,11 +427,7 @@ function opengothic.timer.everyGameMinute(fn)
         return nil, "invalid_args"
     end
 
-    local taskId = _timerCreateTask({
-        kind = "game_minute",
-        fn = fn
-    })
-    return taskId, nil
+    return opengothic.timer._schedule("gameMinute", 0, fn), nil
 end
 
 function opengothic.timer.cancel(taskId)
@@ -360,11 +435,7 @@ function opengothic.timer.cancel(taskId)
         return false
     end
 
-    local existed = opengothic.timer._tasks[taskId] ~= nil
-    _timerMarkRemoved(taskId)
-    _timerCompactOrder()
-    _timerMaybeReleaseHooks()
-    return existed
+    return opengothic.timer._cancel(taskId)
 end
 
 -- Bridge ergonomics wrappers (non-throwing helpers over bridge primitives)
@@ -92,6 +92,13 @@ opengothic.CONSTANTS.BodyState = {
     BS_STAND                 = bit32.bor(bit32.lshift(1, 15), bit32.lshift(1, 16))
 }
 
+opengothic.CONSTANTS.NpcFlag = {
+    NPC_DEAD        = 1,
+    NPC_UNCONSCIOUS = 2,
+    NPC_PLAYER      = 4,
+    NPC_TALKING     = 8
+}
+
 opengothic.CONSTANTS.Attitude = {
     ATT_HOSTILE  = 0,
     ATT_ANGRY    = 1,
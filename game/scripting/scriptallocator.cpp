@@ -0,0 +1,178 @@
+#include "scriptallocator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+ScriptAllocator::~ScriptAllocator() {
+  // the Lua state is closed by now, nothing may still point into the arenas
+  smallLive = 0;
+  trim();
+  }
+
+void* ScriptAllocator::alloc(void* ud, void* ptr, size_t osize, size_t nsize) {
+  auto& a = *static_cast<ScriptAllocator*>(ud);
+  if(ptr==nullptr)
+    osize = 0;
+  if(nsize>osize && a.limit>0 && a.st.liveBytes-osize+nsize>a.limit) {
+    ++a.st.failed;
+    return nullptr;
+    }
+  return a.reallocate(ptr, osize, nsize);
+  }
+
+size_t ScriptAllocator::mediumClass(size_t size) {
+  size_t cls = 0;
+  for(size_t s=size_t(1)<<MediumShift; s<size; s<<=1)
+    ++cls;
+  return cls;
+  }
+
+size_t ScriptAllocator::blockSize(size_t size) {
+  if(size<=SmallMax)
+    return (smallClass(size)+1)*SmallStep;
+  if(size<=MediumMax)
+    return size_t(1)<<(MediumShift+mediumClass(size));
+  return size;
+  }
+
+void ScriptAllocator::refill(size_t cls) {
+  void* arena = std::malloc(ArenaSize);
+  if(arena==nullptr)
+    return;
+  arenas.push_back(arena);
+  st.arenas        = arenas.size();
+  st.reservedBytes += ArenaSize;
+
+  const size_t bs    = (cls+1)*SmallStep;
+  const size_t count = ArenaSize/bs;
+  auto*        base  = static_cast<uint8_t*>(arena);
+  FreeBlock*   head  = small[cls];
+  for(size_t i=count; i>0; --i) {
+    auto* b = reinterpret_cast<FreeBlock*>(base + (i-1)*bs);
+    b->next = head;
+    head    = b;
+    }
+  small[cls] = head;
+  }
+
+void* ScriptAllocator::allocate(size_t size) {
+  void* ret = nullptr;
+  if(size<=SmallMax) {
+    const size_t cls = smallClass(size);
+    if(small[cls]!=nullptr)
+      ++st.pooledAllocs;
+    else
+      refill(cls);
+    if(FreeBlock* b = small[cls]) {
+      small[cls] = b->next;
+      smallLive += (cls+1)*SmallStep;
+      ret = b;
+      }
+    }
+  else if(size<=MediumMax) {
+    const size_t cls = mediumClass(size);
+    const size_t bs  = size_t(1)<<(MediumShift+cls);
+    if(FreeBlock* b = medium[cls]) {
+      medium[cls] = b->next;
+      st.cachedBytes -= bs;
+      ++st.pooledAllocs;
+      ret = b;
+      }
+    else if((ret = std::malloc(bs))!=nullptr) {
+      st.reservedBytes += bs;
+      }
+    }
+  else if((ret = std::malloc(size))!=nullptr) {
+    st.reservedBytes += size;
+    }
+
+  if(ret==nullptr) {
+    ++st.failed;
+    return nullptr;
+    }
+  st.liveBytes += size;
+  ++st.allocs;
+  return ret;
+  }
+
+void ScriptAllocator::release(void* p, size_t size) {
+  st.liveBytes -= size;
+  if(size<=SmallMax) {
+    const size_t cls = smallClass(size);
+    auto*        b   = static_cast<FreeBlock*>(p);
+    b->next    = small[cls];
+    small[cls] = b;
+    smallLive -= (cls+1)*SmallStep;
+    }
+  else if(size<=MediumMax) {
+    const size_t cls = mediumClass(size);
+    const size_t bs  = size_t(1)<<(MediumShift+cls);
+    if(st.cachedBytes+bs<=MaxCached) {
+      auto* b = static_cast<FreeBlock*>(p);
+      b->next     = medium[cls];
+      medium[cls] = b;
+      st.cachedBytes += bs;
+      } else {
+      std::free(p);
+      st.reservedBytes -= bs;
+      }
+    }
+  else {
+    std::free(p);
+    st.reservedBytes -= size;
+    }
+  }
+
+void* ScriptAllocator::reallocate(void* p, size_t osize, size_t nsize) {
+  if(p==nullptr)
+    return nsize>0 ? allocate(nsize) : nullptr;
+  if(nsize==0) {
+    release(p, osize);
+    return nullptr;
+    }
+
+  if(osize>MediumMax && nsize>MediumMax) {
+    void* ret = std::realloc(p, nsize);
+    if(ret==nullptr) {
+      ++st.failed;
+      return nullptr;
+      }
+    st.liveBytes     = st.liveBytes     - osize + nsize;
+    st.reservedBytes = st.reservedBytes - osize + nsize;
+    return ret;
+    }
+
+  if(blockSize(osize)==blockSize(nsize)) {
+    st.liveBytes = st.liveBytes - osize + nsize;
+    return p;
+    }
+
+  void* ret = allocate(nsize);
+  if(ret==nullptr)
+    return nullptr;
+  std::memcpy(ret, p, std::min(osize, nsize));
+  release(p, osize);
+  return ret;
+  }
+
+void ScriptAllocator::trim() {
+  for(size_t cls=0; cls<MediumClasses; ++cls) {
+    const size_t bs = size_t(1)<<(MediumShift+cls);
+    while(FreeBlock* b = medium[cls]) {
+      medium[cls] = b->next;
+      std::free(b);
+      st.reservedBytes -= bs;
+      }
+    }
+  st.cachedBytes = 0;
+
+  if(smallLive>0)
+    return;
+  for(void* a : arenas)
+    std::free(a);
+  st.reservedBytes -= arenas.size()*ArenaSize;
+  arenas.clear();
+  small.fill(nullptr);
+  st.arenas = 0;
+  }
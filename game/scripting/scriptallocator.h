@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// lua_Alloc of the main Lua state. Luau passes the old block size to every free and
+// realloc, so blocks carry no header:
+//   - up to 512 bytes: 16 byte size classes carved out of 64 KB arenas
+//   - up to 64 KB: power of two classes, freed blocks are kept for reuse (capped)
+//   - anything larger goes straight to malloc
+// Memory is only returned to the system by trim() or the destructor.
+class ScriptAllocator final {
+  public:
+    ScriptAllocator() = default;
+    ~ScriptAllocator();
+
+    ScriptAllocator(const ScriptAllocator&) = delete;
+    ScriptAllocator& operator=(const ScriptAllocator&) = delete;
+
+    struct Stats {
+      size_t   liveBytes     = 0; // requested by Lua and not freed yet
+      size_t   reservedBytes = 0; // arenas, cached and large blocks
+      size_t   cachedBytes   = 0; // free blocks of the power of two classes
+      size_t   arenas        = 0;
+      uint64_t allocs        = 0;
+      uint64_t pooledAllocs  = 0; // served from a free list
+      uint64_t failed        = 0;
+      };
+
+    const Stats& stats() const { return st; }
+
+    // 0 = unlimited; growing past the limit fails the allocation (LUA_ERRMEM)
+    void   setLimit(size_t bytes) { limit = bytes; }
+    size_t memoryLimit() const { return limit; }
+
+    // drops cached blocks; arenas too, once no small block is in use
+    void   trim();
+
+    static void* alloc(void* ud, void* ptr, size_t osize, size_t nsize);
+
+  private:
+    static constexpr size_t SmallStep    = 16;
+    static constexpr size_t SmallMax     = 512;
+    static constexpr size_t SmallClasses = SmallMax/SmallStep;
+    static constexpr size_t MediumMax    = 64*1024;
+    static constexpr size_t MediumShift  = 10; // first medium class is 1 KB
+    static constexpr size_t MediumClasses = 7; // 1 KB .. 64 KB
+    static constexpr size_t ArenaSize    = 64*1024;
+    static constexpr size_t MaxCached    = 8*1024*1024;
+
+    struct FreeBlock {
+      FreeBlock* next;
+      };
+
+    static size_t smallClass(size_t size)  { return (size+SmallStep-1)/SmallStep - 1; }
+    static size_t mediumClass(size_t size);
+    static size_t blockSize(size_t size);
+
+    void* allocate(size_t size);
+    void  release(void* p, size_t size);
+    void* reallocate(void* p, size_t osize, size_t nsize);
+    void  refill(size_t cls);
+
+    std::array<FreeBlock*,SmallClasses>  small  = {};
+    std::array<FreeBlock*,MediumClasses> medium = {};
+    std::vector<void*>                   arenas;
+    size_t                               smallLive = 0; // bytes of small blocks in use
+    size_t                               limit     = 0;
+    Stats                                st;
+  };
@@ -7,6 +7,7 @@
 #include <luacodegen.h>
 #include <Luau/Compiler.h>
 #include <Luau/CodeGen.h>
+#include <Luau/Bytecode.h>
 
 #include "world/objects/npc.h"
 #include "world/objects/item.h"
@@ -25,26 +26,134 @@
 #include <Tempest/Dir>
 #include <Tempest/TextCodec>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <limits>
 #include <sstream>
 #include <stdexcept>
+#include <type_traits>
 #include <vector>
 
+#include "storagecodec.h"
+#include "scriptwatcher.h"
 #include "scripting/bootstrap_lua.h"
 #include "scripting/constants_lua.h"
 
 namespace Lua {
+  // Userdata tags of engine object proxies; also used as metatable slots in the proxy cache
+  enum ProxyTag : int {
+    PT_None = 0,
+    PT_Npc,
+    PT_Item,
+    PT_Inventory,
+    PT_World,
+    PT_Interactive,
+    PT_Count
+    };
+
+  static const char* const proxyName[PT_Count] = {
+    nullptr, "Npc", "Item", "Inventory", "World", "Interactive"
+    };
+
+  template<class T> struct Proxy                { static constexpr int tag = PT_None;        };
+  template<>        struct Proxy<Npc>           { static constexpr int tag = PT_Npc;         };
+  template<>        struct Proxy<Item>          { static constexpr int tag = PT_Item;        };
+  template<>        struct Proxy<Inventory>     { static constexpr int tag = PT_Inventory;   };
+  template<>        struct Proxy<World>         { static constexpr int tag = PT_World;       };
+  template<>        struct Proxy<Interactive>   { static constexpr int tag = PT_Interactive; };
+
+  // Registry ref of weak-valued table: lightuserdata(object) -> proxy userdata,
+  // integer slots [PT_Npc..PT_Count) hold the class metatables.
+  static int proxyCacheRef = LUA_NOREF;
+
+  void initProxyCache(lua_State* L) {
+    lua_newtable(L);
+    lua_newtable(L);
+    lua_pushstring(L, "v");
+    lua_setfield(L, -2, "__mode");
+    lua_setmetatable(L, -2);
+    for(int tag = PT_Npc; tag < PT_Count; ++tag) {
+      luaL_getmetatable(L, proxyName[tag]);
+      lua_rawseti(L, -2, tag);
+      }
+    proxyCacheRef = lua_ref(L, -1);
+    lua_pop(L, 1);
+    }
+
+  void closeProxyCache() {
+    proxyCacheRef = LUA_NOREF;
+    }
+
+  // Pushes the stable proxy of obj: same object always yields the same userdata,
+  // so scripts can compare proxies with '==' and use them as table keys.
   template<typename T>
-  T** push(lua_State* L, T* obj) {
-    T** ptr = reinterpret_cast<T**>(lua_newuserdata(L, sizeof(T*)));
+  void pushProxy(lua_State* L, T* obj) {
+    constexpr int tag = Proxy<T>::tag;
+    static_assert(tag != PT_None, "not a proxy type");
+
+    lua_rawgeti(L, LUA_REGISTRYINDEX, proxyCacheRef);
+    lua_pushlightuserdata(L, obj);
+    lua_rawget(L, -2);
+    const int cached = lua_userdatatag(L, -1);
+    if(cached == tag) {
+      lua_remove(L, -2);
+      return;
+      }
+    if(cached >= 0) {
+      // stale proxy of another type at a reused address
+      *reinterpret_cast<void**>(lua_touserdata(L, -1)) = nullptr;
+      }
+    lua_pop(L, 1);
+
+    T** ptr = reinterpret_cast<T**>(lua_newuserdatatagged(L, sizeof(T*), tag));
     *ptr = obj;
-    return ptr;
+    lua_rawgeti(L, -2, tag);
+    lua_setmetatable(L, -2);
+
+    lua_pushlightuserdata(L, obj);
+    lua_pushvalue(L, -2);
+    lua_rawset(L, -4);
+    lua_remove(L, -2);
     }
 
-  void setMetatable(lua_State* L, const char* name) {
-    luaL_getmetatable(L, name);
-    lua_setmetatable(L, -2);
+  // Detaches the proxy of a destroyed object: scripts holding it will see a dead handle
+  void invalidateProxy(lua_State* L, const void* obj) {
+    if(proxyCacheRef == LUA_NOREF)
+      return;
+    lua_rawgeti(L, LUA_REGISTRYINDEX, proxyCacheRef);
+    lua_pushlightuserdata(L, const_cast<void*>(obj));
+    lua_rawget(L, -2);
+    if(lua_userdatatag(L, -1) > PT_None)
+      *reinterpret_cast<void**>(lua_touserdata(L, -1)) = nullptr;
+    lua_pop(L, 1);
+
+    lua_pushlightuserdata(L, const_cast<void*>(obj));
+    lua_pushnil(L);
+    lua_rawset(L, -3);
+    lua_pop(L, 1);
+    }
+
+  void invalidateAllProxies(lua_State* L) {
+    if(proxyCacheRef == LUA_NOREF)
+      return;
+    lua_rawgeti(L, LUA_REGISTRYINDEX, proxyCacheRef);
+    lua_pushnil(L);
+    while(lua_next(L, -2) != 0) {
+      if(lua_userdatatag(L, -1) > PT_None) {
+        *reinterpret_cast<void**>(lua_touserdata(L, -1)) = nullptr;
+        lua_pushvalue(L, -2);
+        lua_pushnil(L);
+        lua_rawset(L, -5);
+        }
+      lua_pop(L, 1);
+      }
+    lua_pop(L, 1);
     }
 
   template<typename T>
@@ -80,6 +189,81 @@ namespace Lua {
     }
   }
 
+namespace {
+  constexpr int      LuauOptimizationLevel = 2;
+  constexpr int      LuauDebugLevel        = 1;
+
+  constexpr uint32_t BytecodeCacheMagic    = 0x434c474f; // "OGLC"
+  constexpr uint32_t BytecodeCacheFormat   = 1;
+  constexpr uint64_t BytecodeCacheMaxSize  = 64u<<20;
+
+  // Everything that invalidates a cached chunk
+  struct BytecodeCacheHeader {
+    uint32_t magic             = BytecodeCacheMagic;
+    uint32_t format            = BytecodeCacheFormat;
+    uint64_t sourceHash        = 0;
+    uint32_t optimizationLevel = LuauOptimizationLevel;
+    uint32_t debugLevel        = LuauDebugLevel;
+    uint32_t bytecodeMax       = LBC_VERSION_MAX;
+    uint32_t bytecodeTarget    = LBC_VERSION_TARGET;
+    uint64_t size              = 0;
+
+    bool sameKey(const BytecodeCacheHeader& o) const {
+      return magic==o.magic && format==o.format && sourceHash==o.sourceHash &&
+             optimizationLevel==o.optimizationLevel && debugLevel==o.debugLevel &&
+             bytecodeMax==o.bytecodeMax && bytecodeTarget==o.bytecodeTarget;
+      }
+    };
+
+  uint64_t fnv1a(const char* data, size_t size) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for(size_t i=0; i<size; ++i) {
+      h ^= uint8_t(data[i]);
+      h *= 0x100000001b3ull;
+      }
+    return h;
+    }
+
+  // Lua heap size; growth across a call approximates its allocations
+  int64_t luaHeapBytes(lua_State* L) {
+    return int64_t(lua_gc(L, LUA_GCCOUNT, 0))*1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+    }
+
+  // Luau memory category of a script module, 0 is shared by the engine and the overflow
+  int memoryCategory(int32_t module) {
+    return (module>=0 && module+1<LUA_MEMORY_CATEGORIES) ? int(module+1) : 0;
+    }
+
+  constexpr size_t MegaByte = 1024*1024;
+
+  // clock is only read every ExecCheckInterval interrupts
+  constexpr uint32_t ExecCheckInterval = 256;
+  // a dispatch whose coroutine handlers got preempted gives the following handlers a fresh
+  // budget each, but ends after ExecDispatchCap budgets in total
+  constexpr uint32_t ExecDispatchCap   = 4;
+  constexpr uint32_t ExecMaxStrikes    = 3;
+
+  // first value yielded by opengothic.async wait functions
+  const char         asyncYieldTag     = 0;
+  constexpr uint32_t AsyncSaveVersion  = 2; // 2: state tables in the storagecodec encoding
+
+  // metatable of opengothic.daedalus.bind() callables
+  const char* const  DaedalusFunctionMeta = "DaedalusFunction";
+
+  // opengothic.timer resolution; 'every' fires at most TimerMaxCatchUp times per frame
+  constexpr double   TimerTicksPerSecond = 1000.0;
+  constexpr uint8_t  TimerMaxCatchUp     = 8;
+
+  const char* timerKindName(uint8_t kind) {
+    static const char* names[] = {"after", "every", "gameMinute"};
+    return kind<3 ? names[kind] : "?";
+    }
+
+  double elapsedMs(std::chrono::steady_clock::time_point from) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-from).count();
+    }
+  }
+
 using namespace Tempest;
 
 ScriptEngine::ScriptEngine() {
@@ -90,16 +274,42 @@ ScriptEngine::~ScriptEngine() {
   }
 
 void ScriptEngine::initialize() {
-  L = luaL_newstate();
+  L = lua_newstate(ScriptAllocator::alloc, &allocator);
   if(!L) {
     Log::e("[ScriptEngine] Failed to create Lua state");
     return;
     }
 
+  memModule    = -1;
+  memSoftLimit = size_t(CommandLine::inst().luaMemSoftMb())*MegaByte;
+  memHardLimit = size_t(CommandLine::inst().luaMemHardMb())*MegaByte;
+  memStates.clear();
+
+  execBudgetMs = double(CommandLine::inst().luaBudgetMs());
+  if(execBudgetMs>0) {
+    lua_callbacks(L)->userdata  = this;
+    lua_callbacks(L)->interrupt = luaInterrupt;
+    } else {
+    Log::i("[ScriptEngine] Execution budget disabled");
+    }
+
+  bytecodeCacheDir.clear();
+  bytecodeCacheHits   = 0;
+  bytecodeCacheMisses = 0;
+  if(CommandLine::inst().isLuaBytecodeCache())
+    bytecodeCacheDir = CommandLine::inst().nestedPath({u"Data", u"opengothic", u"cache"}, Dir::FT_Dir);
+  else
+    Log::i("[ScriptEngine] Bytecode cache disabled");
+
+  scriptWatcher.reset();
+  if(CommandLine::inst().isLuaWatch())
+    scriptWatcher.reset(new ScriptWatcher());
+
   luaL_openlibs(L);
   setupSandbox();
-  registerCoreFunctions();
+  // before the bootstrap runs, so that it is native-compiled too
   enableJIT();
+  registerCoreFunctions();
   bindHooks();
 
   Log::i("[ScriptEngine] Initialized");
@@ -107,11 +317,45 @@ void ScriptEngine::initialize() {
 
 void ScriptEngine::shutdown() {
   unbindHooks();
+  clearStorageCache();
+  clearConsoleChunks();
   if(L) {
     lua_close(L);
     L = nullptr;
     }
+  allocator.trim();
+  memModule  = -1;
+  jitEnabled = false;
+  Lua::closeProxyCache();
+  for(auto& ev : events) {
+    ev.handlersRef  = LUA_NOREF;
+    ev.liveHandlers = 0;
+    }
+  for(auto& ext : luaExternals)
+    ext->fnRef = LUA_NOREF;
+  dispatchRef         = LUA_NOREF;
+  dispatchProfiledRef = LUA_NOREF;
+  matchedRefs.clear();
+  matchedDepth        = 0;
+  execOffenderRef     = LUA_NOREF;
+  execDepth           = 0;
+  execStrikes.clear();
+  for(auto& ev : events)
+    ev.waiters.clear();
+  asyncTasks.clear();
+  asyncReady.clear();
+  asyncQueue.clear();
+  asyncRunning  = 0;
+  workerPool.clear();
+  parallelJobs.clear();
+  parallelItems.clear();
+  scriptTime    = 0;
+  asyncGameTime = -1;
+  clearTimers();
   loadedScripts.clear();
+  modulePaths.clear();
+  moduleIds.clear();
+  scriptWatcher.reset();
   lastGameMinuteStamp = -1;
   Log::i("[ScriptEngine] Shutdown");
   }
@@ -227,6 +471,66 @@ void ScriptEngine::registerCoreFunctions() {
   lua_pushcfunction(L, luaQuestAddEntry, "opengothic._questAddEntry");
   lua_setfield(L, -2, "_questAddEntry");
 
+  // Internal event table bridge used by bootstrap opengothic.events
+  lua_pushcfunction(L, luaSetEventHandlers, "opengothic._setEventHandlers");
+  lua_setfield(L, -2, "_setEventHandlers");
+  lua_pushcfunction(L, luaEventStats, "opengothic._eventStats");
+  lua_setfield(L, -2, "_eventStats");
+  lua_pushcfunction(L, luaProfileCall, "opengothic._profileCall");
+  lua_setfield(L, -2, "_profileCall");
+  lua_pushcfunction(L, luaRunHandlerThread, "opengothic._runHandlerThread");
+  lua_setfield(L, -2, "_runHandlerThread");
+  lua_pushcfunction(L, luaCallerModule, "opengothic._callerModule");
+  lua_setfield(L, -2, "_callerModule");
+  lua_pushcfunction(L, luaEnterModule, "opengothic._enterModule");
+  lua_setfield(L, -2, "_enterModule");
+  lua_pushcfunction(L, luaMemoryStats, "opengothic.memoryStats");
+  lua_setfield(L, -2, "memoryStats");
+  lua_pushcfunction(L, luaStorageTrack, "opengothic.storageTrack");
+  lua_setfield(L, -2, "storageTrack");
+  lua_pushcfunction(L, luaStorageTouch, "opengothic.storageTouch");
+  lua_setfield(L, -2, "storageTouch");
+
+  // opengothic.async (define/start are added by bootstrap)
+  lua_newtable(L);
+  lua_pushcfunction(L, luaAsyncRun, "async.run");
+  lua_setfield(L, -2, "run");
+  lua_pushcfunction(L, luaAsyncWait, "async.wait");
+  lua_setfield(L, -2, "wait");
+  lua_pushcfunction(L, luaAsyncWaitGameMinutes, "async.waitGameMinutes");
+  lua_setfield(L, -2, "waitGameMinutes");
+  lua_pushcfunction(L, luaAsyncWaitEvent, "async.waitEvent");
+  lua_setfield(L, -2, "waitEvent");
+  lua_pushcfunction(L, luaAsyncCancel, "async.cancel");
+  lua_setfield(L, -2, "cancel");
+  lua_pushcfunction(L, luaAsyncCount, "async.count");
+  lua_setfield(L, -2, "count");
+  lua_pushcfunction(L, luaAsyncStart, "async._start");
+  lua_setfield(L, -2, "_start");
+  lua_pushcfunction(L, luaAsyncSignal, "async._signal");
+  lua_setfield(L, -2, "_signal");
+  lua_setfield(L, -2, "async");
+
+  // opengothic.parallel
+  lua_newtable(L);
+  lua_pushcfunction(L, luaParallelDefine, "parallel.define");
+  lua_setfield(L, -2, "define");
+  lua_pushcfunction(L, luaParallelMap, "parallel.map");
+  lua_setfield(L, -2, "map");
+  lua_pushcfunction(L, luaParallelStats, "parallel.stats");
+  lua_setfield(L, -2, "stats");
+  lua_setfield(L, -2, "parallel");
+
+  // opengothic.timer (after/every/everyGameMinute/cancel are wrapped by bootstrap)
+  lua_newtable(L);
+  lua_pushcfunction(L, luaTimerSchedule, "timer._schedule");
+  lua_setfield(L, -2, "_schedule");
+  lua_pushcfunction(L, luaTimerCancel, "timer._cancel");
+  lua_setfield(L, -2, "_cancel");
+  lua_pushcfunction(L, luaTimerStats, "timer.stats");
+  lua_setfield(L, -2, "stats");
+  lua_setfield(L, -2, "timer");
+
   // opengothic.daedalus
   lua_newtable(L);
   lua_pushcfunction(L, luaDaedalusCall, "daedalus.call");
@@ -235,8 +539,17 @@ void ScriptEngine::registerCoreFunctions() {
   lua_setfield(L, -2, "get");
   lua_pushcfunction(L, luaDaedalusSet, "daedalus.set");
   lua_setfield(L, -2, "set");
+  lua_pushcfunction(L, luaDaedalusBind, "daedalus.bind");
+  lua_setfield(L, -2, "bind");
   lua_setfield(L, -2, "daedalus");
 
+  luaL_newmetatable(L, DaedalusFunctionMeta);
+  lua_pushcfunction(L, luaDaedalusBoundCall, "DaedalusFunction.__call");
+  lua_setfield(L, -2, "__call");
+  lua_pushcfunction(L, luaDaedalusBoundToString, "DaedalusFunction.__tostring");
+  lua_setfield(L, -2, "__tostring");
+  lua_pop(L, 1);
+
   // opengothic.vm
   lua_newtable(L);
   lua_pushcfunction(L, luaVmCallWithContext, "vm.callWithContext");
@@ -247,21 +560,540 @@ void ScriptEngine::registerCoreFunctions() {
   lua_setfield(L, -2, "getSymbol");
   lua_pushcfunction(L, luaVmEnumerate, "vm.enumerate");
   lua_setfield(L, -2, "enumerate");
+  lua_pushcfunction(L, luaVmEnumerateIndices, "vm.enumerateIndices");
+  lua_setfield(L, -2, "enumerateIndices");
   lua_setfield(L, -2, "vm");
 
   lua_setglobal(L, "opengothic");
 
   // Register internal API and load bootstrap
   registerInternalAPI();
+  Lua::initProxyCache(L);
   loadBootstrap();
+
+  lua_getglobal(L, "opengothic");
+  lua_getfield(L, -1, "_dispatchHandlers");
+  if(lua_isfunction(L, -1))
+    dispatchRef = lua_ref(L, -1);
+  else
+    Log::e("[ScriptEngine] opengothic._dispatchHandlers is missing, events are disabled");
+  lua_pop(L, 1);
+  lua_getfield(L, -1, "_dispatchHandlersProfiled");
+  if(lua_isfunction(L, -1))
+    dispatchProfiledRef = lua_ref(L, -1);
+  lua_pop(L, 2);
+  }
+
+void ScriptEngine::setProfiling(bool enable) {
+  profiler.setEnabled(enable);
+  Log::i("[ScriptEngine] Profiler ", enable ? "enabled" : "disabled");
+  }
+
+void ScriptEngine::beginExec() {
+  if(execDepth++==0 && execBudgetMs>0) {
+    const auto now = std::chrono::steady_clock::now();
+    execCap = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double, std::milli>(execBudgetMs*ExecDispatchCap));
+    armExecDeadline(now);
+    }
+  }
+
+void ScriptEngine::armExecDeadline(std::chrono::steady_clock::time_point now) {
+  execDeadline = std::min(execCap, now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                     std::chrono::duration<double, std::milli>(execBudgetMs)));
+  execTicks    = 0;
+  execTripped  = false;
+  }
+
+void ScriptEngine::endExec() {
+  if(--execDepth>0)
+    return;
+  if(execOffenderRef!=LUA_NOREF) {
+    // overrun was caught by a pcall inside of the script
+    lua_unref(L, execOffenderRef);
+    execOffenderRef = LUA_NOREF;
+    }
+  }
+
+void ScriptEngine::luaInterrupt(lua_State* L, int gc) {
+  if(gc>=0)
+    return;
+  auto* engine = static_cast<ScriptEngine*>(lua_callbacks(L)->userdata);
+  if(engine==nullptr || engine->execDepth==0)
+    return;
+  if(!engine->execTripped) {
+    if((++engine->execTicks % ExecCheckInterval)!=0)
+      return;
+    if(std::chrono::steady_clock::now()<engine->execDeadline)
+      return;
+    }
+
+  if(lua_getthreaddata(L)==engine && lua_isyieldable(L)) {
+    // coroutine handler: preempt, resumed by the next update
+    lua_yield(L, 0);
+    return;
+    }
+
+  engine->execTripped = true;
+  if(L==engine->L && engine->execOffenderRef==LUA_NOREF)
+    engine->captureBudgetOffender();
+  luaL_error(L, "script exceeded the execution budget of %d ms", int(engine->execBudgetMs));
+  }
+
+void ScriptEngine::captureBudgetOffender() {
+  // outermost Lua function below the event dispatcher is the handler itself
+  if(!lua_checkstack(L, 3))
+    return;
+
+  lua_Debug ar        = {};
+  bool      found     = false;
+  bool      atHandler = false;
+  for(int level=0; lua_getinfo(L, level, "f", &ar); ++level) {
+    bool dispatcher = false;
+    for(int ref : {dispatchRef, dispatchProfiledRef}) {
+      if(ref==LUA_NOREF)
+        continue;
+      lua_rawgeti(L, LUA_REGISTRYINDEX, ref);
+      dispatcher |= lua_rawequal(L, -1, -2);
+      lua_pop(L, 1);
+      }
+    if(dispatcher) {
+      lua_pop(L, 1);
+      atHandler = found;
+      break;
+      }
+    if(lua_iscfunction(L, -1)) {
+      lua_pop(L, 1);
+      continue;
+      }
+    if(found)
+      lua_remove(L, -2);
+    found = true;
+    }
+
+  if(atHandler)
+    execOffenderRef = lua_ref(L, -1);
+  if(found)
+    lua_pop(L, 1);
+  }
+
+void ScriptEngine::strikeBudgetOffender(int eventId) {
+  if(execOffenderRef==LUA_NOREF)
+    return;
+
+  const std::string eventName = events[size_t(eventId)].name;
+  int               handlerId = -1;
+
+  lua_rawgeti(L, LUA_REGISTRYINDEX, execOffenderRef);
+  lua_rawgeti(L, LUA_REGISTRYINDEX, events[size_t(eventId)].handlersRef);
+  const int n = lua_istable(L, -1) ? lua_objlen(L, -1) : 0;
+  for(int i=1; i<=n && handlerId<0; ++i) {
+    lua_rawgeti(L, -1, i);
+    if(lua_istable(L, -1)) {
+      lua_getfield(L, -1, "callback");
+      if(lua_rawequal(L, -1, -4)) {
+        lua_getfield(L, -2, "id");
+        handlerId = int(lua_tointeger(L, -1));
+        lua_pop(L, 1);
+        }
+      lua_pop(L, 1);
+      }
+    lua_pop(L, 1);
+    }
+  lua_pop(L, 2);
+  lua_unref(L, execOffenderRef);
+  execOffenderRef = LUA_NOREF;
+
+  if(handlerId<0)
+    return;
+
+  const uint32_t strikes = ++execStrikes[handlerId];
+  Log::e("[ScriptEngine] Handler #", handlerId, " (", eventName, ") exceeded the execution budget (", strikes, "/", ExecMaxStrikes, ")");
+  if(strikes<ExecMaxStrikes)
+    return;
+
+  // through bootstrap, so that the Lua handler list and the C++ slot stay in sync
+  lua_getglobal(L, "opengothic");
+  lua_getfield(L, -1, "events");
+  lua_getfield(L, -1, "unregister");
+  lua_pushstring(L, eventName.c_str());
+  lua_pushinteger(L, handlerId);
+  if(lua_pcall(L, 2, 0, 0)!=0) {
+    Log::e("[ScriptEngine] Unable to disable handler #", handlerId, ": ", lua_tostring(L, -1));
+    lua_pop(L, 1);
+    } else {
+    Log::e("[ScriptEngine] Handler #", handlerId, " (", eventName, ") disabled after ", strikes, " budget overruns");
+    }
+  lua_pop(L, 2);
+  }
+
+uint32_t ScriptEngine::createTask(lua_State* from, int nargs) {
+  // function and arguments are the top nargs+1 values of 'from'
+  lua_State* co = lua_newthread(from);
+  lua_setthreaddata(co, this);
+  const int ref = lua_ref(from, -1);
+  lua_pop(from, 1);
+  lua_xmove(from, co, nargs+1);
+
+  // new threads allocate for the module that started them
+  const int32_t* creator = moduleSlot(from);
+  const int32_t  module  = creator!=nullptr ? *creator : -1;
+  lua_setmemcat(co, memoryCategory(module));
+
+  const uint32_t id = asyncNextId++;
+  auto&          t  = asyncTasks[id];
+  t.threadRef = ref;
+  t.thread    = co;
+  t.module    = module;
+  return id;
+  }
+
+bool ScriptEngine::resumeTask(uint32_t id, int nargs, lua_State* from) {
+  // returns true, if task has finished; results stay on the thread stack until it is collected
+  auto it = asyncTasks.find(id);
+  if(it==asyncTasks.end())
+    return false;
+
+  lua_State* co = it->second.thread;
+  if(!it->second.started) {
+    it->second.started = true;
+    nargs = lua_gettop(co) - 1;
+    }
+
+  const uint32_t prev = asyncRunning;
+  asyncRunning = id;
+  beginExec();
+  const int status = lua_resume(co, from, nargs);
+  endExec();
+  asyncRunning = prev;
+
+  // preempted by the budget: the rest of an outer dispatch gets a fresh deadline, up to the dispatch cap
+  if(status==LUA_YIELD && execDepth>0 && execBudgetMs>0) {
+    const auto now = std::chrono::steady_clock::now();
+    if(now>=execDeadline && now<execCap)
+      armExecDeadline(now);
+    }
+
+  it = asyncTasks.find(id);
+  if(it==asyncTasks.end())
+    return false;
+  if(status==LUA_YIELD && !it->second.cancelled) {
+    scheduleTask(id);
+    return false;
+    }
+  if(status!=LUA_OK && status!=LUA_YIELD) {
+    if(it->second.handlerId>=0)
+      Log::e("[ScriptEngine] Coroutine handler #", it->second.handlerId, " (", it->second.label, ") error: ", lua_tostring(co, -1));
+    else
+      Log::e("[ScriptEngine] Async task #", id, " error: ", lua_tostring(co, -1));
+    }
+  finishTask(id);
+  return status==LUA_OK;
+  }
+
+int ScriptEngine::yieldTask(lua_State* L, WaitKind kind, double value) {
+  if(lua_getthreaddata(L)==nullptr || !lua_isyieldable(L))
+    luaL_error(L, "opengothic.async: wait functions must be called from an async task");
+  lua_settop(L, 0);
+  lua_pushlightuserdata(L, const_cast<char*>(&asyncYieldTag));
+  lua_pushinteger(L, kind);
+  lua_pushnumber(L, value);
+  return lua_yield(L, 3);
+  }
+
+void ScriptEngine::scheduleTask(uint32_t id) {
+  auto&      t   = asyncTasks[id];
+  lua_State* co  = t.thread;
+  const int  top = lua_gettop(co);
+
+  // plain coroutine.yield() or budget preemption: next update
+  t.wait = W_NextUpdate;
+  if(top>=3 && lua_touserdata(co, top-2)==&asyncYieldTag) {
+    const double value = lua_tonumber(co, top);
+    t.wait = WaitKind(lua_tointeger(co, top-1));
+    if(t.wait==W_Seconds)
+      t.wakeAt = scriptTime + value;
+    else if(t.wait==W_GameMinutes)
+      t.wakeAt = double(std::max<int64_t>(asyncGameTime, 0)) + value;
+    else if(t.wait==W_Event)
+      t.eventId = int(value);
+    else if(t.wait==W_Parallel)
+      t.wakeAt = value; // job id
+    }
+  lua_settop(co, 0);
+  queueTask(id);
+  }
+
+void ScriptEngine::queueTask(uint32_t id) {
+  auto& t = asyncTasks[id];
+  ++t.gen;
+  switch(t.wait) {
+    case W_NextUpdate:
+      asyncReady.emplace_back(id, t.gen);
+      break;
+    case W_Seconds:
+      asyncQueue.push(ScriptScheduler::C_Real, t.wakeAt, id, t.gen);
+      break;
+    case W_GameMinutes:
+      asyncQueue.push(ScriptScheduler::C_Game, t.wakeAt, id, t.gen);
+      break;
+    case W_Event:
+      if(t.eventId>=0 && size_t(t.eventId)<events.size())
+        events[size_t(t.eventId)].waiters.emplace_back(id, t.gen);
+      break;
+    case W_Parallel:
+      // resumed by runParallelJobs
+      break;
+    }
+  }
+
+bool ScriptEngine::cancelTask(uint32_t id) {
+  auto it = asyncTasks.find(id);
+  if(it==asyncTasks.end() || it->second.cancelled)
+    return false;
+  if(lua_costatus(L, it->second.thread)!=LUA_COSUS || (id==asyncRunning)) {
+    // running (or resuming another task): removed once it yields
+    it->second.cancelled = true;
+    return true;
+    }
+  finishTask(id);
+  return true;
+  }
+
+void ScriptEngine::finishTask(uint32_t id) {
+  // queued wake-ups are left behind and skipped by generation/lookup
+  auto it = asyncTasks.find(id);
+  if(it==asyncTasks.end())
+    return;
+  if(L!=nullptr) {
+    lua_unref(L, it->second.threadRef);
+    if(it->second.stateRef!=LUA_NOREF)
+      lua_unref(L, it->second.stateRef);
+    }
+  asyncTasks.erase(it);
+  }
+
+void ScriptEngine::runDueTasks() {
+  if(asyncTasks.empty())
+    return;
+
+  asyncDue.clear();
+  std::swap(asyncDue, asyncReady);
+  auto collect = [this](uint32_t id, uint32_t gen) { asyncDue.emplace_back(id, gen); };
+  asyncQueue.popDue(ScriptScheduler::C_Real, scriptTime, collect);
+  if(asyncGameTime>=0)
+    asyncQueue.popDue(ScriptScheduler::C_Game, double(asyncGameTime), collect);
+
+  for(auto [id, gen] : asyncDue) {
+    auto it = asyncTasks.find(id);
+    if(it==asyncTasks.end() || it->second.gen!=gen)
+      continue;
+    resumeTask(id, 0, L);
+    }
+  asyncDue.clear();
+  }
+
+void ScriptEngine::dropTasks() {
+  std::vector<uint32_t> ids;
+  ids.reserve(asyncTasks.size());
+  for(auto& [id, t] : asyncTasks)
+    ids.push_back(id);
+  for(auto id : ids)
+    cancelTask(id);
+  asyncReady.clear();
+  asyncQueue.clear();
+  for(auto& ev : events)
+    ev.waiters.clear();
+  }
+
+uint32_t ScriptEngine::addTimer(lua_State* from, TimerKind kind, double seconds) {
+  // callback is on top of 'from'
+  const uint32_t id = timerNextId++;
+  Timer          t;
+  t.fnRef  = lua_ref(from, -1);
+  t.kind   = kind;
+  t.module = callerModule(from);
+  if(kind==T_GameMinute) {
+    minuteTimers.push_back(id);
+    } else {
+    t.interval = TimerWheel::Tick(seconds*TimerTicksPerSecond);
+    if(kind==T_Every)
+      t.interval = std::max<TimerWheel::Tick>(t.interval, 1);
+    t.next = timerWheel.now() + t.interval;
+    timerWheel.schedule(id, t.next);
+    }
+  timers[id] = t;
+  return id;
+  }
+
+bool ScriptEngine::cancelTimer(uint32_t id) {
+  auto it = timers.find(id);
+  if(it==timers.end())
+    return false;
+  // wheel entry stays until its slot comes up and is skipped there
+  if(it->second.kind==T_GameMinute)
+    std::replace(minuteTimers.begin(), minuteTimers.end(), id, 0u);
+  lua_unref(L, it->second.fnRef);
+  timers.erase(it);
+  ++timerCancels;
+  return true;
+  }
+
+void ScriptEngine::fireTimer(uint32_t id) {
+  auto it = timers.find(id);
+  if(it==timers.end())
+    return;
+
+  const TimerKind kind   = it->second.kind;
+  const int32_t   module = it->second.module;
+  lua_rawgeti(L, LUA_REGISTRYINDEX, it->second.fnRef);
+  if(kind==T_After) {
+    lua_unref(L, it->second.fnRef);
+    timers.erase(it);
+    }
+  lua_pushinteger(L, int(id));
+
+  const bool profile = profiler.isEnabled();
+  const auto t0      = profile ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+  const auto heap0   = profile ? luaHeapBytes(L) : 0;
+
+  ++timerFires;
+  beginExec();
+  const int32_t outer = enterModule(L, module);
+  const int     err   = lua_pcall(L, 1, 0, 0);
+  enterModule(L, outer);
+  if(profile)
+    profiler.record(ScriptProfiler::K_Timer, id, timerKindName(kind), elapsedMs(t0), luaHeapBytes(L)-heap0);
+
+  if(err!=0) {
+    Log::e("[Timer] callback error (", id, "): ", lua_tostring(L, -1));
+    lua_pop(L, 1);
+    // callback may have cancelled itself, look it up again
+    auto t = timers.find(id);
+    if(execTripped && t!=timers.end() && ++t->second.strikes>=ExecMaxStrikes) {
+      Log::e("[ScriptEngine] Timer #", id, " disabled after ", ExecMaxStrikes, " budget overruns");
+      cancelTimer(id);
+      }
+    }
+  endExec();
+  }
+
+void ScriptEngine::runDueTimers() {
+  ++timerFrame;
+  const auto to = TimerWheel::Tick(scriptTime*TimerTicksPerSecond);
+  timerWheel.advance(to, [this, to](uint32_t id, TimerWheel::Tick) {
+    auto it = timers.find(id);
+    if(it==timers.end())
+      return;
+
+    auto& t = it->second;
+    if(t.kind==T_Every) {
+      if(t.frame!=timerFrame) {
+        t.frame   = timerFrame;
+        t.catchUp = 0;
+        }
+      if(t.catchUp>=TimerMaxCatchUp) {
+        // keep the backlog for the next frame
+        timerWheel.schedule(id, to+1);
+        return;
+        }
+      ++t.catchUp;
+      // nominal schedule: a late frame fires again within this advance
+      t.next += t.interval;
+      timerWheel.schedule(id, t.next);
+      }
+    fireTimer(id);
+    });
+  }
+
+void ScriptEngine::runMinuteTimers() {
+  // timers added by the callbacks wait for the next minute
+  const size_t n = minuteTimers.size();
+  for(size_t i=0; i<n; ++i) {
+    if(minuteTimers[i]!=0)
+      fireTimer(minuteTimers[i]);
+    }
+  minuteTimers.erase(std::remove(minuteTimers.begin(), minuteTimers.end(), 0u), minuteTimers.end());
+  }
+
+void ScriptEngine::clearTimers() {
+  // refs are owned by the lua_State, which is gone at this point
+  timers.clear();
+  minuteTimers.clear();
+  timerWheel.clear();
+  timerFrame   = 0;
+  timerFires   = 0;
+  timerCancels = 0;
+  }
+
+void ScriptEngine::runParallelJobs() {
+  if(parallelJobs.empty())
+    return;
+
+  // callbacks and resumed tasks may submit new jobs: those run next update
+  auto jobs  = std::move(parallelJobs);
+  auto items = std::move(parallelItems);
+  parallelJobs.clear();
+  parallelItems.clear();
+
+  const auto t0 = std::chrono::steady_clock::now();
+  workerPool.setBudget(execBudgetMs);
+  workerPool.run(items);
+  parallelMs        += elapsedMs(t0);
+  parallelDone      += jobs.size();
+  parallelItemsDone += items.size();
+
+  for(auto& job : jobs) {
+    // results[i] is nil for failed items, err is the first error
+    std::string err, decodeErr;
+    lua_createtable(L, int(job.count), 0);
+    for(size_t i=0; i<job.count; ++i) {
+      auto& item = items[job.first+i];
+      if(item.error.empty() && StorageCodec::decode(L, item.output, decodeErr)) {
+        lua_rawseti(L, -2, int(i+1));
+        continue;
+        }
+      if(err.empty())
+        err = item.error.empty() ? decodeErr : item.error;
+      }
+    if(err.empty())
+      lua_pushnil(L); else
+      lua_pushstring(L, err.c_str());
+
+    if(job.callbackRef!=LUA_NOREF) {
+      lua_rawgeti(L, LUA_REGISTRYINDEX, job.callbackRef);
+      lua_insert(L, -3);
+      lua_unref(L, job.callbackRef);
+      beginExec();
+      if(lua_pcall(L, 2, 0, 0)!=LUA_OK) {
+        Log::e("[Parallel] callback error (", job.id, "): ", lua_tostring(L, -1));
+        lua_pop(L, 1);
+        }
+      endExec();
+      continue;
+      }
+
+    auto it = asyncTasks.find(job.taskId);
+    if(it==asyncTasks.end() || it->second.cancelled || it->second.wait!=W_Parallel || uint32_t(it->second.wakeAt)!=job.id) {
+      lua_pop(L, 2);
+      continue;
+      }
+    lua_xmove(L, it->second.thread, 2);
+    resumeTask(job.taskId, 2, L);
+    }
   }
 
 void ScriptEngine::enableJIT() {
+  nativePolicy = CommandLine::inst().luaNative();
+  if(nativePolicy==CommandLine::NativeOff) {
+    Log::i("[ScriptEngine] JIT disabled");
+    return;
+    }
 #if defined(__x86_64__) || defined(__aarch64__) || defined(_M_X64)
   if(L && luau_codegen_supported()) {
     Luau::CodeGen::create(L);
     jitEnabled = true;
-    Log::i("[ScriptEngine] JIT enabled");
+    Log::i("[ScriptEngine] JIT enabled", nativePolicy==CommandLine::NativeAnnotated ? " for --!native modules" : "");
     } else {
     Log::i("[ScriptEngine] JIT not supported on this platform");
     }
@@ -270,21 +1102,140 @@ void ScriptEngine::enableJIT() {
 #endif
   }
 
+// Native-compiles the chunk on top of the stack, right after luau_load
+void ScriptEngine::compileNative(const char* chunkName, bool report) {
+  if(!jitEnabled)
+    return;
+#if defined(__x86_64__) || defined(__aarch64__) || defined(_M_X64)
+  using namespace Luau::CodeGen;
+  // 'annotated' leaves modules without the --!native hot comment to the interpreter
+  const unsigned   flags = nativePolicy==CommandLine::NativeAnnotated ? CodeGen_OnlyNativeModules : 0;
+  CompilationStats stats = {};
+  const auto       t0    = std::chrono::steady_clock::now();
+  const auto       res   = compile(L, -1, flags, &stats);
+  const double     ms    = elapsedMs(t0);
+
+  if(!report || res.result==CodeGenCompilationResult::NotNativeModule)
+    return;
+
+  const uint32_t skipped = stats.functionsTotal - stats.functionsCompiled;
+  ++nativeStats.modules;
+  nativeStats.functions += stats.functionsCompiled;
+  nativeStats.skipped   += skipped;
+  nativeStats.codeBytes += stats.nativeCodeSizeBytes;
+  nativeStats.ms        += ms;
+
+  Log::i("[ScriptEngine] Native: ", chunkName, ": ", stats.functionsCompiled, "/", stats.functionsTotal, " function(s), ",
+         stats.nativeCodeSizeBytes, " bytes, ", ms, " ms");
+  if(res.result!=CodeGenCompilationResult::Success && res.result!=CodeGenCompilationResult::NothingToCompile)
+    Log::e("[ScriptEngine] Native: ", chunkName, ": compilation failed (", int(res.result), ")");
+  for(auto& f : res.protoFailures)
+    Log::i("[ScriptEngine] Native: ", chunkName, ": skipped ", f.debugname.empty() ? "<anonymous>" : f.debugname.c_str(),
+           " at line ", f.line, " (", int(f.result), ")");
+#else
+  (void)chunkName;
+  (void)report;
+#endif
+  }
+
+void ScriptEngine::logLoadStats() const {
+  if(!bytecodeCacheDir.empty())
+    Log::i("[ScriptEngine] Bytecode cache: ", bytecodeCacheHits, " hit(s), ", bytecodeCacheMisses, " miss(es)");
+  if(jitEnabled)
+    Log::i("[ScriptEngine] Native code: ", nativeStats.modules, " module(s), ", nativeStats.functions, " function(s), ",
+           nativeStats.skipped, " skipped, ", nativeStats.codeBytes, " bytes, ", nativeStats.ms, " ms");
+  }
+
 bool ScriptEngine::compileScript(const std::string& source, std::string& outBytecode) {
   Luau::CompileOptions options;
-  options.optimizationLevel = 2;
-  options.debugLevel = 1;
+  options.optimizationLevel = LuauOptimizationLevel;
+  options.debugLevel = LuauDebugLevel;
 
   outBytecode = Luau::compile(source, options);
   return !outBytecode.empty();
   }
 
+bool ScriptEngine::compileCached(const std::string& chunkName, const std::string& source, std::string& outBytecode) {
+  if(bytecodeCacheDir.empty())
+    return compileScript(source, outBytecode);
+
+  BytecodeCacheHeader key;
+  key.sourceHash = fnv1a(source.data(), source.size());
+
+  char fname[32] = {};
+  std::snprintf(fname, sizeof(fname), "%016llx.luac", static_cast<unsigned long long>(fnv1a(chunkName.data(), chunkName.size())));
+  const std::filesystem::path file = std::filesystem::path(bytecodeCacheDir) / fname;
+
+  {
+  std::ifstream fin(file, std::ios::binary);
+  BytecodeCacheHeader hdr;
+  if(fin.read(reinterpret_cast<char*>(&hdr), sizeof(hdr)) && hdr.sameKey(key) &&
+     hdr.size>0 && hdr.size<BytecodeCacheMaxSize) {
+    outBytecode.resize(size_t(hdr.size));
+    if(fin.read(outBytecode.data(), std::streamsize(hdr.size))) {
+      ++bytecodeCacheHits;
+      return true;
+      }
+    }
+  }
+
+  ++bytecodeCacheMisses;
+  if(!compileScript(source, outBytecode))
+    return false;
+
+  // leading zero byte is a compile error: let luau_load report it, don't persist
+  if(outBytecode[0]==0)
+    return true;
+
+  std::error_code ec;
+  std::filesystem::create_directories(bytecodeCacheDir, ec);
+  auto tmp = file;
+  tmp += ".tmp";
+  {
+  std::ofstream fout(tmp, std::ios::binary | std::ios::trunc);
+  key.size = outBytecode.size();
+  fout.write(reinterpret_cast<const char*>(&key), sizeof(key));
+  fout.write(outBytecode.data(), std::streamsize(outBytecode.size()));
+  if(!fout) {
+    fout.close();
+    std::filesystem::remove(tmp, ec);
+    return true;
+    }
+  }
+  std::filesystem::rename(tmp, file, ec);
+  if(ec)
+    std::filesystem::remove(tmp, ec);
+  return true;
+  }
+
 bool ScriptEngine::loadGlobalScript(const std::string& filepath) {
   if(!L) {
     Log::e("[ScriptEngine] Not initialized");
     return false;
     }
 
+  // watched even if broken, so that fixing it reloads it
+  const int32_t module = internModule(filepath);
+  if(scriptWatcher)
+    scriptWatcher->add(filepath);
+
+  std::string source, bytecode;
+  if(!readScript(filepath, source) || !loadModuleChunk(filepath, source, bytecode))
+    return false;
+  if(!runModuleChunk(module))
+    return false;
+
+  ScriptInfo info;
+  info.filepath = filepath;
+  info.source   = source;
+  info.bytecode = bytecode;
+  loadedScripts.push_back(info);
+
+  Log::i("[ScriptEngine] Loaded: ", filepath);
+  return true;
+  }
+
+bool ScriptEngine::readScript(const std::string& filepath, std::string& source) {
   std::ifstream file(filepath);
   if(!file.is_open()) {
     Log::e("[ScriptEngine] Failed to open: ", filepath);
@@ -293,53 +1244,277 @@ bool ScriptEngine::loadGlobalScript(const std::string& filepath) {
 
   std::stringstream buffer;
   buffer << file.rdbuf();
-  std::string source = buffer.str();
+  source = buffer.str();
+  return true;
+  }
 
-  std::string bytecode;
-  if(!compileScript(source, bytecode)) {
+// Pushes the compiled chunk
+bool ScriptEngine::loadModuleChunk(const std::string& filepath, const std::string& source, std::string& bytecode) {
+  if(!compileCached(filepath, source, bytecode)) {
     Log::e("[ScriptEngine] Failed to compile: ", filepath);
     return false;
     }
 
-  if(luau_load(L, filepath.c_str(), bytecode.data(), bytecode.size(), 0) != 0) {
+  // functions of the chunk count towards its module
+  const int32_t outer = enterModule(L, internModule(filepath));
+  const int     err   = luau_load(L, filepath.c_str(), bytecode.data(), bytecode.size(), 0);
+  enterModule(L, outer);
+  if(err != 0) {
     Log::e("[ScriptEngine] Load error: ", lua_tostring(L, -1));
     lua_pop(L, 1);
     return false;
     }
+  compileNative(filepath.c_str(), true);
+  return true;
+  }
 
+// Runs the chunk on top of the stack and the onInit of the table it returns
+bool ScriptEngine::runModuleChunk(int32_t module) {
+  const int32_t outer = enterModule(L, module);
   if(lua_pcall(L, 0, 1, 0) != 0) {
     Log::e("[ScriptEngine] Runtime error: ", lua_tostring(L, -1));
     lua_pop(L, 1);
+    enterModule(L, outer);
     return false;
     }
 
-  ScriptInfo info;
-  info.filepath = filepath;
-  info.source   = source;
-  info.bytecode = bytecode;
-  loadedScripts.push_back(info);
+  if(lua_istable(L, -1)) {
+    lua_getfield(L, -1, "engineHandlers");
+    if(lua_istable(L, -1)) {
+      lua_getfield(L, -1, "onInit");
+      if(lua_isfunction(L, -1)) {
+        if(lua_pcall(L, 0, 0, 0) != 0) {
+          Log::e("[ScriptEngine] onInit error: ", lua_tostring(L, -1));
+          lua_pop(L, 1);
+          }
+        } else {
+        lua_pop(L, 1);
+        }
+      }
+    lua_pop(L, 1);
+    }
+  lua_pop(L, 1);
+  enterModule(L, outer);
+  return true;
+  }
+
+int32_t ScriptEngine::internModule(const std::string& filepath) {
+  auto it = moduleIds.find(filepath);
+  if(it!=moduleIds.end())
+    return it->second;
+  const int32_t id = int32_t(modulePaths.size());
+  modulePaths.push_back(filepath);
+  moduleIds[filepath] = id;
+  return id;
+  }
+
+int32_t ScriptEngine::callerModule(lua_State* from) const {
+  if(moduleIds.empty())
+    return -1;
+  lua_Debug ar = {};
+  for(int level=1; lua_getinfo(from, level, "s", &ar); ++level) {
+    if(ar.source==nullptr)
+      continue;
+    auto it = moduleIds.find(ar.source);
+    if(it!=moduleIds.end())
+      return it->second;
+    }
+  return -1;
+  }
+
+uint32_t ScriptEngine::nextHandlerId() {
+  lua_getglobal(L, "opengothic");
+  lua_getfield(L, -1, "events");
+  lua_getfield(L, -1, "_nextHandlerId");
+  const uint32_t id = uint32_t(std::max(lua_tointeger(L, -1), 0));
+  lua_pop(L, 3);
+  return id;
+  }
+
+uint32_t ScriptEngine::unregisterModuleHandlers(int32_t module, uint32_t fromId, uint32_t toId) {
+  uint32_t count = 0;
+  lua_getglobal(L, "opengothic");
+  lua_getfield(L, -1, "events");
+  lua_getfield(L, -1, "_unregisterModule");
+  if(lua_isfunction(L, -1)) {
+    lua_pushinteger(L, module);
+    lua_pushnumber(L, double(fromId));
+    lua_pushnumber(L, double(toId));
+    if(lua_pcall(L, 3, 1, 0) == LUA_OK)
+      count = uint32_t(std::max(lua_tointeger(L, -1), 0));
+    else
+      Log::e("[ScriptEngine] Error calling _unregisterModule: ", lua_tostring(L, -1));
+    }
+  lua_pop(L, 3);
+  return count;
+  }
+
+uint32_t ScriptEngine::cancelModuleTimers(int32_t module, uint32_t fromId, uint32_t toId) {
+  std::vector<uint32_t> ids;
+  for(auto& [id, t] : timers)
+    if(t.module==module && id>=fromId && id<toId)
+      ids.push_back(id);
+  for(auto id : ids)
+    cancelTimer(id);
+  return uint32_t(ids.size());
+  }
+
+int32_t* ScriptEngine::moduleSlot(lua_State* th) {
+  if(th==L)
+    return &memModule;
+  auto it = asyncTasks.find(asyncRunning);
+  if(it!=asyncTasks.end() && it->second.thread==th)
+    return &it->second.module;
+  return nullptr;
+  }
+
+// Switches the memory category of 'th', returns the module to switch back to
+int32_t ScriptEngine::enterModule(lua_State* th, int32_t module) {
+  int32_t* slot = moduleSlot(th);
+  if(slot==nullptr) {
+    lua_setmemcat(th, memoryCategory(module));
+    return -1;
+    }
+  const int32_t prev = *slot;
+  if(prev!=module) {
+    *slot = module;
+    lua_setmemcat(th, memoryCategory(module));
+    }
+  return prev;
+  }
+
+void ScriptEngine::checkMemoryLimits() {
+  const bool   profile = profiler.isEnabled();
+  const size_t count   = std::min(modulePaths.size(), size_t(LUA_MEMORY_CATEGORIES-1));
+  if(memStates.size()<count)
+    memStates.resize(count, M_Normal);
+  if(profile)
+    profiler.recordModuleMemory(0, "(engine)", int64_t(lua_totalbytes(L, 0)));
+
+  bool collected = false;
+  for(size_t i=0; i<count; ++i) {
+    const int32_t module = int32_t(i);
+    size_t        bytes  = lua_totalbytes(L, memoryCategory(module));
+    if(profile)
+      profiler.recordModuleMemory(i+1, modulePaths[i], int64_t(bytes));
+
+    auto& state = memStates[i];
+    if(state==M_Disabled)
+      continue;
+    const bool overSoft = memSoftLimit>0 && bytes>memSoftLimit;
+    const bool overHard = memHardLimit>0 && bytes>memHardLimit;
+    if(!overSoft && !overHard) {
+      state = M_Normal;
+      continue;
+      }
+    if(state==M_OverSoft && !overHard)
+      continue;
+
+    // garbage may be most of it: one emergency collection per frame
+    if(!collected) {
+      lua_gc(L, LUA_GCCOLLECT, 0);
+      collected = true;
+      bytes     = lua_totalbytes(L, memoryCategory(module));
+      }
+
+    if(memHardLimit>0 && bytes>memHardLimit) {
+      std::vector<uint32_t> tasks;
+      for(auto& [id, t] : asyncTasks)
+        if(t.module==module)
+          tasks.push_back(id);
+      for(auto id : tasks)
+        cancelTask(id);
+      const uint32_t handlers = unregisterModuleHandlers(module);
+      const uint32_t timers   = cancelModuleTimers(module);
+      state = M_Disabled;
+      Log::e("[ScriptEngine] ", modulePaths[i], " uses ", bytes/MegaByte, " MB, over the hard limit of ",
+             memHardLimit/MegaByte, " MB: disabled (dropped ", handlers, " handler(s), ", timers, " timer(s), ",
+             tasks.size(), " task(s))");
+      }
+    else if(memSoftLimit>0 && bytes>memSoftLimit) {
+      state = M_OverSoft;
+      Log::e("[ScriptEngine] ", modulePaths[i], " uses ", bytes/MegaByte, " MB after a full GC, soft limit is ",
+             memSoftLimit/MegaByte, " MB");
+      }
+    }
+  }
+
+std::vector<ScriptEngine::MemoryStats> ScriptEngine::memoryStats() const {
+  std::vector<MemoryStats> ret;
+  if(!L)
+    return ret;
+  ret.push_back(MemoryStats{std::string(), lua_totalbytes(L, 0), false});
+  const size_t count = std::min(modulePaths.size(), size_t(LUA_MEMORY_CATEGORIES-1));
+  for(size_t i=0; i<count; ++i) {
+    const bool disabled = i<memStates.size() && memStates[i]==M_Disabled;
+    ret.push_back(MemoryStats{modulePaths[i], lua_totalbytes(L, memoryCategory(int32_t(i))), disabled});
+    }
+  return ret;
+  }
+
+bool ScriptEngine::reloadScript(const std::string& filepath) {
+  if(!L)
+    return false;
+
+  const auto t0   = std::chrono::steady_clock::now();
+  auto       info = std::find_if(loadedScripts.begin(), loadedScripts.end(), [&](const ScriptInfo& i){
+    return i.filepath==filepath;
+    });
+
+  std::string source, bytecode;
+  if(!readScript(filepath, source))
+    return false;
+  if(info!=loadedScripts.end() && info->source==source)
+    return false;
+
+  // a script that doesn't compile leaves the running version untouched
+  if(!loadModuleChunk(filepath, source, bytecode)) {
+    Log::e("[ScriptEngine] Reload failed, keeping previous version of ", filepath);
+    return false;
+    }
 
-  if(lua_istable(L, -1)) {
-    lua_getfield(L, -1, "engineHandlers");
-    if(lua_istable(L, -1)) {
-      lua_getfield(L, -1, "onInit");
-      if(lua_isfunction(L, -1)) {
-        if(lua_pcall(L, 0, 0, 0) != 0) {
-          Log::e("[ScriptEngine] onInit error: ", lua_tostring(L, -1));
-          lua_pop(L, 1);
-          }
-        } else {
-        lua_pop(L, 1);
-        }
-      }
-    lua_pop(L, 1);
+  // run the new chunk next to the old one: the running version is only dropped once the new one
+  // loaded, everything registered below the id watermarks belongs to the old version
+  const int32_t  module       = internModule(filepath);
+  const uint32_t handlerMark  = nextHandlerId();
+  const uint32_t timerMark    = timerNextId;
+  const auto     prevMemState = size_t(module)<memStates.size() ? memStates[size_t(module)] : M_Normal;
+  if(size_t(module)<memStates.size())
+    memStates[size_t(module)] = M_Normal;
+  if(!runModuleChunk(module)) {
+    unregisterModuleHandlers(module, handlerMark);
+    cancelModuleTimers(module, timerMark);
+    if(size_t(module)<memStates.size())
+      memStates[size_t(module)] = prevMemState;
+    Log::e("[ScriptEngine] Reload failed, keeping previous version of ", filepath);
+    return false;
     }
-  lua_pop(L, 1);
 
-  Log::i("[ScriptEngine] Loaded: ", filepath);
+  const uint32_t handlers = unregisterModuleHandlers(module, 0, handlerMark);
+  const uint32_t timers   = cancelModuleTimers(module, 0, timerMark);
+  if(info!=loadedScripts.end()) {
+    info->source   = source;
+    info->bytecode = bytecode;
+    } else {
+    ScriptInfo si;
+    si.filepath = filepath;
+    si.source   = source;
+    si.bytecode = bytecode;
+    loadedScripts.push_back(si);
+    }
+
+  Log::i("[ScriptEngine] Reloaded ", filepath, " in ", elapsedMs(t0), " ms (dropped ",
+         handlers, " handler(s), ", timers, " timer(s))");
   return true;
   }
 
+void ScriptEngine::pollScriptChanges() {
+  if(!scriptWatcher)
+    return;
+  for(auto& path : scriptWatcher->poll())
+    reloadScript(path);
+  }
+
 bool ScriptEngine::loadScriptsFromManifest(const std::string& manifestPath) {
   std::ifstream file(manifestPath);
   if(!file.is_open()) {
@@ -369,6 +1544,7 @@ bool ScriptEngine::loadScriptsFromManifest(const std::string& manifestPath) {
     }
 
   Log::i("[ScriptEngine] Loaded ", loadedCount, " scripts from manifest");
+  logLoadStats();
   return loadedCount > 0;
   }
 
@@ -376,16 +1552,30 @@ void ScriptEngine::update(float dt) {
   if(!L)
     return;
 
-  (void)dispatchEvent("onUpdate", dt);
+  // closes the previous frame: rolls the window and checks the frame budget
+  profiler.endFrame();
+  checkMemoryLimits();
 
   World* world = Gothic::inst().world();
+  gtime  tm    = world!=nullptr ? world->time() : gtime();
+  int    stamp = int(tm.day()) * 24 * 60 + int(tm.hour()) * 60 + int(tm.minute());
+
+  pollScriptChanges();
+
+  scriptTime   += double(dt);
+  asyncGameTime = world!=nullptr ? stamp : -1;
+  runDueTasks();
+  runDueTimers();
+  runParallelJobs();
+
+  (void)dispatchEvent(onUpdateEvent, dt);
+  runWatchExprs();
+
   if(world == nullptr) {
     lastGameMinuteStamp = -1;
     return;
     }
 
-  gtime tm = world->time();
-  int stamp = int(tm.day()) * 24 * 60 + int(tm.hour()) * 60 + int(tm.minute());
   if(lastGameMinuteStamp < 0) {
     lastGameMinuteStamp = stamp;
     return;
@@ -393,61 +1583,129 @@ void ScriptEngine::update(float dt) {
 
   if(stamp != lastGameMinuteStamp) {
     lastGameMinuteStamp = stamp;
-    (void)dispatchEvent("onGameMinuteChanged", int(tm.day()), int(tm.hour()), int(tm.minute()));
+    (void)dispatchEvent(onGameMinuteEvent, int(tm.day()), int(tm.hour()), int(tm.minute()));
+    runMinuteTimers();
     }
   }
 
-std::string ScriptEngine::executeString(const std::string& code) {
-  if(!L)
-    return "Error: ScriptEngine not initialized";
+// Console rendering of the values in [first, last] on the stack
+static std::string consoleValues(lua_State* L, int first, int last) {
+  std::stringstream result;
+  for(int i = first; i <= last; i++) {
+    if(lua_isstring(L, i))
+      result << lua_tostring(L, i);
+    else if(lua_isnumber(L, i))
+      result << lua_tonumber(L, i);
+    else if(lua_isboolean(L, i))
+      result << (lua_toboolean(L, i) ? "true" : "false");
+    else if(lua_isnil(L, i))
+      result << "nil";
+    else
+      result << lua_typename(L, lua_type(L, i));
+
+    if(i < last)
+      result << ", ";
+    }
+  return result.str();
+  }
 
+// Compiles and loads a snippet, leaving the function on the stack
+bool ScriptEngine::loadConsoleChunk(const std::string& source, const char* chunkName, bool native, std::string& err) {
+  const auto  t0 = std::chrono::steady_clock::now();
   std::string bytecode;
-  if(!compileScript(code, bytecode))
-    return "Error: Compilation failed";
+  if(!compileScript(source, bytecode)) {
+    err = "Compilation failed";
+    return false;
+    }
 
-  if(luau_load(L, "console", bytecode.data(), bytecode.size(), 0) != 0) {
-    std::string error = lua_tostring(L, -1);
+  if(luau_load(L, chunkName, bytecode.data(), bytecode.size(), 0) != 0) {
+    err = lua_tostring(L, -1);
     lua_pop(L, 1);
-    return "Error: " + error;
+    return false;
+    }
+  // one-shot snippets stay interpreted, code generation costs more than it saves there
+  if(native)
+    compileNative(chunkName, false);
+  consoleCompileMs += elapsedMs(t0);
+  return true;
+  }
+
+bool ScriptEngine::pushConsoleChunk(const std::string& source, std::string& err) {
+  auto it = consoleChunkIds.find(source);
+  if(it != consoleChunkIds.end()) {
+    consoleChunks.splice(consoleChunks.begin(), consoleChunks, it->second);
+    lua_rawgeti(L, LUA_REGISTRYINDEX, it->second->fnRef);
+    ++consoleHits;
+    return true;
+    }
+
+  ++consoleMisses;
+  if(!loadConsoleChunk(source, "console", false, err))
+    return false;
+
+  if(consoleChunks.size() >= ConsoleCacheSize) {
+    auto& last = consoleChunks.back();
+    lua_unref(L, last.fnRef);
+    consoleChunkIds.erase(last.source);
+    consoleChunks.pop_back();
     }
+  lua_pushvalue(L, -1);
+  consoleChunks.push_front(ConsoleChunk{source, lua_ref(L, -1)});
+  lua_pop(L, 1);
+  consoleChunkIds[consoleChunks.front().source] = consoleChunks.begin();
+  return true;
+  }
+
+void ScriptEngine::clearConsoleChunks() {
+  if(L) {
+    for(auto& c : consoleChunks)
+      lua_unref(L, c.fnRef);
+    for(auto& w : watchExprList)
+      lua_unref(L, w.fnRef);
+    }
+  consoleChunkIds.clear();
+  consoleChunks.clear();
+  watchExprList.clear();
+  }
+
+ScriptEngine::ConsoleStats ScriptEngine::consoleStats() const {
+  ConsoleStats st;
+  st.hits      = consoleHits;
+  st.misses    = consoleMisses;
+  st.entries   = consoleChunks.size();
+  st.capacity  = ConsoleCacheSize;
+  st.compileMs = consoleCompileMs;
+  return st;
+  }
+
+std::string ScriptEngine::executeString(const std::string& code) {
+  if(!L)
+    return "Error: ScriptEngine not initialized";
+
+  std::string error;
+  if(!pushConsoleChunk(code, error))
+    return "Error: " + error;
 
   // Capture print output during execution
   std::string printOutput;
   consoleOutput = &printOutput;
 
+  beginExec();
   int status = lua_pcall(L, 0, LUA_MULTRET, 0);
+  endExec();
 
   consoleOutput = nullptr;
 
   if(status != 0) {
-    std::string error = lua_tostring(L, -1);
+    error = lua_tostring(L, -1);
     lua_pop(L, 1);
     return "Error: " + error;
     }
 
-  std::stringstream result;
-  int nresults = lua_gettop(L);
-
-  for(int i = 1; i <= nresults; i++) {
-    if(lua_isstring(L, i))
-      result << lua_tostring(L, i);
-    else if(lua_isnumber(L, i))
-      result << lua_tonumber(L, i);
-    else if(lua_isboolean(L, i))
-      result << (lua_toboolean(L, i) ? "true" : "false");
-    else if(lua_isnil(L, i))
-      result << "nil";
-    else
-      result << lua_typename(L, lua_type(L, i));
-
-    if(i < nresults)
-      result << ", ";
-    }
-
+  std::string returnValue = consoleValues(L, 1, lua_gettop(L));
   lua_settop(L, 0);
 
   // Combine print output and return values
-  std::string returnValue = result.str();
   if(!printOutput.empty() && !returnValue.empty())
     return printOutput + "\n" + returnValue;
   if(!printOutput.empty())
@@ -455,42 +1713,69 @@ std::string ScriptEngine::executeString(const std::string& code) {
   return returnValue;
   }
 
-ScriptEngine::ScriptData ScriptEngine::serialize() const {
-  ScriptData data;
+uint32_t ScriptEngine::addWatchExpr(const std::string& expr, std::string& err) {
+  if(!L) {
+    err = "ScriptEngine not initialized";
+    return 0;
+    }
 
-  // Call Lua: opengothic._serializeStorage()
-  lua_getglobal(L, "opengothic");
-  lua_getfield(L, -1, "_serializeStorage");
-  if(lua_isfunction(L, -1)) {
-    if(lua_pcall(L, 0, 1, 0) == LUA_OK) {
-      // Result is table {key = "value", ...}
-      if(lua_istable(L, -1)) {
-        lua_pushnil(L);
-        while(lua_next(L, -2) != 0) {
-          if(lua_isstring(L, -2) && lua_isstring(L, -1)) {
-            const char* key = lua_tostring(L, -2);
-            const char* val = lua_tostring(L, -1);
-            data.globalData[key] = val;
-            }
-          lua_pop(L, 1);
-          }
-        }
-      lua_pop(L, 1); // result
-      } else {
-      Log::e("[ScriptEngine] Error calling _serializeStorage: ", lua_tostring(L, -1));
-      lua_pop(L, 1); // error
-      }
-    } else {
-    lua_pop(L, 1); // non-function
+  // an expression first, a statement block returning values second
+  if(!loadConsoleChunk("--!native\nreturn " + expr, "watch", true, err) &&
+     !loadConsoleChunk("--!native\n" + expr, "watch", true, err))
+    return 0;
+
+  WatchExpr w;
+  w.id    = watchExprNextId++;
+  w.expr  = expr;
+  w.fnRef = lua_ref(L, -1);
+  lua_pop(L, 1);
+  watchExprList.push_back(std::move(w));
+  return watchExprList.back().id;
+  }
+
+bool ScriptEngine::removeWatchExpr(uint32_t id) {
+  for(size_t i=0; i<watchExprList.size(); ++i) {
+    if(watchExprList[i].id!=id)
+      continue;
+    if(L)
+      lua_unref(L, watchExprList[i].fnRef);
+    watchExprList.erase(watchExprList.begin()+ptrdiff_t(i));
+    return true;
     }
-  lua_pop(L, 1); // opengothic
+  return false;
+  }
+
+void ScriptEngine::clearWatchExprs() {
+  while(!watchExprList.empty())
+    removeWatchExpr(watchExprList.back().id);
+  }
+
+std::vector<ScriptEngine::WatchExprInfo> ScriptEngine::watchExprs() const {
+  std::vector<WatchExprInfo> ret;
+  ret.reserve(watchExprList.size());
+  for(auto& w : watchExprList)
+    ret.push_back(WatchExprInfo{w.id, w.expr, w.value});
+  return ret;
+  }
 
-  return data;
+void ScriptEngine::runWatchExprs() {
+  for(auto& w : watchExprList) {
+    const int top = lua_gettop(L);
+    lua_rawgeti(L, LUA_REGISTRYINDEX, w.fnRef);
+    beginExec();
+    const int status = lua_pcall(L, 0, LUA_MULTRET, 0);
+    endExec();
+    if(status != 0)
+      w.value = std::string("Error: ") + lua_tostring(L, -1); else
+      w.value = consoleValues(L, top+1, lua_gettop(L));
+    lua_settop(L, top);
+    }
   }
 
 void ScriptEngine::deserialize(const ScriptData& data) {
   if(!L)
     return;
+  clearStorageCache();
 
   // Build table from data
   lua_newtable(L);
@@ -514,17 +1799,111 @@ void ScriptEngine::deserialize(const ScriptData& data) {
   lua_pop(L, 2); // opengothic, data table
   }
 
-void ScriptEngine::save(Serialize& fout) const {
-  ScriptData data = serialize();
-  uint32_t count = static_cast<uint32_t>(data.globalData.size());
-  fout.write(count);
-  for(const auto& [key, value] : data.globalData) {
-    fout.write(key);
-    fout.write(value);
+void ScriptEngine::clearStorageCache() {
+  if(L) {
+    for(auto& [key, e] : storageCache)
+      lua_unref(L, e.valueRef);
+    }
+  storageCache.clear();
+  storageTracked.clear();
+  }
+
+void ScriptEngine::save(Serialize& fout) {
+  // tables that are neither frozen nor tracked may have been changed in place, so they are always re-encoded
+  uint32_t encoded = 0;
+  for(auto& [key, e] : storageCache)
+    e.seen = false;
+
+  lua_getglobal(L, "opengothic");
+  lua_getfield(L, -1, "storage");
+  if(lua_istable(L, -1)) {
+    lua_pushnil(L);
+    while(lua_next(L, -2) != 0) {
+      if(lua_type(L, -2)==LUA_TSTRING) {
+        const char* key     = lua_tostring(L, -2);
+        auto&       e       = storageCache[key];
+        const bool  tracked = storageTracked.count(key)>0;
+        bool        clean   = false;
+        if(e.valueRef!=LUA_NOREF && (e.immutable || (tracked && !e.dirty))) {
+          lua_rawgeti(L, LUA_REGISTRYINDEX, e.valueRef);
+          clean = lua_rawequal(L, -1, -2);
+          lua_pop(L, 1);
+          // catches in-place changes that were not followed by storageTouch
+          if(clean && !e.immutable)
+            clean = StorageCodec::hash(L, -1)==e.hash;
+          }
+        if(!clean) {
+          std::string blob, err;
+          bool        immutable = false;
+          lua_unref(L, e.valueRef);
+          e.valueRef = LUA_NOREF;
+          if(StorageCodec::encode(L, -1, blob, immutable, err)) {
+            e.valueRef  = lua_ref(L, -1);
+            e.immutable = immutable;
+            e.dirty     = false;
+            e.hash      = (tracked && !immutable) ? StorageCodec::hash(L, -1) : 0;
+            e.blob      = std::move(blob);
+            ++encoded;
+            } else {
+            Log::e("[ScriptEngine] Storage key '", key, "' not saved: ", err);
+            }
+          }
+        e.seen = e.valueRef!=LUA_NOREF;
+        }
+      lua_pop(L, 1);
+      }
     }
+  lua_pop(L, 2); // storage, opengothic
+
+  std::vector<const std::pair<const std::string, StorageEntry>*> entries;
+  for(auto i=storageCache.begin(); i!=storageCache.end();) {
+    if(!i->second.seen) {
+      lua_unref(L, i->second.valueRef);
+      i = storageCache.erase(i);
+      continue;
+      }
+    entries.push_back(&*i);
+    ++i;
+    }
+  std::sort(entries.begin(), entries.end(), [](auto* a, auto* b){ return a->first<b->first; });
+
+  fout.write(StorageCodec::Version, uint32_t(entries.size()));
+  for(auto* i : entries)
+    fout.write(i->first, i->second.blob);
+  Log::d("[ScriptEngine] Storage saved: ", entries.size(), " key(s), ", encoded, " re-encoded");
   }
 
 void ScriptEngine::load(Serialize& fin) {
+  uint32_t version = 0, count = 0;
+  fin.read(version, count);
+  if(version==0 || version>StorageCodec::Version) {
+    Log::e("[ScriptEngine] Unsupported storage data version: ", version);
+    return;
+    }
+
+  clearStorageCache();
+  lua_getglobal(L, "opengothic");
+  lua_newtable(L);
+  for(uint32_t i=0; i<count; ++i) {
+    std::string key, blob, err;
+    fin.read(key, blob);
+    if(!StorageCodec::decode(L, blob, err)) {
+      Log::e("[ScriptEngine] Storage key '", key, "' dropped: ", err);
+      continue;
+      }
+    // loaded values match the save: scalars keep their encoding for the next save, tables are
+    // encoded again unless frozen or tracked anew (tracking does not survive a load)
+    auto& e = storageCache[key];
+    e.valueRef  = lua_ref(L, -1);
+    e.immutable = !lua_istable(L, -1);
+    e.blob      = std::move(blob);
+    lua_setfield(L, -2, key.c_str());
+    }
+  lua_setfield(L, -2, "storage");
+  lua_pop(L, 1);
+  }
+
+void ScriptEngine::loadLegacy(Serialize& fin) {
   ScriptData data;
   uint32_t count = 0;
   fin.read(count);
@@ -537,6 +1916,92 @@ void ScriptEngine::load(Serialize& fin) {
   deserialize(data);
   }
 
+void ScriptEngine::saveTasks(Serialize& fout) const {
+  // coroutines can't be serialized: persistent tasks are stored as entry name + state table
+  // + pending wait, and restart their entry function with that state after the wait
+  std::vector<uint32_t> ids;
+  for(auto& [id, t] : asyncTasks)
+    if(t.stateRef!=LUA_NOREF && !t.cancelled)
+      ids.push_back(id);
+  std::sort(ids.begin(), ids.end());
+
+  // state tables use the opengothic.storage encoding; tasks whose state can't be encoded are dropped
+  std::vector<std::pair<uint32_t,std::string>> states;
+  for(auto id : ids) {
+    auto&       t = asyncTasks.at(id);
+    std::string blob, err;
+    bool        immutable = false;
+    lua_rawgeti(L, LUA_REGISTRYINDEX, t.stateRef);
+    if(StorageCodec::encode(L, -1, blob, immutable, err))
+      states.emplace_back(id, std::move(blob)); else
+      Log::e("[ScriptEngine] Async task '", t.label, "' not saved: ", err);
+    lua_pop(L, 1);
+    }
+
+  fout.write(AsyncSaveVersion, uint32_t(states.size()));
+  for(auto& [id, blob] : states) {
+    auto& t = asyncTasks.at(id);
+    const float       seconds   = t.wait==W_Seconds ? float(std::max(t.wakeAt-scriptTime, 0.0)) : 0.f;
+    const uint64_t    gameStamp = t.wait==W_GameMinutes ? uint64_t(std::max(t.wakeAt, 0.0)) : 0;
+    const std::string eventName = (t.wait==W_Event && t.eventId>=0) ? events[size_t(t.eventId)].name : std::string();
+    // parallel jobs are not saved: the task restarts from its state on the next update
+    const WaitKind    wait      = t.wait==W_Parallel ? W_NextUpdate : t.wait;
+    fout.write(t.label, uint8_t(wait), seconds, gameStamp, eventName, blob);
+    }
+  }
+
+void ScriptEngine::loadTasks(Serialize& fin) {
+  uint32_t version = 0, count = 0;
+  fin.read(version, count);
+  if(version!=AsyncSaveVersion) {
+    Log::e("[ScriptEngine] Unsupported async task data version: ", version);
+    return;
+    }
+
+  lua_getglobal(L, "opengothic");
+  lua_getfield(L, -1, "async");
+  lua_getfield(L, -1, "_entries");
+  for(uint32_t i=0; i<count; ++i) {
+    std::string name, eventName, blob, err;
+    uint8_t     wait      = 0;
+    float       seconds   = 0;
+    uint64_t    gameStamp = 0;
+    fin.read(name, wait, seconds, gameStamp, eventName, blob);
+
+    if(!StorageCodec::decode(L, blob, err)) {
+      Log::e("[ScriptEngine] Async task '", name, "' dropped: ", err);
+      continue;
+      }
+    if(!lua_istable(L, -1)) {
+      Log::e("[ScriptEngine] Async task '", name, "' dropped: state is not a table");
+      lua_pop(L, 1);
+      continue;
+      }
+
+    if(lua_istable(L, -2))
+      lua_getfield(L, -2, name.c_str()); else
+      lua_pushnil(L);
+    if(!lua_isfunction(L, -1) || wait>W_Event) {
+      Log::e("[ScriptEngine] Async task '", name, "' is not defined, dropped");
+      lua_pop(L, 2);
+      continue;
+      }
+    lua_insert(L, -2);
+
+    const int      stateRef = lua_ref(L, -1);
+    const uint32_t id       = createTask(L, 1);
+
+    auto& t = asyncTasks[id];
+    t.label    = name;
+    t.stateRef = stateRef;
+    t.wait     = WaitKind(wait);
+    t.wakeAt   = (t.wait==W_Seconds) ? scriptTime + double(seconds) : double(gameStamp);
+    t.eventId  = (t.wait==W_Event) ? internEvent(eventName) : -1;
+    queueTask(id);
+    }
+  lua_pop(L, 3);
+  }
+
 std::vector<std::string> ScriptEngine::getLoadedScripts() const {
   std::vector<std::string> scripts;
   for(const auto& info : loadedScripts)
@@ -553,8 +2018,12 @@ void ScriptEngine::reloadAllScripts() {
 
   loadedScripts.clear();
 
+  const uint32_t hits   = bytecodeCacheHits;
+  const uint32_t misses = bytecodeCacheMisses;
   for(const auto& path : paths)
     loadGlobalScript(path);
+  if(!bytecodeCacheDir.empty())
+    Log::i("[ScriptEngine] Bytecode cache: ", bytecodeCacheHits-hits, " hit(s), ", bytecodeCacheMisses-misses, " miss(es)");
   }
 
 void ScriptEngine::loadModScripts() {
@@ -600,6 +2069,8 @@ void ScriptEngine::loadModScripts() {
     auto path = TextCodec::toUtf8(script);
     loadGlobalScript(path);
     }
+
+  logLoadStats();
   }
 
 // --- Internal API (low-level, _ prefixed) ---
@@ -662,8 +2133,7 @@ int ScriptEngine::luaInventoryGetItems(lua_State* L) {
   int idx = 1;
   for(auto it = inv->iterator(Inventory::T_Ransack); it.isValid(); ++it) {
     Item* item = const_cast<Item*>(&(*it));
-    Lua::push(L, item);
-    Lua::setMetatable(L, "Item");
+    Lua::pushProxy(L, item);
     lua_rawseti(L, -2, idx++);
     }
   return 1;
@@ -776,8 +2246,7 @@ int ScriptEngine::luaInventoryAddItem(lua_State* L) {
   Item* addedItem = inv->addItem(static_cast<size_t>(itemId), static_cast<size_t>(count), *world);
 
   if (addedItem) {
-    Lua::push(L, addedItem);
-    Lua::setMetatable(L, "Item");
+    Lua::pushProxy(L, addedItem);
   } else {
     lua_pushnil(L);
   }
@@ -819,8 +2288,7 @@ static const luaL_Reg inventory_meta[] = {
   int ScriptEngine::luaNpcInventory(lua_State* L) {
     auto* npc = Lua::check<Npc>(L, 1, "Npc");
     if(npc) {
-      Lua::push(L, &npc->inventory());
-      Lua::setMetatable(L, "Inventory");
+      Lua::pushProxy(L, &npc->inventory());
       } else {
       lua_pushnil(L);
       }
@@ -830,8 +2298,7 @@ static const luaL_Reg inventory_meta[] = {
   int ScriptEngine::luaNpcWorld(lua_State* L) {
     auto* npc = Lua::check<Npc>(L, 1, "Npc");
     if(npc) {
-      Lua::push(L, &npc->world());
-      Lua::setMetatable(L, "World");
+      Lua::pushProxy(L, &npc->world());
       } else {
       lua_pushnil(L);
       }
@@ -907,8 +2374,7 @@ static const luaL_Reg inventory_meta[] = {
       }
     Item* weapon = npc->activeWeapon();
     if(weapon) {
-      Lua::push(L, weapon);
-      Lua::setMetatable(L, "Item");
+      Lua::pushProxy(L, weapon);
       } else {
       lua_pushnil(L);
       }
@@ -965,8 +2431,7 @@ static const luaL_Reg inventory_meta[] = {
       }
     Npc* target = npc->target();
     if(target != nullptr) {
-      Lua::push(L, target);
-      Lua::setMetatable(L, "Npc");
+      Lua::pushProxy(L, target);
       } else {
       lua_pushnil(L);
       }
@@ -1336,8 +2801,7 @@ static const luaL_Reg inventory_meta[] = {
       }
     Item* item = npc->getItem(itemId);
     if(item) {
-      Lua::push(L, item);
-      Lua::setMetatable(L, "Item");
+      Lua::pushProxy(L, item);
       } else {
       lua_pushnil(L);
       }
@@ -1426,8 +2890,7 @@ static const luaL_Reg inventory_meta[] = {
       }
     Item* item = world->addItem(itemInstance, Tempest::Vec3(x, y, z));
     if(item) {
-      Lua::push(L, item);
-      Lua::setMetatable(L, "Item");
+      Lua::pushProxy(L, item);
       } else {
       lua_pushnil(L);
       }
@@ -1444,8 +2907,7 @@ static const luaL_Reg inventory_meta[] = {
       }
     Item* item = world->addItem(itemInstance, waypoint);
     if(item) {
-      Lua::push(L, item);
-      Lua::setMetatable(L, "Item");
+      Lua::pushProxy(L, item);
       } else {
       lua_pushnil(L);
       }
@@ -1473,8 +2935,7 @@ static const luaL_Reg inventory_meta[] = {
       }
     Npc* npc = world->addNpc(npcInstance, Tempest::Vec3(x, y, z));
     if(npc) {
-      Lua::push(L, npc);
-      Lua::setMetatable(L, "Npc");
+      Lua::pushProxy(L, npc);
       } else {
       lua_pushnil(L);
       }
@@ -1491,8 +2952,7 @@ static const luaL_Reg inventory_meta[] = {
       }
     Npc* npc = world->addNpc(npcInstance, waypoint);
     if(npc) {
-      Lua::push(L, npc);
-      Lua::setMetatable(L, "Npc");
+      Lua::pushProxy(L, npc);
       } else {
       lua_pushnil(L);
       }
@@ -1509,8 +2969,7 @@ static const luaL_Reg inventory_meta[] = {
       }
     Item* item = world->findItemByInstance(itemInstance, n);
     if(item) {
-      Lua::push(L, item);
-      Lua::setMetatable(L, "Item");
+      Lua::pushProxy(L, item);
       } else {
       lua_pushnil(L);
       }
@@ -1527,8 +2986,7 @@ static const luaL_Reg inventory_meta[] = {
       }
     Npc* npc = world->findNpcByInstance(npcInstance, n);
     if(npc) {
-      Lua::push(L, npc);
-      Lua::setMetatable(L, "Npc");
+      Lua::pushProxy(L, npc);
       } else {
       lua_pushnil(L);
       }
@@ -1544,8 +3002,7 @@ static const luaL_Reg inventory_meta[] = {
       }
     Interactive* interactive = world->mobsiById(static_cast<uint32_t>(instanceId));
     if(interactive) {
-      Lua::push(L, interactive);
-      Lua::setMetatable(L, "Interactive");
+      Lua::pushProxy(L, interactive);
       } else {
       lua_pushnil(L);
       }
@@ -1560,8 +3017,7 @@ static const luaL_Reg inventory_meta[] = {
       }
     Npc* player = world->player();
     if(player) {
-      Lua::push(L, player);
-      Lua::setMetatable(L, "Npc");
+      Lua::pushProxy(L, player);
       } else {
       lua_pushnil(L);
       }
@@ -1616,8 +3072,7 @@ static const luaL_Reg inventory_meta[] = {
     lua_newtable(L);
     int idx = 1;
     world->detectNpc(Tempest::Vec3(x, y, z), range, [L, &idx](Npc& npc) {
-      Lua::push(L, &npc);
-      Lua::setMetatable(L, "Npc");
+      Lua::pushProxy(L, &npc);
       lua_rawseti(L, -2, idx++);
       });
     return 1;
@@ -1637,8 +3092,7 @@ static const luaL_Reg inventory_meta[] = {
     lua_newtable(L);
     int idx = 1;
     world->detectNpc(pos, range, [L, &idx](Npc& npc) {
-      Lua::push(L, &npc);
-      Lua::setMetatable(L, "Npc");
+      Lua::pushProxy(L, &npc);
       lua_rawseti(L, -2, idx++);
       });
     return 1;
@@ -1654,29 +3108,39 @@ static const luaL_Reg inventory_meta[] = {
       return 1;
       }
 
-    Npc* nearest = nullptr;
-    float nearestDist = std::numeric_limits<float>::max();
-    const auto pos = origin->position();
-
-    world->detectNpc(pos, range, [&](Npc& npc) {
-      if(&npc == origin)
-        return;
-      float dist = std::sqrt(origin->qDistTo(npc));
-      if(dist < nearestDist) {
-        nearestDist = dist;
-        nearest = &npc;
-        }
-      });
+    std::vector<Npc*> nearest;
+    world->findNearestNpcs(origin->position(), range, 1, origin, nearest);
 
-    if(nearest) {
-      Lua::push(L, nearest);
-      Lua::setMetatable(L, "Npc");
+    if(!nearest.empty()) {
+      Lua::pushProxy(L, nearest[0]);
       } else {
       lua_pushnil(L);
       }
     return 1;
     }
 
+  int ScriptEngine::luaWorldFindNearestNpcs(lua_State* L) {
+    auto* world  = Lua::check<World>(L, 1, "World");
+    auto* origin = Lua::check<Npc>(L, 2, "Npc");
+    int   k      = luaL_checkinteger(L, 3);
+    float range  = static_cast<float>(luaL_checknumber(L, 4));
+
+    lua_newtable(L);
+    if(!world || !origin || k <= 0 || range <= 0.f) {
+      return 1;
+      }
+
+    std::vector<Npc*> nearest;
+    world->findNearestNpcs(origin->position(), range, size_t(k), origin, nearest);
+
+    int idx = 1;
+    for(auto* npc : nearest) {
+      Lua::pushProxy(L, npc);
+      lua_rawseti(L, -2, idx++);
+      }
+    return 1;
+    }
+
   int ScriptEngine::luaWorldDetectItemsInRange(lua_State* L) {
     auto* world = Lua::check<World>(L, 1, "World");
     float x = static_cast<float>(luaL_checknumber(L, 2));
@@ -1691,8 +3155,7 @@ static const luaL_Reg inventory_meta[] = {
 
     int idx = 1;
     world->detectItem(Tempest::Vec3(x, y, z), range, [L, &idx](Item& item) {
-      Lua::push(L, &item);
-      Lua::setMetatable(L, "Item");
+      Lua::pushProxy(L, &item);
       lua_rawseti(L, -2, idx++);
       });
     return 1;
@@ -1708,44 +3171,349 @@ static const luaL_Reg inventory_meta[] = {
       return 1;
       }
 
-    const auto pos = origin->position();
-    int idx = 1;
-    world->detectItem(pos, range, [L, &idx](Item& item) {
-      Lua::push(L, &item);
-      Lua::setMetatable(L, "Item");
-      lua_rawseti(L, -2, idx++);
-      });
+    const auto pos = origin->position();
+    int idx = 1;
+    world->detectItem(pos, range, [L, &idx](Item& item) {
+      Lua::pushProxy(L, &item);
+      lua_rawseti(L, -2, idx++);
+      });
+    return 1;
+    }
+
+  int ScriptEngine::luaWorldFindNearestItem(lua_State* L) {
+    auto* world  = Lua::check<World>(L, 1, "World");
+    auto* origin = Lua::check<Npc>(L, 2, "Npc");
+    float range  = static_cast<float>(luaL_checknumber(L, 3));
+
+    if(!world || !origin || range <= 0.f) {
+      lua_pushnil(L);
+      return 1;
+      }
+
+    Item* nearest = nullptr;
+    float nearestQDist = std::numeric_limits<float>::max();
+    const auto pos = origin->position();
+
+    world->detectItem(pos, range, [&](Item& item) {
+      float qDist = origin->qDistTo(item);
+      if(qDist < nearestQDist) {
+        nearestQDist = qDist;
+        nearest = &item;
+        }
+      });
+
+    if(nearest) {
+      Lua::pushProxy(L, nearest);
+      } else {
+      lua_pushnil(L);
+      }
+    return 1;
+    }
+
+  namespace {
+  // Columns of world:snapshotNpcs(); requested by group name, 'id' is always present
+  enum NpcColumn : uint8_t {
+    NC_Id,
+    NC_Npc,
+    NC_X,
+    NC_Y,
+    NC_Z,
+    NC_RotationY,
+    NC_Hp,
+    NC_HpMax,
+    NC_Mana,
+    NC_ManaMax,
+    NC_Level,
+    NC_Guild,
+    NC_Instance,
+    NC_Flags,
+    NC_Count,
+    };
+
+  const char* const npcColumnNames[NC_Count] = {
+    "id", "npc", "x", "y", "z", "rotationY", "hp", "hpMax", "mana", "manaMax", "level", "guild", "instance", "flags",
+    };
+
+  struct NpcColumnGroup {
+    const char* name;
+    NpcColumn   first;
+    NpcColumn   last;
+    bool        byDefault;
+    };
+
+  const NpcColumnGroup npcColumnGroups[] = {
+    {"npc",      NC_Npc,       NC_Npc,       false},
+    {"position", NC_X,         NC_Z,         true },
+    {"rotation", NC_RotationY, NC_RotationY, true },
+    {"hp",       NC_Hp,        NC_HpMax,     true },
+    {"mana",     NC_Mana,      NC_ManaMax,   true },
+    {"level",    NC_Level,     NC_Level,     true },
+    {"guild",    NC_Guild,     NC_Guild,     true },
+    {"instance", NC_Instance,  NC_Instance,  true },
+    {"flags",    NC_Flags,     NC_Flags,     true },
+    };
+  }
+
+  // matches opengothic.CONSTANTS.NpcFlag
+  static int32_t npcSnapshotFlags(const Npc& npc) {
+    int32_t flags = 0;
+    if(npc.isDead())
+      flags |= 1;
+    if(npc.isUnconscious())
+      flags |= 2;
+    if(npc.isPlayer())
+      flags |= 4;
+    if(npc.isTalk())
+      flags |= 8;
+    return flags;
+    }
+
+  // snapshotNpcs([fields]) -> { count, id = {...}, x = {...}, ... }
+  // One pass over the world's npc list; each requested column is an array indexed by row
+  int ScriptEngine::luaWorldSnapshotNpcs(lua_State* L) {
+    auto* world = Lua::check<World>(L, 1, "World");
+
+    bool columns[NC_Count] = {};
+    columns[NC_Id] = true;
+    if(lua_isnoneornil(L, 2)) {
+      for(auto& g : npcColumnGroups)
+        for(int c=g.first; c<=g.last; ++c)
+          columns[c] |= g.byDefault;
+      } else {
+      luaL_checktype(L, 2, LUA_TTABLE);
+      const int n = lua_objlen(L, 2);
+      for(int i=1; i<=n; ++i) {
+        lua_rawgeti(L, 2, i);
+        const char* name  = lua_tostring(L, -1);
+        bool        found = false;
+        for(auto& g : npcColumnGroups) {
+          if(name==nullptr || std::strcmp(name, g.name)!=0)
+            continue;
+          for(int c=g.first; c<=g.last; ++c)
+            columns[c] = true;
+          found = true;
+          }
+        if(!found)
+          luaL_error(L, "snapshotNpcs: unknown field '%s'", name ? name : "?");
+        lua_pop(L, 1);
+        }
+      }
+
+    const uint32_t count = world ? world->npcCount() : 0;
+    lua_newtable(L);
+    lua_pushinteger(L, int(count));
+    lua_setfield(L, -2, "count");
+
+    NpcColumn active[NC_Count] = {};
+    int       activeCount      = 0;
+    for(int c=0; c<NC_Count; ++c)
+      if(columns[c])
+        active[activeCount++] = NpcColumn(c);
+
+    luaL_checkstack(L, activeCount, "snapshotNpcs");
+    const int base = lua_gettop(L) + 1;
+    for(int c=0; c<activeCount; ++c)
+      lua_createtable(L, int(count), 0);
+
+    for(uint32_t i=0; i<count; ++i) {
+      Npc&          npc = *world->npcById(i);
+      const int     row = int(i) + 1;
+      Tempest::Vec3 pos = columns[NC_X] ? npc.position() : Tempest::Vec3();
+      for(int c=0; c<activeCount; ++c) {
+        switch(active[c]) {
+          case NC_Id:        lua_pushinteger(L, int(i)); break;
+          case NC_Npc:       Lua::pushProxy(L, &npc); break;
+          case NC_X:         lua_pushnumber(L, pos.x); break;
+          case NC_Y:         lua_pushnumber(L, pos.y); break;
+          case NC_Z:         lua_pushnumber(L, pos.z); break;
+          case NC_RotationY: lua_pushnumber(L, npc.rotationY()); break;
+          case NC_Hp:        lua_pushinteger(L, npc.attribute(Attribute::ATR_HITPOINTS)); break;
+          case NC_HpMax:     lua_pushinteger(L, npc.attribute(Attribute::ATR_HITPOINTSMAX)); break;
+          case NC_Mana:      lua_pushinteger(L, npc.attribute(Attribute::ATR_MANA)); break;
+          case NC_ManaMax:   lua_pushinteger(L, npc.attribute(Attribute::ATR_MANAMAX)); break;
+          case NC_Level:     lua_pushinteger(L, npc.level()); break;
+          case NC_Guild:     lua_pushinteger(L, static_cast<lua_Integer>(npc.guild())); break;
+          case NC_Instance:  lua_pushinteger(L, static_cast<int>(npc.instanceSymbol())); break;
+          case NC_Flags:     lua_pushinteger(L, npcSnapshotFlags(npc)); break;
+          case NC_Count:     lua_pushnil(L); break;
+          }
+        lua_rawseti(L, base+c, row);
+        }
+      }
+
+    for(int c=activeCount-1; c>=0; --c)
+      lua_setfield(L, base-1, npcColumnNames[active[c]]);
     return 1;
     }
 
-  int ScriptEngine::luaWorldFindNearestItem(lua_State* L) {
-    auto* world  = Lua::check<World>(L, 1, "World");
-    auto* origin = Lua::check<Npc>(L, 2, "Npc");
-    float range  = static_cast<float>(luaL_checknumber(L, 3));
+  // applyNpcChanges(batch) -> changed
+  // batch = { id = {...}, hp = {...}, mana = {...}, x/y/z = {...}, rotationY = {...} }
+  // rows are matched by index; nil entries leave the value unchanged
+  int ScriptEngine::luaWorldApplyNpcChanges(lua_State* L) {
+    auto* world = Lua::check<World>(L, 1, "World");
+    luaL_checktype(L, 2, LUA_TTABLE);
 
-    if(!world || !origin || range <= 0.f) {
-      lua_pushnil(L);
+    static const NpcColumn writable[] = {NC_Hp, NC_Mana, NC_X, NC_Y, NC_Z, NC_RotationY};
+    lua_getfield(L, 2, "id");
+    const int ids = lua_gettop(L);
+    for(auto c : writable) {
+      lua_getfield(L, 2, npcColumnNames[c]);
+      if(!lua_istable(L, -1)) {
+        lua_pop(L, 1);
+        lua_pushnil(L);
+        }
+      }
+    const int col = ids + 1; // columns in 'writable' order
+
+    if(!world || !lua_istable(L, ids)) {
+      lua_pushinteger(L, 0);
       return 1;
       }
 
-    Item* nearest = nullptr;
-    float nearestQDist = std::numeric_limits<float>::max();
-    const auto pos = origin->position();
+    auto value = [L](int tbl, int row, double& out) {
+      if(lua_isnil(L, tbl))
+        return false;
+      lua_rawgeti(L, tbl, row);
+      const bool ok = lua_isnumber(L, -1);
+      if(ok)
+        out = lua_tonumber(L, -1);
+      lua_pop(L, 1);
+      return ok;
+      };
 
-    world->detectItem(pos, range, [&](Item& item) {
-      float qDist = origin->qDistTo(item);
-      if(qDist < nearestQDist) {
-        nearestQDist = qDist;
-        nearest = &item;
+    const uint32_t count   = world->npcCount();
+    const int      rows    = lua_objlen(L, ids);
+    int            changed = 0;
+    for(int row=1; row<=rows; ++row) {
+      double id = -1;
+      if(!value(ids, row, id) || id<0 || id>=double(count))
+        continue;
+      Npc&   npc = *world->npcById(uint32_t(id));
+      double v = 0, x = 0, y = 0, z = 0;
+      bool   any = false;
+      if(value(col+0, row, v)) {
+        npc.changeAttribute(Attribute::ATR_HITPOINTS, int32_t(v) - npc.attribute(Attribute::ATR_HITPOINTS), true);
+        any = true;
         }
-      });
-
-    if(nearest) {
-      Lua::push(L, nearest);
-      Lua::setMetatable(L, "Item");
-      } else {
-      lua_pushnil(L);
+      if(value(col+1, row, v)) {
+        npc.changeAttribute(Attribute::ATR_MANA, int32_t(v) - npc.attribute(Attribute::ATR_MANA), false);
+        any = true;
+        }
+      if(value(col+2, row, x) && value(col+3, row, y) && value(col+4, row, z)) {
+        npc.setPosition(float(x), float(y), float(z));
+        any = true;
+        }
+      if(value(col+5, row, v)) {
+        npc.setDirectionY(float(v));
+        any = true;
+        }
+      changed += any ? 1 : 0;
       }
+
+    lua_pushinteger(L, changed);
+    return 1;
+    }
+
+  // npcThink([mode]) -> { mode, ticks, npcs, thinkRays, hits, misses, mismatches, serialHash, parallelHash }
+  // mode = "serial" | "parallel" | "verify"; switching the mode resets the counters
+  int ScriptEngine::luaWorldNpcThink(lua_State* L) {
+    static const char* modes[] = {"serial", "parallel", "verify", nullptr};
+    auto* world = Lua::check<World>(L, 1, "World");
+    if(!lua_isnoneornil(L, 2)) {
+      const int m = luaL_checkoption(L, 2, nullptr, modes);
+      world->setNpcThink(WorldObjects::NpcThink(m));
+      world->resetThinkStats();
+      }
+
+    auto& st = world->thinkStats();
+    lua_createtable(L, 0, 9);
+    lua_pushstring(L, modes[int(world->npcThink())]);
+    lua_setfield(L, -2, "mode");
+    lua_pushnumber(L, double(st.ticks));
+    lua_setfield(L, -2, "ticks");
+    lua_pushnumber(L, double(st.npcs));
+    lua_setfield(L, -2, "npcs");
+    lua_pushnumber(L, double(st.thinkRays));
+    lua_setfield(L, -2, "thinkRays");
+    lua_pushnumber(L, double(st.hits));
+    lua_setfield(L, -2, "hits");
+    lua_pushnumber(L, double(st.misses));
+    lua_setfield(L, -2, "misses");
+    lua_pushnumber(L, double(st.mismatches));
+    lua_setfield(L, -2, "mismatches");
+    char buf[32] = {};
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(st.serialHash));
+    lua_pushstring(L, buf);
+    lua_setfield(L, -2, "serialHash");
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(st.parallelHash));
+    lua_pushstring(L, buf);
+    lua_setfield(L, -2, "parallelHash");
+    return 1;
+    }
+
+  // stateHash() -> 16 hex digits, FNV-1a over npc positions, rotation, attributes and state
+  int ScriptEngine::luaWorldStateHash(lua_State* L) {
+    auto* world = Lua::check<World>(L, 1, "World");
+    char  buf[32] = {};
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(world->stateHash()));
+    lua_pushstring(L, buf);
+    return 1;
+    }
+
+  // aiLod([{ farPeriod, far2Period, farBudget, far2Budget }]) -> config and counters of the last
+  // frame: { ..., frames, deferred, ticked = { player, normal, far, far2 }, skipped = { ... } }
+  // omitted fields are kept; changing the config resets the counters
+  int ScriptEngine::luaWorldAiLod(lua_State* L) {
+    static const char* policies[] = {"player", "normal", "far", "far2"};
+    auto* world = Lua::check<World>(L, 1, "World");
+    if(!lua_isnoneornil(L, 2)) {
+      luaL_checktype(L, 2, LUA_TTABLE);
+      auto lod   = world->aiLod();
+      auto field = [L](const char* name, uint32_t& v, int min) {
+        lua_getfield(L, 2, name);
+        if(!lua_isnil(L, -1)) {
+          const int i = luaL_checkinteger(L, -1);
+          if(i<min)
+            luaL_error(L, "aiLod: %s must be at least %d", name, min);
+          v = uint32_t(i);
+          }
+        lua_pop(L, 1);
+        };
+      field("farPeriod",  lod.farPeriod,  1);
+      field("far2Period", lod.far2Period, 1);
+      field("farBudget",  lod.farBudget,  0);
+      field("far2Budget", lod.far2Budget, 0);
+      world->setAiLod(lod);
+      world->resetAiLodStats();
+      }
+
+    auto& lod = world->aiLod();
+    auto& st  = world->aiLodStats();
+    lua_createtable(L, 0, 8);
+    lua_pushinteger(L, static_cast<lua_Integer>(lod.farPeriod));
+    lua_setfield(L, -2, "farPeriod");
+    lua_pushinteger(L, static_cast<lua_Integer>(lod.far2Period));
+    lua_setfield(L, -2, "far2Period");
+    lua_pushinteger(L, static_cast<lua_Integer>(lod.farBudget));
+    lua_setfield(L, -2, "farBudget");
+    lua_pushinteger(L, static_cast<lua_Integer>(lod.far2Budget));
+    lua_setfield(L, -2, "far2Budget");
+    lua_pushnumber(L, double(st.frames));
+    lua_setfield(L, -2, "frames");
+    lua_pushinteger(L, static_cast<lua_Integer>(st.deferred));
+    lua_setfield(L, -2, "deferred");
+    lua_createtable(L, 0, 4);
+    for(size_t i=0; i<WorldObjects::AiLodStats::PolicyCount; ++i) {
+      lua_pushinteger(L, static_cast<lua_Integer>(st.ticked[i]));
+      lua_setfield(L, -2, policies[i]);
+      }
+    lua_setfield(L, -2, "ticked");
+    lua_createtable(L, 0, 4);
+    for(size_t i=0; i<WorldObjects::AiLodStats::PolicyCount; ++i) {
+      lua_pushinteger(L, static_cast<lua_Integer>(st.skipped[i]));
+      lua_setfield(L, -2, policies[i]);
+      }
+    lua_setfield(L, -2, "skipped");
     return 1;
     }
 
@@ -1835,8 +3603,7 @@ static const luaL_Reg inventory_meta[] = {
   int ScriptEngine::luaInteractiveInventory(lua_State* L) {
     auto* inter = Lua::check<Interactive>(L, 1, "Interactive");
     if(inter) {
-      Lua::push(L, &inter->inventory());
-      Lua::setMetatable(L, "Inventory");
+      Lua::pushProxy(L, &inter->inventory());
       } else {
       lua_pushnil(L);
       }
@@ -1908,8 +3675,7 @@ static const luaL_Reg inventory_meta[] = {
       lua_pushnil(L);
       return 1;
       }
-    Lua::push(L, world);
-    Lua::setMetatable(L, "World");
+    Lua::pushProxy(L, world);
     return 1;
     }
 
@@ -1924,8 +3690,7 @@ static const luaL_Reg inventory_meta[] = {
       lua_pushnil(L);
       return 1;
       }
-    Lua::push(L, player);
-    Lua::setMetatable(L, "Npc");
+    Lua::pushProxy(L, player);
     return 1;
     }
 
@@ -1971,6 +3736,475 @@ static const luaL_Reg inventory_meta[] = {
     return 0;
     }
 
+  // --- Event dispatch table ---
+
+  // _callerModule() -> id of the script module up the stack, or nil
+  int ScriptEngine::luaCallerModule(lua_State* L) {
+    lua_getfield(L, LUA_REGISTRYINDEX, "ScriptEngine");
+    auto* engine = static_cast<ScriptEngine*>(lua_touserdata(L, -1));
+    lua_pop(L, 1);
+
+    const int32_t module = engine!=nullptr ? engine->callerModule(L) : -1;
+    if(module<0)
+      return 0;
+    lua_pushinteger(L, module);
+    return 1;
+    }
+
+  // _enterModule(module) -> module that was running; nil is the engine
+  int ScriptEngine::luaEnterModule(lua_State* L) {
+    lua_getfield(L, LUA_REGISTRYINDEX, "ScriptEngine");
+    auto* engine = static_cast<ScriptEngine*>(lua_touserdata(L, -1));
+    lua_pop(L, 1);
+    if(engine==nullptr)
+      return 0;
+
+    const int32_t module = lua_isnumber(L, 1) ? int32_t(lua_tointeger(L, 1)) : -1;
+    const int32_t prev   = engine->enterModule(L, module);
+    if(prev<0)
+      return 0;
+    lua_pushinteger(L, prev);
+    return 1;
+    }
+
+  // storageTrack(key): the table in opengothic.storage[key] is only changed in place together with
+  // storageTouch(key), so saves reuse its encoding until it is touched, reassigned or its content hash
+  // differs. Tracking is dropped on load and session exit
+  int ScriptEngine::luaStorageTrack(lua_State* L) {
+    const char* key = luaL_checkstring(L, 1);
+    lua_getfield(L, LUA_REGISTRYINDEX, "ScriptEngine");
+    auto* engine = static_cast<ScriptEngine*>(lua_touserdata(L, -1));
+    lua_pop(L, 1);
+    if(engine!=nullptr)
+      engine->storageTracked.insert(key);
+    return 0;
+    }
+
+  // storageTouch(key): the tracked table in opengothic.storage[key] was changed in place
+  int ScriptEngine::luaStorageTouch(lua_State* L) {
+    const char* key = luaL_checkstring(L, 1);
+    lua_getfield(L, LUA_REGISTRYINDEX, "ScriptEngine");
+    auto* engine = static_cast<ScriptEngine*>(lua_touserdata(L, -1));
+    lua_pop(L, 1);
+    if(engine==nullptr)
+      return 0;
+    auto it = engine->storageCache.find(key);
+    if(it!=engine->storageCache.end())
+      it->second.dirty = true;
+    return 0;
+    }
+
+  // memoryStats() -> { total, reserved, engine, modules = { [path] = { bytes, disabled } } }
+  int ScriptEngine::luaMemoryStats(lua_State* L) {
+    lua_getfield(L, LUA_REGISTRYINDEX, "ScriptEngine");
+    auto* engine = static_cast<ScriptEngine*>(lua_touserdata(L, -1));
+    lua_pop(L, 1);
+
+    lua_newtable(L);
+    if(!engine)
+      return 1;
+
+    auto& st = engine->allocator.stats();
+    lua_pushnumber(L, double(st.liveBytes));
+    lua_setfield(L, -2, "total");
+    lua_pushnumber(L, double(st.reservedBytes));
+    lua_setfield(L, -2, "reserved");
+
+    lua_newtable(L);
+    for(auto& m : engine->memoryStats()) {
+      if(m.module.empty()) {
+        lua_pushnumber(L, double(m.bytes));
+        lua_setfield(L, -3, "engine");
+        continue;
+        }
+      lua_createtable(L, 0, 2);
+      lua_pushnumber(L, double(m.bytes));
+      lua_setfield(L, -2, "bytes");
+      lua_pushboolean(L, m.disabled);
+      lua_setfield(L, -2, "disabled");
+      lua_setfield(L, -2, m.module.c_str());
+      }
+    lua_setfield(L, -2, "modules");
+    return 1;
+    }
+
+  int ScriptEngine::luaSetEventHandlers(lua_State* L) {
+    const char* eventName = luaL_checkstring(L, 1);
+    luaL_checktype(L, 2, LUA_TTABLE);
+    int live = luaL_checkinteger(L, 3);
+
+    lua_getfield(L, LUA_REGISTRYINDEX, "ScriptEngine");
+    auto* engine = static_cast<ScriptEngine*>(lua_touserdata(L, -1));
+    lua_pop(L, 1);
+    if(!engine)
+      return 0;
+
+    auto& ev = engine->events[size_t(engine->internEvent(eventName))];
+    if(ev.handlersRef != LUA_NOREF)
+      lua_unref(L, ev.handlersRef);
+    ev.handlersRef  = lua_ref(L, 2);
+    ev.liveHandlers = std::max(live, 0);
+
+    // compile the filters of live handlers, so that hooks can test them without Lua
+    ev.filters.clear();
+    ev.unfiltered = 0;
+    const int count = lua_objlen(L, 2);
+    for(int i=1; i<=count; ++i) {
+      lua_rawgeti(L, 2, i);
+      lua_getfield(L, -1, "callback");
+      const bool isLive = !lua_isnil(L, -1);
+      lua_pop(L, 1);
+      if(isLive) {
+        lua_getfield(L, -1, "filter");
+        if(lua_istable(L, -1)) {
+          HandlerFilter hf;
+          hf.index = i;
+          lua_getfield(L, -1, "npcInstance");
+          if(lua_isnumber(L, -1))
+            hf.filter.npcInstance = int32_t(lua_tointeger(L, -1));
+          lua_getfield(L, -2, "itemInstance");
+          if(lua_isnumber(L, -1))
+            hf.filter.itemInstance = int32_t(lua_tointeger(L, -1));
+          lua_getfield(L, -3, "percType");
+          if(lua_isnumber(L, -1))
+            hf.filter.percType = int32_t(lua_tointeger(L, -1));
+          lua_getfield(L, -4, "isPlayer");
+          if(lua_isboolean(L, -1))
+            hf.filter.isPlayer = lua_toboolean(L, -1) ? 1 : 0;
+          lua_pop(L, 4);
+          ev.filters.push_back(hf);
+          } else {
+          ++ev.unfiltered;
+          }
+        lua_pop(L, 1);
+        }
+      lua_pop(L, 1);
+      }
+    return 0;
+    }
+
+  // _profileCall(kind, id, label, fn, ...) -> first result of fn
+  int ScriptEngine::luaProfileCall(lua_State* L) {
+    const char*   kind  = luaL_checkstring(L, 1);
+    const int64_t id    = int64_t(luaL_checknumber(L, 2));
+    const char*   label = luaL_optstring(L, 3, "");
+    luaL_checktype(L, 4, LUA_TFUNCTION);
+
+    lua_getfield(L, LUA_REGISTRYINDEX, "ScriptEngine");
+    auto* engine = static_cast<ScriptEngine*>(lua_touserdata(L, -1));
+    lua_pop(L, 1);
+
+    const int nargs = lua_gettop(L) - 4;
+    if(engine==nullptr || !engine->profiler.isEnabled()) {
+      lua_call(L, nargs, 1);
+      return 1;
+      }
+
+    // label may be collected by the call, copy it upfront
+    const std::string name  = label;
+    const int64_t     heap0 = luaHeapBytes(L);
+    const auto        t0    = std::chrono::steady_clock::now();
+    lua_call(L, nargs, 1);
+    const double      ms    = elapsedMs(t0);
+
+    auto k = (std::strcmp(kind, "timer")==0) ? ScriptProfiler::K_Timer : ScriptProfiler::K_Handler;
+    engine->profiler.record(k, id, name, ms, luaHeapBytes(L)-heap0);
+    return 1;
+    }
+
+  // _runHandlerThread(id, eventName, fn, ...) -> handled
+  // Runs a handler as an async task; if it yields (explicitly or when preempted by the
+  // execution budget) it is resumed later and the dispatch counts as not handled
+  int ScriptEngine::luaRunHandlerThread(lua_State* L) {
+    const int   id    = luaL_checkinteger(L, 1);
+    const char* event = luaL_checkstring(L, 2);
+    luaL_checktype(L, 3, LUA_TFUNCTION);
+
+    lua_getfield(L, LUA_REGISTRYINDEX, "ScriptEngine");
+    auto* engine = static_cast<ScriptEngine*>(lua_touserdata(L, -1));
+    lua_pop(L, 1);
+    if(engine==nullptr)
+      return 0;
+
+    const uint32_t task = engine->createTask(L, lua_gettop(L) - 3);
+    auto&          t    = engine->asyncTasks[task];
+    lua_State*     co   = t.thread;
+    t.handlerId = id;
+    t.label     = event;
+
+    const bool done = engine->resumeTask(task, 0, L);
+    lua_pushboolean(L, done && lua_gettop(co)>0 && lua_toboolean(co, 1));
+    return 1;
+    }
+
+  // --- opengothic.async ---
+
+  static ScriptEngine* asyncEngine(lua_State* L) {
+    lua_getfield(L, LUA_REGISTRYINDEX, "ScriptEngine");
+    auto* engine = static_cast<ScriptEngine*>(lua_touserdata(L, -1));
+    lua_pop(L, 1);
+    if(engine==nullptr)
+      luaL_error(L, "opengothic.async: script engine is not available");
+    return engine;
+    }
+
+  // run(fn, ...) -> taskId; runs fn up to its first wait right away
+  int ScriptEngine::luaAsyncRun(lua_State* L) {
+    luaL_checktype(L, 1, LUA_TFUNCTION);
+    auto*          engine = asyncEngine(L);
+    const uint32_t id     = engine->createTask(L, lua_gettop(L) - 1);
+    engine->resumeTask(id, 0, L);
+    lua_pushinteger(L, int(id));
+    return 1;
+    }
+
+  // _start(name, fn, state) -> taskId; persistent task, see saveTasks
+  int ScriptEngine::luaAsyncStart(lua_State* L) {
+    const char* name = luaL_checkstring(L, 1);
+    luaL_checktype(L, 2, LUA_TFUNCTION);
+    luaL_checktype(L, 3, LUA_TTABLE);
+    auto* engine = asyncEngine(L);
+
+    const std::string label    = name;
+    const int         stateRef = lua_ref(L, 3);
+    lua_settop(L, 3);
+    lua_remove(L, 1);
+
+    const uint32_t id = engine->createTask(L, 1);
+    auto&          t  = engine->asyncTasks[id];
+    t.label    = label;
+    t.stateRef = stateRef;
+    engine->resumeTask(id, 0, L);
+    lua_pushinteger(L, int(id));
+    return 1;
+    }
+
+  int ScriptEngine::luaAsyncWait(lua_State* L) {
+    const double seconds = luaL_checknumber(L, 1);
+    return yieldTask(L, W_Seconds, std::max(seconds, 0.0));
+    }
+
+  int ScriptEngine::luaAsyncWaitGameMinutes(lua_State* L) {
+    const int minutes = luaL_checkinteger(L, 1);
+    return yieldTask(L, W_GameMinutes, double(std::max(minutes, 0)));
+    }
+
+  // waitEvent(name) -> event arguments
+  int ScriptEngine::luaAsyncWaitEvent(lua_State* L) {
+    const char* name   = luaL_checkstring(L, 1);
+    auto*       engine = asyncEngine(L);
+    return yieldTask(L, W_Event, double(engine->internEvent(name)));
+    }
+
+  int ScriptEngine::luaAsyncCancel(lua_State* L) {
+    const int id     = luaL_checkinteger(L, 1);
+    auto*     engine = asyncEngine(L);
+    lua_pushboolean(L, id>0 && engine->cancelTask(uint32_t(id)));
+    return 1;
+    }
+
+  int ScriptEngine::luaAsyncCount(lua_State* L) {
+    auto* engine = asyncEngine(L);
+    lua_pushinteger(L, int(engine->asyncTasks.size()));
+    return 1;
+    }
+
+  // _signal(name, ...): wakes waitEvent(name) for events dispatched from Lua
+  int ScriptEngine::luaAsyncSignal(lua_State* L) {
+    const char* name   = luaL_checkstring(L, 1);
+    auto*       engine = asyncEngine(L);
+    auto        ev     = engine->eventIds.find(name);
+    if(ev==engine->eventIds.end() || engine->events[size_t(ev->second)].waiters.empty())
+      return 0;
+
+    auto waiters = std::move(engine->events[size_t(ev->second)].waiters);
+    engine->events[size_t(ev->second)].waiters.clear();
+
+    const int nargs = lua_gettop(L) - 1;
+    for(auto [id, gen] : waiters) {
+      auto it = engine->asyncTasks.find(id);
+      if(it==engine->asyncTasks.end() || it->second.gen!=gen)
+        continue;
+      for(int i=2; i<=nargs+1; ++i)
+        lua_pushvalue(L, i);
+      lua_xmove(L, it->second.thread, nargs);
+      engine->resumeTask(id, nargs, L);
+      }
+    return 0;
+    }
+
+  // --- opengothic.parallel ---
+
+  // define(name, source) -> true or nil, err; source is a chunk returning function(input) -> output
+  int ScriptEngine::luaParallelDefine(lua_State* L) {
+    const char* name   = luaL_checkstring(L, 1);
+    const char* source = luaL_checkstring(L, 2);
+    auto*       engine = asyncEngine(L);
+
+    std::string bytecode;
+    if(!engine->compileScript(source, bytecode) || bytecode[0]==0) {
+      lua_pushnil(L);
+      lua_pushstring(L, bytecode.empty() ? "compile_error" : bytecode.c_str()+1);
+      return 2;
+      }
+    engine->workerPool.define(name, std::move(bytecode));
+    lua_pushboolean(L, 1);
+    return 1;
+    }
+
+  // map(name, inputs [, callback]) -> results, err from a task; jobId with a callback(results, err)
+  int ScriptEngine::luaParallelMap(lua_State* L) {
+    const char* name = luaL_checkstring(L, 1);
+    luaL_checktype(L, 2, LUA_TTABLE);
+    const bool  hasCallback = !lua_isnoneornil(L, 3);
+    if(hasCallback)
+      luaL_checktype(L, 3, LUA_TFUNCTION);
+    auto* engine = asyncEngine(L);
+
+    if(!hasCallback && (lua_getthreaddata(L)==nullptr || !lua_isyieldable(L)))
+      luaL_error(L, "opengothic.parallel: map without a callback must be called from an async task");
+    if(!engine->workerPool.isDefined(name)) {
+      lua_pushnil(L);
+      lua_pushstring(L, "unknown_module");
+      return 2;
+      }
+
+    const int n = lua_objlen(L, 2);
+    std::vector<ScriptWorkerPool::Item> items(size_t(std::max(n, 0)));
+    for(int i=0; i<n; ++i) {
+      std::string err;
+      bool        immutable = false;
+      lua_rawgeti(L, 2, i+1);
+      const bool ok = StorageCodec::encode(L, -1, items[size_t(i)].input, immutable, err);
+      lua_pop(L, 1);
+      if(!ok) {
+        lua_pushnil(L);
+        lua_pushfstring(L, "invalid_input %d: %s", i+1, err.c_str());
+        return 2;
+        }
+      items[size_t(i)].module = name;
+      }
+
+    ParallelJob job;
+    job.id    = engine->parallelNextId++;
+    job.first = engine->parallelItems.size();
+    job.count = items.size();
+    for(auto& i : items)
+      engine->parallelItems.push_back(std::move(i));
+
+    if(hasCallback) {
+      lua_pushvalue(L, 3);
+      job.callbackRef = lua_ref(L, -1);
+      lua_pop(L, 1);
+      engine->parallelJobs.push_back(job);
+      lua_pushinteger(L, int(job.id));
+      return 1;
+      }
+    job.taskId = engine->asyncRunning;
+    engine->parallelJobs.push_back(job);
+    return yieldTask(L, W_Parallel, double(job.id));
+    }
+
+  int ScriptEngine::luaParallelStats(lua_State* L) {
+    auto* engine = asyncEngine(L);
+    lua_createtable(L, 0, 5);
+    lua_pushinteger(L, int(engine->workerPool.stateCount()));
+    lua_setfield(L, -2, "workers");
+    lua_pushinteger(L, int(engine->parallelJobs.size()));
+    lua_setfield(L, -2, "pending");
+    lua_pushnumber(L, double(engine->parallelDone));
+    lua_setfield(L, -2, "jobs");
+    lua_pushnumber(L, double(engine->parallelItemsDone));
+    lua_setfield(L, -2, "items");
+    lua_pushnumber(L, engine->parallelMs);
+    lua_setfield(L, -2, "ms");
+    return 1;
+    }
+
+  // --- opengothic.timer ---
+
+  static ScriptEngine* timerEngine(lua_State* L) {
+    lua_getfield(L, LUA_REGISTRYINDEX, "ScriptEngine");
+    auto* engine = static_cast<ScriptEngine*>(lua_touserdata(L, -1));
+    lua_pop(L, 1);
+    if(engine==nullptr)
+      luaL_error(L, "opengothic.timer: script engine is not available");
+    return engine;
+    }
+
+  // _schedule(kind, seconds, fn) -> timerId; kind is "after", "every" or "gameMinute"
+  int ScriptEngine::luaTimerSchedule(lua_State* L) {
+    const char*  kind    = luaL_checkstring(L, 1);
+    const double seconds = luaL_optnumber(L, 2, 0);
+    luaL_checktype(L, 3, LUA_TFUNCTION);
+    auto*        engine  = timerEngine(L);
+
+    TimerKind k = T_After;
+    if(std::strcmp(kind, "every")==0)
+      k = T_Every;
+    else if(std::strcmp(kind, "gameMinute")==0)
+      k = T_GameMinute;
+    else if(std::strcmp(kind, "after")!=0)
+      luaL_error(L, "opengothic.timer: unknown timer kind '%s'", kind);
+
+    lua_settop(L, 3);
+    lua_pushinteger(L, int(engine->addTimer(L, k, std::max(seconds, 0.0))));
+    return 1;
+    }
+
+  int ScriptEngine::luaTimerCancel(lua_State* L) {
+    const int id     = luaL_checkinteger(L, 1);
+    auto*     engine = timerEngine(L);
+    lua_pushboolean(L, id>0 && engine->cancelTimer(uint32_t(id)));
+    return 1;
+    }
+
+  // stats() -> { active, realtime, gameMinute, fired, cancelled, pending }
+  int ScriptEngine::luaTimerStats(lua_State* L) {
+    auto*        engine = timerEngine(L);
+    const size_t minute = size_t(std::count_if(engine->minuteTimers.begin(), engine->minuteTimers.end(),
+                                               [](uint32_t id) { return id!=0; }));
+    lua_newtable(L);
+    lua_pushinteger(L, int(engine->timers.size()));
+    lua_setfield(L, -2, "active");
+    lua_pushinteger(L, int(engine->timers.size()-minute));
+    lua_setfield(L, -2, "realtime");
+    lua_pushinteger(L, int(minute));
+    lua_setfield(L, -2, "gameMinute");
+    lua_pushnumber(L, double(engine->timerFires));
+    lua_setfield(L, -2, "fired");
+    lua_pushnumber(L, double(engine->timerCancels));
+    lua_setfield(L, -2, "cancelled");
+    // includes entries of cancelled timers that haven't come up yet
+    lua_pushinteger(L, int(engine->timerWheel.size()));
+    lua_setfield(L, -2, "pending");
+    return 1;
+    }
+
+  int ScriptEngine::luaEventStats(lua_State* L) {
+    lua_getfield(L, LUA_REGISTRYINDEX, "ScriptEngine");
+    auto* engine = static_cast<ScriptEngine*>(lua_touserdata(L, -1));
+    lua_pop(L, 1);
+
+    lua_newtable(L);
+    if(!engine)
+      return 1;
+
+    for(auto& ev : engine->events) {
+      lua_newtable(L);
+      lua_pushnumber(L, double(ev.dispatched));
+      lua_setfield(L, -2, "dispatched");
+      lua_pushnumber(L, double(ev.skippedEmpty));
+      lua_setfield(L, -2, "skipped");
+      lua_pushnumber(L, double(ev.skippedFiltered));
+      lua_setfield(L, -2, "filtered");
+      lua_pushinteger(L, ev.liveHandlers);
+      lua_setfield(L, -2, "handlers");
+      lua_setfield(L, -2, ev.name.c_str());
+      }
+    return 1;
+    }
+
   // --- Daedalus Bridge (opengothic.daedalus) ---
 
   // Helper: Test if userdata has specific metatable (Luau compatible)
@@ -2015,8 +4249,7 @@ static const luaL_Reg inventory_meta[] = {
           if(world) {
             Npc* npcObj = world->findNpcByInstance(npc->symbol_index());
             if(npcObj) {
-              Lua::push(L, npcObj);
-              Lua::setMetatable(L, "Npc");
+              Lua::pushProxy(L, npcObj);
               }
             else {
               lua_pushnil(L);
@@ -2031,8 +4264,7 @@ static const luaL_Reg inventory_meta[] = {
           if(world) {
             Item* itemObj = world->findItemByInstance(item->symbol_index());
             if(itemObj) {
-              Lua::push(L, itemObj);
-              Lua::setMetatable(L, "Item");
+              Lua::pushProxy(L, itemObj);
               }
             else {
               lua_pushnil(L);
@@ -2072,6 +4304,27 @@ static const luaL_Reg inventory_meta[] = {
     std::shared_ptr<zenkit::DaedalusInstance> instanceValue;
     };
 
+  // Arguments of one bridge call. Daedalus functions take only a few parameters,
+  // so they are kept in place; longer signatures spill to the heap.
+  class BridgeArgs final {
+    public:
+      void             clear()            { count = 0; spill.clear(); }
+      size_t           size() const       { return count; }
+      const BridgeArg& operator[](size_t i) const { return i<Inline ? local[i] : spill[i-Inline]; }
+
+      BridgeArg& add() {
+        BridgeArg& a = count<Inline ? local[count] : spill.emplace_back();
+        ++count;
+        return a;
+        }
+
+    private:
+      static constexpr size_t       Inline = 8;
+      std::array<BridgeArg, Inline> local;
+      std::vector<BridgeArg>        spill;
+      size_t                        count  = 0;
+    };
+
   static std::shared_ptr<zenkit::DaedalusInstance> toDaedalusInstance(lua_State* L, int idx) {
     if(testUserdata(L, idx, "Npc")) {
       auto* npc = Lua::to<Npc>(L, idx);
@@ -2088,8 +4341,29 @@ static const luaL_Reg inventory_meta[] = {
     return nullptr;
     }
 
+  // Npc/Item proxy of a live object, symbol index of any other instance
+  static void pushDaedalusInstance(lua_State* L, const std::shared_ptr<zenkit::DaedalusInstance>& inst) {
+    if(inst==nullptr) {
+      lua_pushnil(L);
+      return;
+      }
+    if(auto* npc = dynamic_cast<zenkit::INpc*>(inst.get())) {
+      if(npc->user_ptr!=nullptr)
+        Lua::pushProxy(L, reinterpret_cast<Npc*>(npc->user_ptr)); else
+        lua_pushnil(L);
+      return;
+      }
+    if(auto* item = dynamic_cast<zenkit::IItem*>(inst.get())) {
+      if(item->user_ptr!=nullptr)
+        Lua::pushProxy(L, reinterpret_cast<Item*>(item->user_ptr)); else
+        lua_pushnil(L);
+      return;
+      }
+    lua_pushinteger(L, static_cast<lua_Integer>(inst->symbol_index()));
+    }
+
   static bool parseBridgeArgs(lua_State* L, int firstArgIdx, int nargs, std::span<zenkit::DaedalusSymbol> params, bool permissive,
-                              std::vector<BridgeArg>& outArgs, std::string& err) {
+                              BridgeArgs& outArgs, std::string& err) {
     if(params.size() < size_t(nargs)) {
       std::ostringstream ss;
       ss << "too many arguments provided: given " << nargs << " expected " << params.size();
@@ -2105,7 +4379,6 @@ static const luaL_Reg inventory_meta[] = {
       }
 
     outArgs.clear();
-    outArgs.reserve(size_t(nargs));
 
     for(int i = 0; i < nargs; ++i) {
       const int luaIdx = firstArgIdx + i;
@@ -2182,16 +4455,58 @@ static const luaL_Reg inventory_meta[] = {
             return false;
             }
           break;
-
-        default:
-          unsupportedArg("unsupported Daedalus parameter type");
-          return false;
+
+        default:
+          unsupportedArg("unsupported Daedalus parameter type");
+          return false;
+        }
+
+      outArgs.add() = std::move(arg);
+      }
+
+    return true;
+    }
+
+  static void pushBridgeArgs(zenkit::DaedalusVm& vm, const BridgeArgs& args) {
+    for(size_t i = 0; i < args.size(); ++i) {
+      const auto& arg = args[i];
+      switch(arg.type) {
+        case BridgeArgType::Int:
+          vm.push_int(arg.intValue);
+          break;
+        case BridgeArgType::Float:
+          vm.push_float(arg.floatValue);
+          break;
+        case BridgeArgType::String:
+          vm.push_string(arg.stringValue);
+          break;
+        case BridgeArgType::Instance:
+          vm.push_instance(arg.instanceValue);
+          break;
         }
+      }
+    }
 
-      outArgs.emplace_back(std::move(arg));
+  // Pops the return value of a finished call onto the Lua stack; returns the number of results
+  static int pushBridgeResult(lua_State* L, zenkit::DaedalusVm& vm, const zenkit::DaedalusSymbol& sym) {
+    if(sym.rtype() == zenkit::DaedalusDataType::INT || sym.rtype() == zenkit::DaedalusDataType::FUNCTION) {
+      lua_pushinteger(L, static_cast<lua_Integer>(vm.pop_int()));
+      return 1;
+      }
+    if(sym.rtype() == zenkit::DaedalusDataType::FLOAT) {
+      lua_pushnumber(L, static_cast<double>(vm.pop_float()));
+      return 1;
+      }
+    if(sym.rtype() == zenkit::DaedalusDataType::STRING) {
+      auto& result = vm.pop_string();
+      lua_pushstring(L, result.c_str());
+      return 1;
       }
+    return 0;
+    }
 
-    return true;
+  static bool isBridgeExternal(zenkit::DaedalusVm& vm, const zenkit::DaedalusSymbol& sym) {
+    return sym.is_external() || sym.address() >= vm.size();
     }
 
   // opengothic.daedalus.call(funcName, ...) - Call a Daedalus function
@@ -2218,7 +4533,7 @@ static const luaL_Reg inventory_meta[] = {
 
     const int nargs = lua_gettop(L) - 1;
     auto params = vm.find_parameters_for_function(sym);
-    std::vector<BridgeArg> args;
+    BridgeArgs args;
     std::string parseErr;
     if(!parseBridgeArgs(L, 2, nargs, params, false, args, parseErr)) {
       luaL_error(L, "daedalus.call: error calling '%s': %s", funcName, parseErr.c_str());
@@ -2227,50 +4542,126 @@ static const luaL_Reg inventory_meta[] = {
 
     // Call the function
     try {
-      const bool useExternalCall = sym->is_external() || sym->address() >= vm.size();
-      if(useExternalCall) {
+      if(isBridgeExternal(vm, *sym)) {
         throw std::runtime_error("external function is not supported by the current bridge (requires external-call bridge extension)");
         }
 
-      for(const auto& arg : args) {
-        switch(arg.type) {
-          case BridgeArgType::Int:
-            vm.push_int(arg.intValue);
-            break;
-          case BridgeArgType::Float:
-            vm.push_float(arg.floatValue);
-            break;
-          case BridgeArgType::String:
-            vm.push_string(arg.stringValue);
-            break;
-          case BridgeArgType::Instance:
-            vm.push_instance(arg.instanceValue);
-            break;
-          }
-        }
-
+      pushBridgeArgs(vm, args);
       vm.unsafe_call(sym);
-      if(sym->rtype() == zenkit::DaedalusDataType::INT || sym->rtype() == zenkit::DaedalusDataType::FUNCTION) {
-        lua_pushinteger(L, static_cast<lua_Integer>(vm.pop_int()));
-        return 1;
-        }
-      if(sym->rtype() == zenkit::DaedalusDataType::FLOAT) {
-        lua_pushnumber(L, static_cast<double>(vm.pop_float()));
-        return 1;
-        }
-      if(sym->rtype() == zenkit::DaedalusDataType::STRING) {
-        auto& result = vm.pop_string();
-        lua_pushstring(L, result.c_str());
-        return 1;
+      return pushBridgeResult(L, vm, *sym);
+      }
+    catch(const std::exception& e) {
+      luaL_error(L, "daedalus.call: error calling '%s': %s", funcName, e.what());
+      return 0;
+      }
+    }
+
+  // --- opengothic.daedalus.bind ---
+
+  // Function resolved by opengothic.daedalus.bind(). Symbol and parameter list point into the
+  // VM and are resolved again by name when the world (and with it the VM) was replaced.
+  struct DaedalusBinding final {
+    std::string                       name;
+    const zenkit::DaedalusVm*         vm         = nullptr;
+    uint64_t                          generation = 0;
+    zenkit::DaedalusSymbol*           sym        = nullptr;
+    std::span<zenkit::DaedalusSymbol> params;
+    };
+
+  // bumped whenever the world is replaced or dropped, see ScriptEngine::invalidateDaedalusBindings
+  static uint64_t daedalusGeneration = 1;
+
+  static bool resolveDaedalusBinding(zenkit::DaedalusVm& vm, DaedalusBinding& b, std::string& err) {
+    b.vm  = nullptr;
+    b.sym = nullptr;
+    auto* sym = vm.find_symbol_by_name(b.name);
+    if(sym == nullptr) {
+      err = "function '" + b.name + "' not found";
+      return false;
+      }
+    if(!sym->is_const() && sym->type() != zenkit::DaedalusDataType::FUNCTION) {
+      err = "'" + b.name + "' is not a function";
+      return false;
+      }
+    if(isBridgeExternal(vm, *sym)) {
+      err = "'" + b.name + "' is an external function, which is not supported by the current bridge";
+      return false;
+      }
+    b.vm         = &vm;
+    b.generation = daedalusGeneration;
+    b.sym        = sym;
+    b.params     = vm.find_parameters_for_function(sym);
+    return true;
+    }
+
+  // opengothic.daedalus.bind(funcName) -> callable
+  // Resolved right away when a world is loaded (unknown names raise an error), otherwise on first call
+  int ScriptEngine::luaDaedalusBind(lua_State* L) {
+    const char* funcName = luaL_checkstring(L, 1);
+
+    void* mem = lua_newuserdatadtor(L, sizeof(DaedalusBinding), [](void* ptr) {
+      static_cast<DaedalusBinding*>(ptr)->~DaedalusBinding();
+      });
+    auto* b = new(mem) DaedalusBinding();
+    b->name = funcName;
+    luaL_getmetatable(L, DaedalusFunctionMeta);
+    lua_setmetatable(L, -2);
+
+    if(World* world = Gothic::inst().world()) {
+      std::string err;
+      if(!resolveDaedalusBinding(world->script().getVm(), *b, err))
+        luaL_error(L, "daedalus.bind: %s", err.c_str());
+      }
+    return 1;
+    }
+
+  // __call(binding, ...): same argument rules as daedalus.call, without the name lookup
+  int ScriptEngine::luaDaedalusBoundCall(lua_State* L) {
+    auto* b = static_cast<DaedalusBinding*>(luaL_checkudata(L, 1, DaedalusFunctionMeta));
+
+    World* world = Gothic::inst().world();
+    if(!world) {
+      luaL_error(L, "daedalus.bind: no world loaded");
+      return 0;
+      }
+
+    auto& vm = world->script().getVm();
+    if(b->vm != &vm || b->generation != daedalusGeneration) {
+      std::string err;
+      if(!resolveDaedalusBinding(vm, *b, err)) {
+        luaL_error(L, "daedalus.bind: %s", err.c_str());
+        return 0;
         }
+      }
+
+    BridgeArgs  args;
+    std::string parseErr;
+    if(!parseBridgeArgs(L, 2, lua_gettop(L) - 1, b->params, false, args, parseErr)) {
+      luaL_error(L, "daedalus.bind: error calling '%s': %s", b->name.c_str(), parseErr.c_str());
       return 0;
       }
+
+    try {
+      pushBridgeArgs(vm, args);
+      vm.unsafe_call(b->sym);
+      return pushBridgeResult(L, vm, *b->sym);
+      }
     catch(const std::exception& e) {
-      luaL_error(L, "daedalus.call: error calling '%s': %s", funcName, e.what());
+      luaL_error(L, "daedalus.bind: error calling '%s': %s", b->name.c_str(), e.what());
       return 0;
       }
     }
 
+  int ScriptEngine::luaDaedalusBoundToString(lua_State* L) {
+    auto* b = static_cast<DaedalusBinding*>(luaL_checkudata(L, 1, DaedalusFunctionMeta));
+    lua_pushfstring(L, "DaedalusFunction(%s)", b->name.c_str());
+    return 1;
+    }
+
+  void ScriptEngine::invalidateDaedalusBindings() {
+    ++daedalusGeneration;
+    }
+
   // opengothic.daedalus.get(varName, [index]) - Get a Daedalus global variable
   int ScriptEngine::luaDaedalusGet(lua_State* L) {
     const char* varName = luaL_checkstring(L, 1);
@@ -2434,7 +4825,7 @@ static const luaL_Reg inventory_meta[] = {
 
     const int nargs = lua_gettop(L) - 2;
     auto params = vm.find_parameters_for_function(sym);
-    std::vector<BridgeArg> args;
+    BridgeArgs args;
     std::string parseErr;
     if(!parseBridgeArgs(L, 3, nargs, params, true, args, parseErr)) {
       luaL_error(L, "vm.callWithContext: error calling '%s': %s", funcName, parseErr.c_str());
@@ -2451,45 +4842,13 @@ static const luaL_Reg inventory_meta[] = {
 
     int result = 0;
     try {
-      const bool useExternalCall = sym->is_external() || sym->address() >= vm.size();
-      if(useExternalCall) {
+      if(isBridgeExternal(vm, *sym)) {
         throw std::runtime_error("external function is not supported by the current bridge (requires external-call bridge extension)");
         }
       else {
-        for(const auto& arg : args) {
-          switch(arg.type) {
-            case BridgeArgType::Int:
-              vm.push_int(arg.intValue);
-              break;
-            case BridgeArgType::Float:
-              vm.push_float(arg.floatValue);
-              break;
-            case BridgeArgType::String:
-              vm.push_string(arg.stringValue);
-              break;
-            case BridgeArgType::Instance:
-              vm.push_instance(arg.instanceValue);
-              break;
-            }
-          }
-
+        pushBridgeArgs(vm, args);
         vm.unsafe_call(sym);
-        if(sym->rtype() == zenkit::DaedalusDataType::INT || sym->rtype() == zenkit::DaedalusDataType::FUNCTION) {
-          lua_pushinteger(L, static_cast<lua_Integer>(vm.pop_int()));
-          result = 1;
-          }
-        else if(sym->rtype() == zenkit::DaedalusDataType::FLOAT) {
-          lua_pushnumber(L, static_cast<double>(vm.pop_float()));
-          result = 1;
-          }
-        else if(sym->rtype() == zenkit::DaedalusDataType::STRING) {
-          auto& ret = vm.pop_string();
-          lua_pushstring(L, ret.c_str());
-          result = 1;
-          }
-        else {
-          result = 0;
-          }
+        result = pushBridgeResult(L, vm, *sym);
         }
       }
     catch(const std::exception& e) {
@@ -2511,12 +4870,180 @@ static const luaL_Reg inventory_meta[] = {
     return result;
     }
 
-  // opengothic.vm.registerExternal(name, luaFunc) - Register Lua function as Daedalus external
+  static const char* externalTypeName(uint8_t t) {
+    static const char* names[] = {"void", "int", "float", "string", "instance"};
+    return t<5 ? names[t] : "?";
+    }
+
+  static bool externalType(zenkit::DaedalusDataType t, uint8_t& out) {
+    switch(t) {
+      case zenkit::DaedalusDataType::VOID:     out = 0; return true;
+      case zenkit::DaedalusDataType::INT:
+      case zenkit::DaedalusDataType::FUNCTION: out = 1; return true;
+      case zenkit::DaedalusDataType::FLOAT:    out = 2; return true;
+      case zenkit::DaedalusDataType::STRING:   out = 3; return true;
+      case zenkit::DaedalusDataType::INSTANCE: out = 4; return true;
+      default:                                 return false;
+      }
+    }
+
+  template<class T>
+  static std::string externalSignature(uint8_t ret, const std::vector<T>& params) {
+    std::string s = externalTypeName(ret);
+    s += "(";
+    for(size_t i=0; i<params.size(); ++i) {
+      if(i>0)
+        s += ", ";
+      s += externalTypeName(uint8_t(params[i]));
+      }
+    s += ")";
+    return s;
+    }
+
+  // Checks the signature against the current VM and installs the callback. The callback
+  // moves the VM arguments straight onto the Lua stack and pushes back a value of the
+  // declared return type, also when the Lua function fails, so the VM stack stays balanced
+  bool ScriptEngine::bindLuaExternal(LuaExternal& ext, std::string& err) {
+    World* world = Gothic::inst().world();
+    if(!world) {
+      err = "no world loaded";
+      return false;
+      }
+
+    auto& vm  = world->script().getVm();
+    auto* sym = vm.find_symbol_by_name(ext.name);
+    if(sym==nullptr || sym->type()!=zenkit::DaedalusDataType::FUNCTION) {
+      err = "'" + ext.name + "' is not a Daedalus function";
+      return false;
+      }
+
+    uint8_t              ret = 0;
+    std::vector<uint8_t> params;
+    bool                 supported = externalType(sym->rtype(), ret);
+    for(auto& p : vm.find_parameters_for_function(sym)) {
+      uint8_t t = 0;
+      supported &= externalType(p.type(), t) && t!=X_Void;
+      params.push_back(t);
+      }
+    if(!supported) {
+      err = "'" + ext.name + "' has a parameter or return type that Lua can't implement";
+      return false;
+      }
+
+    if(ext.explicitSignature) {
+      bool same = ext.ret==ret && ext.params.size()==params.size();
+      for(size_t i=0; same && i<params.size(); ++i)
+        same = ext.params[i]==params[i];
+      if(!same) {
+        err = "signature " + externalSignature(ext.ret, ext.params) + " doesn't match Daedalus " +
+              externalSignature(ret, params) + " of '" + ext.name + "'";
+        return false;
+        }
+      } else {
+      ext.ret = ExternalType(ret);
+      ext.params.clear();
+      for(auto t : params)
+        ext.params.push_back(ExternalType(t));
+      }
+
+    LuaExternal* e  = &ext;
+    auto         fn = [this, e](zenkit::DaedalusVm& vm) {
+      const int nargs = int(e->params.size());
+      const bool live = L!=nullptr && e->fnRef!=LUA_NOREF && lua_checkstack(L, nargs+2);
+      if(live) {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, e->fnRef);
+        for(int i=0; i<nargs; ++i)
+          lua_pushnil(L);
+        }
+
+      // last parameter is on top of the VM stack
+      const int base = live ? lua_gettop(L)-nargs : 0;
+      for(int i=nargs-1; i>=0; --i) {
+        switch(e->params[size_t(i)]) {
+          case X_Int: {
+            const int32_t v = vm.pop_int();
+            if(live)
+              lua_pushinteger(L, v);
+            break;
+            }
+          case X_Float: {
+            const float v = vm.pop_float();
+            if(live)
+              lua_pushnumber(L, double(v));
+            break;
+            }
+          case X_String: {
+            const auto& v = vm.pop_string();
+            if(live)
+              lua_pushlstring(L, v.data(), v.size());
+            break;
+            }
+          case X_Instance: {
+            auto v = vm.pop_instance();
+            if(live)
+              pushDaedalusInstance(L, v);
+            break;
+            }
+          case X_Void:
+            break;
+          }
+        if(live)
+          lua_replace(L, base+1+i);
+        }
+
+      bool ok = false;
+      if(live) {
+        beginExec();
+        const int32_t outer = enterModule(L, e->module);
+        ok = lua_pcall(L, nargs, 1, 0)==0;
+        enterModule(L, outer);
+        endExec();
+        if(!ok) {
+          Log::e("[ScriptEngine] Lua external '", e->name, "' error: ", lua_tostring(L, -1));
+          lua_pop(L, 1);
+          }
+        } else {
+        Log::e("[ScriptEngine] Lua external '", e->name, "' has no Lua function");
+        }
+
+      switch(e->ret) {
+        case X_Void:
+          break;
+        case X_Int:
+          vm.push_int(ok ? int32_t(lua_isboolean(L, -1) ? lua_toboolean(L, -1) : lua_tointeger(L, -1)) : 0);
+          break;
+        case X_Float:
+          vm.push_float(ok ? float(lua_tonumber(L, -1)) : 0.f);
+          break;
+        case X_String: {
+          const char* str = ok ? lua_tostring(L, -1) : nullptr;
+          vm.push_string(str!=nullptr ? str : "");
+          break;
+          }
+        case X_Instance:
+          vm.push_instance(ok ? toDaedalusInstance(L, -1) : nullptr);
+          break;
+        }
+      if(ok)
+        lua_pop(L, 1);
+      return zenkit::DaedalusNakedCall();
+      };
+
+    if(isBridgeExternal(vm, *sym))
+      vm.register_external(ext.name, std::function<zenkit::DaedalusNakedCall(zenkit::DaedalusVm&)>(fn)); else
+      vm.override_function(ext.name, fn);
+    return true;
+    }
+
+  // opengothic.vm.registerExternal(name, fn, [signature]) - implement a Daedalus function in Lua
+  // signature: { params = { "int", "float", "string", "instance", ... }, returns = "int" }
   int ScriptEngine::luaVmRegisterExternal(lua_State* L) {
     const char* name = luaL_checkstring(L, 1);
     luaL_checktype(L, 2, LUA_TFUNCTION);
+    const bool explicitSignature = !lua_isnoneornil(L, 3);
+    if(explicitSignature)
+      luaL_checktype(L, 3, LUA_TTABLE);
 
-    // Get ScriptEngine pointer from registry
     lua_getfield(L, LUA_REGISTRYINDEX, "ScriptEngine");
     auto* engine = static_cast<ScriptEngine*>(lua_touserdata(L, -1));
     lua_pop(L, 1);
@@ -2525,55 +5052,70 @@ static const luaL_Reg inventory_meta[] = {
       luaL_error(L, "vm.registerExternal: engine not available");
       return 0;
       }
-
-    World* world = Gothic::inst().world();
-    if(!world) {
+    if(!Gothic::inst().world()) {
       luaL_error(L, "vm.registerExternal: no world loaded");
       return 0;
       }
 
-    // Store Lua function reference
-    lua_pushvalue(L, 2);
-    int ref = lua_ref(L, LUA_REGISTRYINDEX);
-    std::string nameStr = name;
-    engine->luaExternals[nameStr] = ref;
-
-    // Register external with VM
-    auto& vm = world->script().getVm();
-
-    vm.register_external(nameStr, [engine, nameStr](/* variadic args handled via VM stack */) -> int {
-      // Get the Lua function
-      auto it = engine->luaExternals.find(nameStr);
-      if(it == engine->luaExternals.end()) {
-        Log::e("[ScriptEngine] Lua external '", nameStr, "' not found");
-        return 0;
-        }
-
-      lua_rawgeti(engine->L, LUA_REGISTRYINDEX, it->second);
-      if(!lua_isfunction(engine->L, -1)) {
-        lua_pop(engine->L, 1);
-        Log::e("[ScriptEngine] Lua external '", nameStr, "' is not a function");
-        return 0;
-        }
-
-      // Call the Lua function (no args for now - complex arg passing would need VM stack inspection)
-      if(lua_pcall(engine->L, 0, 1, 0) != 0) {
-        Log::e("[ScriptEngine] Lua external '", nameStr, "' error: ", lua_tostring(engine->L, -1));
-        lua_pop(engine->L, 1);
-        return 0;
+    LuaExternal sig;
+    sig.name              = name;
+    sig.explicitSignature = explicitSignature;
+    if(explicitSignature) {
+      auto parseType = [L](bool isReturn) -> ExternalType {
+        const char* t = lua_tostring(L, -1);
+        for(uint8_t i=isReturn ? 0 : 1; t!=nullptr && i<5; ++i)
+          if(std::strcmp(t, externalTypeName(i))==0)
+            return ExternalType(i);
+        luaL_error(L, "vm.registerExternal: unknown %s type '%s'", isReturn ? "return" : "parameter", t ? t : "?");
+        return X_Void;
+        };
+      lua_getfield(L, 3, "returns");
+      sig.ret = lua_isnil(L, -1) ? X_Void : parseType(true);
+      lua_pop(L, 1);
+      lua_getfield(L, 3, "params");
+      if(!lua_isnil(L, -1)) {
+        luaL_checktype(L, -1, LUA_TTABLE);
+        const int n = lua_objlen(L, -1);
+        for(int i=1; i<=n; ++i) {
+          lua_rawgeti(L, -1, i);
+          sig.params.push_back(parseType(false));
+          lua_pop(L, 1);
+          }
         }
+      lua_pop(L, 1);
+      }
 
-      // Get return value
-      int result = 0;
-      if(lua_isnumber(engine->L, -1)) {
-        result = static_cast<int>(lua_tonumber(engine->L, -1));
-        }
-      lua_pop(engine->L, 1);
+    LuaExternal* ext = nullptr;
+    for(auto& e : engine->luaExternals)
+      if(e->name==sig.name)
+        ext = e.get();
+    const bool added = (ext==nullptr);
+    if(added) {
+      engine->luaExternals.emplace_back(new LuaExternal());
+      ext = engine->luaExternals.back().get();
+      }
 
-      return result;
-      });
+    // the VM may already call into this entry: keep it intact until the new one is checked
+    const LuaExternal prev = *ext;
+    lua_pushvalue(L, 2);
+    sig.fnRef  = lua_ref(L, -1);
+    sig.module = engine->callerModule(L);
+    lua_pop(L, 1);
+    *ext = std::move(sig);
+
+    std::string err;
+    if(!engine->bindLuaExternal(*ext, err)) {
+      lua_unref(L, ext->fnRef);
+      if(added)
+        engine->luaExternals.pop_back(); else
+        *ext = prev;
+      luaL_error(L, "vm.registerExternal: %s", err.c_str());
+      return 0;
+      }
+    if(prev.fnRef!=LUA_NOREF)
+      lua_unref(L, prev.fnRef);
 
-    Log::i("[ScriptEngine] Registered Lua external: ", name);
+    Log::i("[ScriptEngine] Registered Lua external: ", ext->name, " ", externalSignature(ext->ret, ext->params));
     return 0;
     }
 
@@ -2639,6 +5181,18 @@ static const luaL_Reg inventory_meta[] = {
     return 1;
     }
 
+  // Symbols to visit for a vm.enumerate class filter: all symbols for "", otherwise the cached
+  // per-parent index. False for an unknown class name
+  static bool enumerateRange(GameScript& script, const char* className, std::span<const uint32_t>& out) {
+    if(className[0]=='\0')
+      return true;
+    auto* cls = script.findSymbol(std::string_view(className));
+    if(cls==nullptr || cls->name()!=className)
+      return false;
+    out = script.symbolsWithParent(cls->index());
+    return true;
+    }
+
   // opengothic.vm.enumerate(className, callback) - Enumerate symbols of a class
   int ScriptEngine::luaVmEnumerate(lua_State* L) {
     const char* className = luaL_checkstring(L, 1);
@@ -2651,29 +5205,22 @@ static const luaL_Reg inventory_meta[] = {
 
     auto& script = world->script();
     auto& vm = script.getVm();
-    size_t count = script.symbolsCount();
+    std::span<const uint32_t> matches;
+    if(!enumerateRange(script, className, matches))
+      return 0;
 
+    const bool   all   = className[0]=='\0';
+    const size_t count = all ? script.symbolsCount() : matches.size();
     for(size_t i = 0; i < count; ++i) {
-      auto* sym = vm.find_symbol_by_index(static_cast<uint32_t>(i));
+      auto* sym = vm.find_symbol_by_index(all ? uint32_t(i) : matches[i]);
       if(!sym)
         continue;
 
-      // Filter by class if specified
-      if(className[0] != '\0') {
-        // Check if symbol's parent class matches
-        uint32_t parentIdx = sym->parent();
-        if(parentIdx == uint32_t(-1))
-          continue;
-        auto* parentSym = vm.find_symbol_by_index(parentIdx);
-        if(!parentSym || parentSym->name() != className)
-          continue;
-        }
-
       // Call callback with symbol info table
       lua_pushvalue(L, 2); // callback
 
-      lua_newtable(L);
-      lua_pushstring(L, sym->name().c_str());
+      lua_createtable(L, 0, 2);
+      lua_pushlstring(L, sym->name().data(), sym->name().size());
       lua_setfield(L, -2, "name");
       lua_pushinteger(L, static_cast<lua_Integer>(sym->index()));
       lua_setfield(L, -2, "index");
@@ -2695,6 +5242,27 @@ static const luaL_Reg inventory_meta[] = {
     return 0;
     }
 
+  // opengothic.vm.enumerateIndices(className) - Array of symbol indices of a class
+  int ScriptEngine::luaVmEnumerateIndices(lua_State* L) {
+    const char* className = luaL_checkstring(L, 1);
+
+    World* world = Gothic::inst().world();
+    std::span<const uint32_t> matches;
+    if(!world || !enumerateRange(world->script(), className, matches)) {
+      lua_newtable(L);
+      return 1;
+      }
+
+    const bool all   = className[0]=='\0';
+    const int  count = int(all ? world->script().symbolsCount() : matches.size());
+    lua_createtable(L, count, 0);
+    for(int i = 0; i < count; ++i) {
+      lua_pushinteger(L, all ? i : static_cast<lua_Integer>(matches[size_t(i)]));
+      lua_rawseti(L, -2, i+1);
+      }
+    return 1;
+    }
+
   // Tempest::Signal Handlers implementations
   void ScriptEngine::onStartGameHandler(std::string_view worldName) {
     (void)dispatchEvent("onStartGame", std::string(worldName).c_str());
@@ -2709,59 +5277,41 @@ static const luaL_Reg inventory_meta[] = {
     }
 
   void ScriptEngine::onWorldLoadedHandler() {
+    invalidateDaedalusBindings();
     reregisterLuaExternals();
     (void)dispatchEvent("onWorldLoaded");
     }
 
   void ScriptEngine::reregisterLuaExternals() {
-    if(luaExternals.empty())
-      return;
-
-    World* world = Gothic::inst().world();
-    if(!world)
+    if(luaExternals.empty() || !Gothic::inst().world())
       return;
 
-    auto& vm = world->script().getVm();
-
-    for(const auto& [nameStr, ref] : luaExternals) {
-      vm.register_external(nameStr, [this, nameStr](/* variadic args handled via VM stack */) -> int {
-        auto it = luaExternals.find(nameStr);
-        if(it == luaExternals.end()) {
-          Log::e("[ScriptEngine] Lua external '", nameStr, "' not found");
-          return 0;
-          }
-
-        lua_rawgeti(L, LUA_REGISTRYINDEX, it->second);
-        if(!lua_isfunction(L, -1)) {
-          lua_pop(L, 1);
-          Log::e("[ScriptEngine] Lua external '", nameStr, "' is not a function");
-          return 0;
-          }
-
-        if(lua_pcall(L, 0, 1, 0) != 0) {
-          Log::e("[ScriptEngine] Lua external '", nameStr, "' error: ", lua_tostring(L, -1));
-          lua_pop(L, 1);
-          return 0;
-          }
-
-        int result = 0;
-        if(lua_isnumber(L, -1)) {
-          result = static_cast<int>(lua_tonumber(L, -1));
-          }
-        lua_pop(L, 1);
-
-        return result;
-        });
-      Log::i("[ScriptEngine] Re-registered Lua external: ", nameStr);
+    for(auto& ext : luaExternals) {
+      if(ext->fnRef==LUA_NOREF)
+        continue;
+      std::string err;
+      if(bindLuaExternal(*ext, err))
+        Log::i("[ScriptEngine] Re-registered Lua external: ", ext->name); else
+        Log::e("[ScriptEngine] Unable to re-register Lua external: ", err);
       }
     }
 
   void ScriptEngine::onStartLoadingHandler() {
     (void)dispatchEvent("onStartLoading");
+    // current world is about to be destroyed; saving keeps it alive
+    if(L && Gothic::inst().checkLoading()==Gothic::LoadState::Loading) {
+      Lua::invalidateAllProxies(L);
+      invalidateDaedalusBindings();
+      }
     }
 
   void ScriptEngine::onSessionExitHandler() {
     (void)dispatchEvent("onSessionExit");
+    dropTasks();
+    clearStorageCache();
+    invalidateDaedalusBindings();
+    if(L)
+      Lua::invalidateAllProxies(L);
     }
 
   void ScriptEngine::onSettingsChangedHandler() {
@@ -3175,9 +5725,15 @@ void ScriptEngine::registerInternalAPI() {
     {"findNpcsInRange",  &ScriptEngine::luaWorldFindNpcsInRange},
     {"findNpcsNear",     &ScriptEngine::luaWorldFindNpcsNear},
     {"findNearestNpc",   &ScriptEngine::luaWorldFindNearestNpc},
+    {"findNearestNpcs",  &ScriptEngine::luaWorldFindNearestNpcs},
     {"detectItemsInRange", &ScriptEngine::luaWorldDetectItemsInRange},
     {"detectItemsNear",    &ScriptEngine::luaWorldDetectItemsNear},
     {"findNearestItem",    &ScriptEngine::luaWorldFindNearestItem},
+    {"snapshotNpcs",       &ScriptEngine::luaWorldSnapshotNpcs},
+    {"applyNpcChanges",    &ScriptEngine::luaWorldApplyNpcChanges},
+    {"npcThink",           &ScriptEngine::luaWorldNpcThink},
+    {"stateHash",          &ScriptEngine::luaWorldStateHash},
+    {"aiLod",              &ScriptEngine::luaWorldAiLod},
     {nullptr,            nullptr}
     };
   static const luaL_Reg empty[] = {{nullptr, nullptr}};
@@ -3208,7 +5764,7 @@ void ScriptEngine::registerInternalAPI() {
 
 bool ScriptEngine::executeBootstrapCode(const char* code, const char* name) {
   std::string bytecode;
-  if(!compileScript(code, bytecode)) {
+  if(!compileCached(name, code, bytecode)) {
     Log::e("[ScriptEngine] Failed to compile bootstrap: ", name);
     return false;
     }
@@ -3218,6 +5774,7 @@ bool ScriptEngine::executeBootstrapCode(const char* code, const char* name) {
     lua_pop(L, 1);
     return false;
     }
+  compileNative(name, true);
 
   if(lua_pcall(L, 0, 0, 0) != 0) {
     Log::e("[ScriptEngine] Bootstrap runtime error: ", lua_tostring(L, -1));
@@ -3233,72 +5790,193 @@ void ScriptEngine::loadBootstrap() {
     Log::e("[ScriptEngine] Failed to load bootstrap code");
   }
 
-namespace {
-  template<class T>
-  const char* getMetatableName() {
-    if constexpr(std::is_same_v<T, Inventory>)
-      return "Inventory";
-    if constexpr(std::is_same_v<T, World>)
-      return "World";
-    if constexpr(std::is_same_v<T, Interactive>)
-      return "Interactive";
-    if constexpr(std::is_same_v<T, Item>)
-      return "Item";
-    if constexpr(std::is_same_v<T, Npc>)
-      return "Npc";
-    return nullptr;
-    }
-  }
-
 template<class T>
 void ScriptEngine::pushDispatchArg(T* arg) {
+  using Obj = std::remove_const_t<T>;
   if(arg == nullptr) {
     lua_pushnil(L);
     return;
     }
 
-  const char* metatableName = getMetatableName<std::remove_const_t<T>>();
-  if(metatableName) {
-    Lua::push(L, const_cast<std::remove_const_t<T>*>(arg));
-    Lua::setMetatable(L, metatableName);
-    } else {
-    lua_pushlightuserdata(L, const_cast<std::remove_const_t<T>*>(arg));
+  if constexpr(Lua::Proxy<Obj>::tag != Lua::PT_None)
+    Lua::pushProxy(L, const_cast<Obj*>(arg));
+  else
+    lua_pushlightuserdata(L, const_cast<Obj*>(arg));
+  }
+
+int ScriptEngine::internEvent(std::string_view name) {
+  auto it = eventIds.find(std::string(name));
+  if(it!=eventIds.end())
+    return it->second;
+
+  const int id = int(events.size());
+  events.push_back(EventSlot{std::string(name)});
+  eventIds.emplace(std::string(name), id);
+  return id;
+  }
+
+std::vector<ScriptEngine::EventStats> ScriptEngine::eventStats() const {
+  std::vector<EventStats> ret;
+  ret.reserve(events.size());
+  for(auto& ev : events)
+    ret.push_back(EventStats{ev.name, ev.dispatched, ev.skippedEmpty, ev.skippedFiltered});
+  return ret;
+  }
+
+bool ScriptEngine::EventFilter::matches(const FilterArgs& a) const {
+  if(npcInstance>=0 || isPlayer>=0) {
+    if(a.npc==nullptr)
+      return false;
+    if(npcInstance>=0 && int32_t(a.npc->instanceSymbol())!=npcInstance)
+      return false;
+    if(isPlayer>=0 && a.npc->isPlayer()!=(isPlayer==1))
+      return false;
+    }
+  if(itemInstance>=0 && (a.item==nullptr || int32_t(a.item->clsId())!=itemInstance))
+    return false;
+  if(percType>=0 && (!a.hasCode || a.code!=percType))
+    return false;
+  return true;
+  }
+
+template<typename T>
+void ScriptEngine::collectFilterArg(FilterArgs& fa, const T& arg) {
+  if constexpr(std::is_same_v<T, Npc*> || std::is_same_v<T, const Npc*>) {
+    if(!fa.hasNpc) {
+      fa.npc    = arg;
+      fa.hasNpc = true;
+      }
+    }
+  else if constexpr(std::is_same_v<T, Item*> || std::is_same_v<T, const Item*>) {
+    if(!fa.hasItem) {
+      fa.item    = arg;
+      fa.hasItem = true;
+      }
+    }
+  else if constexpr(std::is_same_v<T, int>) {
+    if(!fa.hasCode) {
+      fa.code    = arg;
+      fa.hasCode = true;
+      }
     }
   }
 
 template<typename... Args>
-bool ScriptEngine::dispatchEvent(const char* eventName, Args... args) {
-  if(!L)
+bool ScriptEngine::dispatchEvent(int eventId, Args... args) {
+  if(!L || eventId<0)
     return false;
 
-  lua_getglobal(L, "opengothic");
-  if(!lua_istable(L, -1)) {
-    lua_pop(L, 1);
+  // no Lua call at all when nobody listens
+  auto& ev          = events[size_t(eventId)];
+  bool  hasHandlers = (ev.liveHandlers>0 && dispatchRef!=LUA_NOREF);
+  bool  partial     = false;
+  bool  filtered    = false;
+  if(hasHandlers && !ev.filters.empty()) {
+    // ... or when no handler filter matches the arguments
+    FilterArgs fa;
+    (collectFilterArg(fa, args), ...);
+    size_t hits = 0;
+    filterHits.resize(ev.filters.size());
+    for(size_t i=0; i<ev.filters.size(); ++i) {
+      filterHits[i] = uint8_t(ev.filters[i].filter.matches(fa) ? 1 : 0);
+      hits += filterHits[i];
+      }
+    if(hits==0 && ev.unfiltered==0) {
+      ++ev.skippedFiltered;
+      hasHandlers = false;
+      filtered    = true;
+      }
+    partial = hits<ev.filters.size();
+    }
+  if(!hasHandlers && ev.waiters.empty()) {
+    if(!filtered)
+      ++ev.skippedEmpty;
     return false;
     }
 
-  lua_getfield(L, -1, "_dispatchEvent");
-  if(!lua_isfunction(L, -1)) {
-    lua_pop(L, 2);
-    return false;
+  const bool handled = hasHandlers && invokeHandlers(eventId, partial, args...);
+  if(!events[size_t(eventId)].waiters.empty())
+    wakeEventWaiters(eventId, args...);
+  return handled;
+  }
+
+template<typename... Args>
+void ScriptEngine::wakeEventWaiters(int eventId, Args... args) {
+  // tasks may wait for the same event again, while being resumed
+  auto waiters = std::move(events[size_t(eventId)].waiters);
+  events[size_t(eventId)].waiters.clear();
+
+  const int nargs = int(sizeof...(args));
+  for(auto [id, gen] : waiters) {
+    auto it = asyncTasks.find(id);
+    if(it==asyncTasks.end() || it->second.gen!=gen)
+      continue;
+    (pushDispatchArg(args), ...);
+    lua_xmove(L, it->second.thread, nargs);
+    resumeTask(id, nargs, L);
     }
+  }
 
-  lua_pushstring(L, eventName);
+template<typename... Args>
+bool ScriptEngine::invokeHandlers(int eventId, bool partial, Args... args) {
+  auto& ev = events[size_t(eventId)];
+  ++ev.dispatched;
+
+  const bool profile = profiler.isEnabled() && dispatchProfiledRef!=LUA_NOREF;
+  const auto t0      = profile ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+  const auto heap0   = profile ? luaHeapBytes(L) : 0;
+
+  lua_rawgeti(L, LUA_REGISTRYINDEX, profile ? dispatchProfiledRef : dispatchRef);
+  lua_rawgeti(L, LUA_REGISTRYINDEX, ev.handlersRef);
+  if(partial) {
+    // registry-held table per nesting level: a handler may dispatch the same event again
+    if(matchedDepth==matchedRefs.size()) {
+      lua_createtable(L, 0, int(ev.filters.size()));
+      matchedRefs.push_back(lua_ref(L, -1));
+      } else {
+      lua_rawgeti(L, LUA_REGISTRYINDEX, matchedRefs[matchedDepth]);
+      lua_cleartable(L, -1);
+      }
+    for(size_t i=0; i<ev.filters.size(); ++i) {
+      lua_pushboolean(L, filterHits[i]);
+      lua_rawseti(L, -2, ev.filters[i].index);
+      }
+    } else {
+    lua_pushboolean(L, true);
+    }
   (pushDispatchArg(args), ...);
 
-  int nargs = 1 + sizeof...(args);
-  if(lua_pcall(L, nargs, 1, 0) != 0) {
-    Log::e("[ScriptEngine] Event dispatch error: ", lua_tostring(L, -1));
-    lua_pop(L, 2);
+  // the dispatcher switches modules per handler and doesn't get to switch back on errors
+  const int32_t outer = memModule;
+  beginExec();
+  int  nargs = 2 + sizeof...(args);
+  matchedDepth += partial ? 1 : 0;
+  int  err   = lua_pcall(L, nargs, 1, 0);
+  matchedDepth -= partial ? 1 : 0;
+  enterModule(L, outer);
+  if(profile)
+    profiler.record(ScriptProfiler::K_Event, eventId, events[size_t(eventId)].name, elapsedMs(t0), luaHeapBytes(L)-heap0);
+
+  if(err != 0) {
+    // handlers may intern new events, don't hold 'ev' across the call
+    Log::e("[ScriptEngine] Event dispatch error (", events[size_t(eventId)].name, "): ", lua_tostring(L, -1));
+    lua_pop(L, 1);
+    strikeBudgetOffender(eventId);
+    endExec();
     return false;
     }
+  endExec();
 
   bool handled = lua_toboolean(L, -1);
-  lua_pop(L, 2);
+  lua_pop(L, 1);
   return handled;
   }
 
+
 void ScriptEngine::bindHooks() {
+  onUpdateEvent     = internEvent("onUpdate");
+  onGameMinuteEvent = internEvent("onGameMinuteChanged");
+
   bind(Gothic::inst().onOpen, "onOpen", std::function([](Npc& p, Interactive& c) {
     return std::make_tuple(&p, &c);
     }));
@@ -3372,28 +6050,37 @@ void ScriptEngine::bindHooks() {
     }));
 
   // Notification-only hooks (return value ignored by C++ caller)
-  Gothic::inst().onNpcSpawn = [this](Npc& npc) {
-    dispatchEvent("onNpcSpawn", &npc);
+  Gothic::inst().onNpcSpawn = [this, id = internEvent("onNpcSpawn")](Npc& npc) {
+    dispatchEvent(id, &npc);
+    };
+
+  Gothic::inst().onNpcRemove = [this, id = internEvent("onNpcRemove")](Npc& npc) {
+    dispatchEvent(id, &npc);
+    if(L) {
+      Lua::invalidateProxy(L, &npc.inventory());
+      Lua::invalidateProxy(L, &npc);
+      }
     };
 
-  Gothic::inst().onNpcRemove = [this](Npc& npc) {
-    dispatchEvent("onNpcRemove", &npc);
+  Gothic::inst().onItemRemove = [this](const Item& item) {
+    if(L)
+      Lua::invalidateProxy(L, &item);
     };
 
-  Gothic::inst().onSwimStart = [this](Npc& npc) {
-    dispatchEvent("onSwimStart", &npc);
+  Gothic::inst().onSwimStart = [this, id = internEvent("onSwimStart")](Npc& npc) {
+    dispatchEvent(id, &npc);
     };
 
-  Gothic::inst().onSwimEnd = [this](Npc& npc) {
-    dispatchEvent("onSwimEnd", &npc);
+  Gothic::inst().onSwimEnd = [this, id = internEvent("onSwimEnd")](Npc& npc) {
+    dispatchEvent(id, &npc);
     };
 
-  Gothic::inst().onDiveStart = [this](Npc& npc) {
-    dispatchEvent("onDiveStart", &npc);
+  Gothic::inst().onDiveStart = [this, id = internEvent("onDiveStart")](Npc& npc) {
+    dispatchEvent(id, &npc);
     };
 
-  Gothic::inst().onDiveEnd = [this](Npc& npc) {
-    dispatchEvent("onDiveEnd", &npc);
+  Gothic::inst().onDiveEnd = [this, id = internEvent("onDiveEnd")](Npc& npc) {
+    dispatchEvent(id, &npc);
     };
 
   // New lifecycle and settings hooks (using Tempest::Signal::bind)
@@ -3425,6 +6112,7 @@ void ScriptEngine::unbindHooks() {
   Gothic::inst().onTrade         = nullptr;
   Gothic::inst().onNpcSpawn      = nullptr;
   Gothic::inst().onNpcRemove     = nullptr;
+  Gothic::inst().onItemRemove    = nullptr;
   Gothic::inst().onMobInteract   = nullptr;
   Gothic::inst().onJump          = nullptr;
   Gothic::inst().onSwimStart     = nullptr;
@@ -1,21 +1,34 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <list>
 #include <memory>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <functional>
 #include <tuple>
 
 #include <lua.h> // Required for pushDispatchArg overloads
 
+#include "scriptallocator.h"
+#include "scriptprofiler.h"
+#include "scriptscheduler.h"
+#include "timerwheel.h"
+#include "scriptworkerpool.h"
+
 struct lua_State;
 
 class Npc;
 class Interactive;
 class Inventory;
+class Item;
 class World;
 class Serialize;
+class ScriptWatcher;
 
 class ScriptEngine final {
   public:
@@ -32,25 +45,130 @@ class ScriptEngine final {
 
     std::string executeString(const std::string& code);
 
+    // Console snippets are loaded once and kept in an LRU keyed by their source text
+    struct ConsoleStats {
+      uint64_t hits      = 0;
+      uint64_t misses    = 0;
+      size_t   entries   = 0;
+      size_t   capacity  = 0;
+      double   compileMs = 0; // compile, load and native codegen of misses and watch expressions
+      };
+    ConsoleStats consoleStats() const;
+
+    // Watch expressions: evaluated every frame after onUpdate, natively compiled when the JIT is on
+    struct WatchExprInfo {
+      uint32_t    id = 0;
+      std::string expr;
+      std::string value; // last result, "Error: ..." if it failed
+      };
+    uint32_t                   addWatchExpr(const std::string& expr, std::string& err); // 0 on error
+    bool                       removeWatchExpr(uint32_t id);
+    void                       clearWatchExprs();
+    std::vector<WatchExprInfo> watchExprs() const;
+
     struct ScriptData {
       std::unordered_map<std::string, std::string> globalData;
       };
-    ScriptData serialize() const;
+    // legacy 'game/lua' string map; also resets opengothic.storage
     void deserialize(const ScriptData& data);
+    void loadLegacy(Serialize& fin);
 
-    void save(Serialize& fout) const;
+    // binary 'game/lua_storage': only keys that changed since the last save are re-encoded
+    void save(Serialize& fout);
     void load(Serialize& fin);
 
+    // opengothic.async tasks started via async.start(); others are dropped on save
+    void saveTasks(Serialize& fout) const;
+    void loadTasks(Serialize& fin);
+    void dropTasks();
+
     std::vector<std::string> getLoadedScripts() const;
     void reloadAllScripts();
+    // recompiles one script, drops the handlers and timers it owns and re-runs it with its onInit
+    bool reloadScript(const std::string& filepath);
     void loadModScripts();
     void bindHooks();
     void unbindHooks();
 
+    struct EventStats {
+      std::string name;
+      uint64_t    dispatched      = 0;
+      uint64_t    skippedEmpty    = 0;
+      uint64_t    skippedFiltered = 0;
+      };
+    std::vector<EventStats> eventStats() const;
+
+    // Off by default: switches event dispatch to the per-handler timing path
+    void            setProfiling(bool enable);
+    bool            isProfiling() const { return profiler.isEnabled(); }
+    ScriptProfiler& scriptProfiler() { return profiler; }
+
+    struct MemoryStats {
+      std::string module;   // script path, empty for the engine and the console
+      size_t      bytes    = 0;
+      bool        disabled = false; // hit the hard limit
+      };
+    std::vector<MemoryStats> memoryStats() const;
+    const ScriptAllocator&   scriptAllocator() const { return allocator; }
+
   private:
+    // What a handler filter looks at: the first Npc, the first Item and the first int argument
+    struct FilterArgs {
+      const Npc*  npc      = nullptr;
+      const Item* item     = nullptr;
+      int32_t     code     = 0;
+      bool        hasNpc   = false;
+      bool        hasItem  = false;
+      bool        hasCode  = false;
+      };
+
+    // events.register options compiled by _setEventHandlers; -1 matches anything
+    struct EventFilter {
+      int32_t npcInstance  = -1;
+      int32_t itemInstance = -1;
+      int32_t percType     = -1;
+      int8_t  isPlayer     = -1;
+
+      bool matches(const FilterArgs& a) const;
+      };
+
+    struct HandlerFilter {
+      int         index = 0; // position in the Lua handler list
+      EventFilter filter;
+      };
+
+    // Interned event: handler list lives in the Lua registry, C++ only keeps the ref
+    struct EventSlot {
+      std::string name;
+      int         handlersRef     = LUA_NOREF;
+      int         liveHandlers    = 0;
+      int         unfiltered      = 0; // live handlers without a filter
+      uint64_t    dispatched      = 0;
+      uint64_t    skippedEmpty    = 0;
+      uint64_t    skippedFiltered = 0;
+      std::vector<HandlerFilter> filters; // live handlers with a filter
+      std::vector<std::pair<uint32_t,uint32_t>> waiters; // async tasks in waitEvent: id, generation
+      };
+
+    int  internEvent(std::string_view name);
+
     // Fire event via Lua dispatcher - returns true if handled
     template<typename... Args>
-    bool dispatchEvent(const char* eventName, Args... args);
+    bool dispatchEvent(int eventId, Args... args);
+
+    template<typename... Args>
+    bool invokeHandlers(int eventId, bool partial, Args... args);
+
+    template<typename T>
+    static void collectFilterArg(FilterArgs& fa, const T& arg);
+
+    template<typename... Args>
+    void wakeEventWaiters(int eventId, Args... args);
+
+    template<typename... Args>
+    bool dispatchEvent(const char* eventName, Args... args) {
+      return dispatchEvent(internEvent(eventName), args...);
+      }
 
     template<typename T>
     void pushDispatchArg(T* arg);
@@ -77,10 +195,11 @@ class ScriptEngine final {
 
     template<typename... CppArgs, typename... LuaArgs>
     void bind(std::function<bool(CppArgs...)>& hook, const char* eventName, std::function<std::tuple<LuaArgs...>(CppArgs...)> argTransformer) {
-      hook = [this, eventName, argTransformer](CppArgs... args) {
+      const int eventId = internEvent(eventName);
+      hook = [this, eventId, argTransformer](CppArgs... args) {
         auto luaArgs = argTransformer(args...);
-        return std::apply([this, eventName](LuaArgs... largs) {
-          return this->dispatchEvent(eventName, largs...);
+        return std::apply([this, eventId](LuaArgs... largs) {
+          return this->dispatchEvent(eventId, largs...);
           }, luaArgs);
         };
       }
@@ -93,20 +212,247 @@ class ScriptEngine final {
 
     lua_State*              L = nullptr;
     std::vector<ScriptInfo> loadedScripts;
+
+    // Script modules by chunk name, ids stay valid across reloads. Handlers and timers are
+    // owned by the module whose function is closest on the Lua stack when they are created
+    std::vector<std::string>                 modulePaths;
+    std::unordered_map<std::string, int32_t> moduleIds;
+    std::unique_ptr<ScriptWatcher>           scriptWatcher; // -luawatch
+
+    // Lua memory per module: module m allocates in Luau memory category m+1, category 0
+    // is the engine, the console and modules past the category range. Allocations are
+    // attributed to the module whose code runs; threads keep the category they were
+    // created with. -luamem limits are checked once per update
+    enum MemoryState : uint8_t {
+      M_Normal,
+      M_OverSoft,  // emergency GC done, warned once
+      M_Disabled,  // handlers and timers dropped until the script is reloaded
+      };
+    ScriptAllocator                          allocator;
+    int32_t                                  memModule    = -1; // running module of the main thread
+    size_t                                   memSoftLimit = 0;
+    size_t                                   memHardLimit = 0;
+    std::vector<MemoryState>                 memStates;
     bool                    jitEnabled = false;
     std::string*            consoleOutput = nullptr;
     int                     lastGameMinuteStamp = -1;
 
-    // Lua external functions registered from Lua (name -> Lua registry ref)
-    std::unordered_map<std::string, int> luaExternals;
+    // Console snippet LRU and watch expressions, see executeString
+    struct ConsoleChunk {
+      std::string source;
+      int         fnRef = LUA_NOREF;
+      };
+    static constexpr size_t ConsoleCacheSize = 64;
+    std::list<ConsoleChunk>                                                 consoleChunks; // most recently used first
+    std::unordered_map<std::string_view, std::list<ConsoleChunk>::iterator> consoleChunkIds;
+    uint64_t                                                                consoleHits      = 0;
+    uint64_t                                                                consoleMisses    = 0;
+    double                                                                  consoleCompileMs = 0;
+
+    struct WatchExpr {
+      uint32_t    id    = 0;
+      std::string expr;
+      int         fnRef = LUA_NOREF;
+      std::string value;
+      };
+    std::vector<WatchExpr> watchExprList;
+    uint32_t               watchExprNextId = 1;
+
+    bool loadConsoleChunk(const std::string& source, const char* chunkName, bool native, std::string& err);
+    bool pushConsoleChunk(const std::string& source, std::string& err);
+    void clearConsoleChunks();
+    void runWatchExprs();
+
+    // Daedalus functions implemented in Lua (opengothic.vm.registerExternal). VM callbacks point
+    // at the entries, so they are never freed; registering a name again replaces it in place
+    enum ExternalType : uint8_t {
+      X_Void,
+      X_Int,
+      X_Float,
+      X_String,
+      X_Instance,
+      };
+    struct LuaExternal {
+      std::string               name;
+      int                       fnRef    = LUA_NOREF;
+      int32_t                   module   = -1;
+      bool                      explicitSignature = false;
+      ExternalType              ret      = X_Void;
+      std::vector<ExternalType> params;
+      };
+    std::vector<std::unique_ptr<LuaExternal>> luaExternals;
+    bool bindLuaExternal(LuaExternal& ext, std::string& err);
+
+    // Interned events (index == event id) and the Lua-side list dispatcher
+    std::vector<EventSlot>               events;
+    std::unordered_map<std::string, int> eventIds;
+    int                                  dispatchRef         = LUA_NOREF;
+    int                                  dispatchProfiledRef = LUA_NOREF;
+    std::vector<uint8_t>                 filterHits; // scratch of dispatchEvent, one per HandlerFilter
+    std::vector<int>                     matchedRefs; // 'matched' tables of invokeHandlers, one per nesting level
+    size_t                               matchedDepth = 0;
+    int                                  onUpdateEvent     = -1;
+    int                                  onGameMinuteEvent = -1;
+
+    // Persistent bytecode cache: one file per chunk, see compileCached
+    std::u16string                       bytecodeCacheDir;
+    uint32_t                             bytecodeCacheHits   = 0;
+    uint32_t                             bytecodeCacheMisses = 0;
+
+    // opengothic.storage: encoded value per key, reused while the key holds the same
+    // string/number/boolean, the same frozen table, or the same tracked table not touched
+    // and with unchanged content hash since
+    struct StorageEntry {
+      int         valueRef  = LUA_NOREF;
+      bool        immutable = false;
+      bool        seen      = false;
+      bool        dirty     = false; // storageTouch since the last encode
+      uint64_t    hash      = 0;     // StorageCodec::hash of tracked tables at the last encode
+      std::string blob;
+      };
+    std::unordered_map<std::string, StorageEntry> storageCache;
+    std::unordered_set<std::string>               storageTracked; // keys of opengothic.storageTrack, cleared with storageCache
+    void clearStorageCache();
+
+    // Luau CodeGen of loaded chunks, policy from -luanative
+    struct NativeStats {
+      uint32_t modules   = 0;
+      uint32_t functions = 0;
+      uint32_t skipped   = 0;
+      size_t   codeBytes = 0;
+      double   ms        = 0;
+      };
+    uint8_t                              nativePolicy        = 0;
+    NativeStats                          nativeStats;
+
+    ScriptProfiler                       profiler;
+
+    // Execution budget, enforced from the Luau interrupt callback. The deadline
+    // is armed by the outermost C++ -> Lua entry (event dispatch, console, task resume)
+    double                                execBudgetMs    = 0;
+    std::chrono::steady_clock::time_point execDeadline;
+    std::chrono::steady_clock::time_point execCap;         // end of the outermost dispatch, no re-arm past it
+    uint32_t                              execDepth       = 0;
+    uint32_t                              execTicks       = 0;
+    bool                                  execTripped     = false;
+    int                                   execOffenderRef = LUA_NOREF;
+    std::unordered_map<int, uint32_t>     execStrikes;    // handler id -> budget overruns
+
+    // Suspended Lua threads: opengothic.async tasks and coroutine event handlers
+    enum WaitKind : uint8_t {
+      W_NextUpdate,
+      W_Seconds,
+      W_GameMinutes,
+      W_Event,
+      W_Parallel,  // opengothic.parallel.map, resumed with its results; not saved
+      };
+    struct AsyncTask {
+      int         threadRef = LUA_NOREF;
+      lua_State*  thread    = nullptr;
+      bool        started   = false;
+      bool        cancelled = false;
+      uint32_t    gen       = 0;
+      WaitKind    wait      = W_NextUpdate;
+      double      wakeAt    = 0;         // script seconds or game minute stamp
+      int         eventId   = -1;
+      int         handlerId = -1;        // coroutine event handler
+      int32_t     module    = -1;        // module the thread allocates for, see enterModule
+      std::string label;                 // event name of a handler, entry name of a persistent task
+      int         stateRef  = LUA_NOREF; // persistent tasks only
+      };
+    std::unordered_map<uint32_t, AsyncTask>   asyncTasks;
+    std::vector<std::pair<uint32_t,uint32_t>> asyncReady;   // W_NextUpdate: id, generation
+    std::vector<std::pair<uint32_t,uint32_t>> asyncDue;
+    ScriptScheduler                           asyncQueue;
+    uint32_t                                  asyncNextId   = 1;
+    uint32_t                                  asyncRunning  = 0;
+    double                                    scriptTime    = 0;         // seconds, shared by tasks and timers
+    int64_t                                   asyncGameTime = -1;
+
+    // opengothic.timer: real-time timers live in the wheel, game-minute timers in a list
+    enum TimerKind : uint8_t {
+      T_After,
+      T_Every,
+      T_GameMinute,
+      };
+    struct Timer {
+      int                 fnRef     = LUA_NOREF;
+      TimerKind           kind      = T_After;
+      TimerWheel::Tick    interval  = 0;
+      TimerWheel::Tick    next      = 0;         // nominal expiry, kept when catch-up is deferred
+      uint64_t            frame     = 0;
+      uint8_t             catchUp   = 0;         // fires of an 'every' timer in the current frame
+      uint8_t             strikes   = 0;
+      int32_t             module    = -1;
+      };
+    std::unordered_map<uint32_t, Timer>       timers;
+    std::vector<uint32_t>                     minuteTimers;
+    TimerWheel                                timerWheel;
+    uint32_t                                  timerNextId   = 1;
+    uint64_t                                  timerFrame    = 0;
+    uint64_t                                  timerFires    = 0;
+    uint64_t                                  timerCancels  = 0;
+
+    // opengothic.parallel: jobs submitted during a frame run together at the next update
+    struct ParallelJob {
+      uint32_t id          = 0;
+      uint32_t taskId      = 0;         // waiting async task, if no callback
+      int      callbackRef = LUA_NOREF;
+      size_t   first       = 0;         // range in parallelItems
+      size_t   count       = 0;
+      };
+    ScriptWorkerPool                          workerPool;
+    std::vector<ParallelJob>                  parallelJobs;
+    std::vector<ScriptWorkerPool::Item>       parallelItems;
+    uint32_t                                  parallelNextId = 1;
+    uint64_t                                  parallelDone   = 0;
+    uint64_t                                  parallelItemsDone = 0;
+    double                                    parallelMs     = 0;
 
     void setupSandbox();
     void registerCoreFunctions();
     void registerInternalAPI();
     void loadBootstrap();
     void enableJIT();
+    void compileNative(const char* chunkName, bool report);
+    void logLoadStats() const;
     bool compileScript(const std::string& source, std::string& outBytecode);
+    bool compileCached(const std::string& chunkName, const std::string& source, std::string& outBytecode);
     bool executeBootstrapCode(const char* code, const char* name);
+    bool readScript(const std::string& filepath, std::string& source);
+    bool loadModuleChunk(const std::string& filepath, const std::string& source, std::string& bytecode);
+    bool runModuleChunk(int32_t module);
+    int32_t  internModule(const std::string& filepath);
+    int32_t  callerModule(lua_State* from) const;
+    uint32_t nextHandlerId();
+    uint32_t unregisterModuleHandlers(int32_t module, uint32_t fromId = 0, uint32_t toId = UINT32_MAX);
+    uint32_t cancelModuleTimers(int32_t module, uint32_t fromId = 0, uint32_t toId = UINT32_MAX);
+    void     pollScriptChanges();
+    int32_t* moduleSlot(lua_State* th);
+    int32_t  enterModule(lua_State* th, int32_t module);
+    void     checkMemoryLimits();
+
+    void beginExec();
+    void endExec();
+    void armExecDeadline(std::chrono::steady_clock::time_point now);
+    void captureBudgetOffender();
+    void strikeBudgetOffender(int eventId);
+    uint32_t createTask(lua_State* from, int nargs);
+    bool     resumeTask(uint32_t id, int nargs, lua_State* from);
+    void     scheduleTask(uint32_t id);
+    void     queueTask(uint32_t id);
+    bool     cancelTask(uint32_t id);
+    void     finishTask(uint32_t id);
+    void     runDueTasks();
+    uint32_t addTimer(lua_State* from, TimerKind kind, double seconds);
+    void     runParallelJobs();
+    bool     cancelTimer(uint32_t id);
+    void     fireTimer(uint32_t id);
+    void     runDueTimers();
+    void     runMinuteTimers();
+    void     clearTimers();
+    static int yieldTask(lua_State* L, WaitKind kind, double value);
+    static void luaInterrupt(lua_State* L, int gc);
 
   public:
     static int luaPrint(lua_State* L);
@@ -232,9 +578,15 @@ class ScriptEngine final {
     static int luaWorldFindNpcsInRange(lua_State* L);
     static int luaWorldFindNpcsNear(lua_State* L);
     static int luaWorldFindNearestNpc(lua_State* L);
+    static int luaWorldFindNearestNpcs(lua_State* L);
     static int luaWorldDetectItemsInRange(lua_State* L);
     static int luaWorldDetectItemsNear(lua_State* L);
     static int luaWorldFindNearestItem(lua_State* L);
+    static int luaWorldSnapshotNpcs(lua_State* L);    // struct-of-arrays read of all npc's
+    static int luaWorldApplyNpcChanges(lua_State* L); // batched write of snapshotNpcs-style columns
+    static int luaWorldNpcThink(lua_State* L);        // perception think/commit mode and counters
+    static int luaWorldStateHash(lua_State* L);
+    static int luaWorldAiLod(lua_State* L);           // far npc time slicing config and counters
 
     // Interactive Primitives
     static int luaInteractiveIsContainer(lua_State* L);
@@ -258,17 +610,50 @@ class ScriptEngine final {
     static int luaQuestCreateTopic(lua_State* L);
     static int luaQuestSetTopicStatus(lua_State* L);
     static int luaQuestAddEntry(lua_State* L);
+    static int luaSetEventHandlers(lua_State* L);
+    static int luaEventStats(lua_State* L);
+    static int luaProfileCall(lua_State* L);
+    static int luaRunHandlerThread(lua_State* L);
+    static int luaCallerModule(lua_State* L);
+    static int luaEnterModule(lua_State* L);
+    static int luaMemoryStats(lua_State* L);
+    static int luaStorageTrack(lua_State* L);
+    static int luaStorageTouch(lua_State* L);
+
+    // opengothic.async
+    static int luaAsyncRun(lua_State* L);
+    static int luaAsyncStart(lua_State* L);
+    static int luaAsyncWait(lua_State* L);
+    static int luaAsyncWaitGameMinutes(lua_State* L);
+    static int luaAsyncWaitEvent(lua_State* L);
+    static int luaAsyncCancel(lua_State* L);
+    static int luaAsyncCount(lua_State* L);
+    static int luaAsyncSignal(lua_State* L);
+
+    // opengothic.parallel
+    static int luaParallelDefine(lua_State* L);
+    static int luaParallelMap(lua_State* L);
+    static int luaParallelStats(lua_State* L);
+
+    // opengothic.timer (argument checks are done by bootstrap)
+    static int luaTimerSchedule(lua_State* L);
+    static int luaTimerCancel(lua_State* L);
+    static int luaTimerStats(lua_State* L);
 
     // Daedalus Bridge (opengothic.daedalus)
     static int luaDaedalusCall(lua_State* L);
     static int luaDaedalusGet(lua_State* L);
     static int luaDaedalusSet(lua_State* L);
+    static int luaDaedalusBind(lua_State* L);
+    static int luaDaedalusBoundCall(lua_State* L);
+    static int luaDaedalusBoundToString(lua_State* L);
 
     // VM Bridge (opengothic.vm)
     static int luaVmCallWithContext(lua_State* L);
     static int luaVmRegisterExternal(lua_State* L);
     static int luaVmGetSymbol(lua_State* L);
     static int luaVmEnumerate(lua_State* L);
+    static int luaVmEnumerateIndices(lua_State* L);
 
   private:
     // Tempest::Signal Handlers
@@ -281,4 +666,5 @@ class ScriptEngine final {
     void onSettingsChangedHandler();
 
     void reregisterLuaExternals();
+    void invalidateDaedalusBindings();
   };
@@ -0,0 +1,213 @@
+#include "scriptprofiler.h"
+
+#include <Tempest/Log>
+
+#include <algorithm>
+#include <cstdio>
+
+using namespace Tempest;
+
+static std::string jsonEscape(std::string_view s) {
+  std::string ret;
+  ret.reserve(s.size());
+  for(char c:s) {
+    if(c=='"' || c=='\\') {
+      ret.push_back('\\');
+      ret.push_back(c);
+      }
+    else if(uint8_t(c)<0x20) {
+      ret.push_back(' ');
+      }
+    else {
+      ret.push_back(c);
+      }
+    }
+  return ret;
+  }
+
+const char* ScriptProfiler::kindName(Kind k) {
+  switch(k) {
+    case K_Event:   return "event";
+    case K_Handler: return "handler";
+    case K_Timer:   return "timer";
+    }
+  return "?";
+  }
+
+uint64_t ScriptProfiler::key(Kind k, int64_t id) {
+  return (uint64_t(k)<<56) | (uint64_t(id) & 0x00ffffffffffffffull);
+  }
+
+void ScriptProfiler::setEnabled(bool e) {
+  if(enabled==e)
+    return;
+  enabled = e;
+  reset();
+  }
+
+void ScriptProfiler::reset() {
+  entries.clear();
+  modules.clear();
+  segment        = 0;
+  frameInSegment = 0;
+  frameCounter   = 0;
+  }
+
+void ScriptProfiler::record(Kind k, int64_t id, std::string_view label, double ms, int64_t bytes) {
+  auto& e = entries[key(k,id)];
+  if(e.seg[segment].calls==0 && e.label.empty()) {
+    e.kind  = k;
+    e.id    = id;
+    e.label = std::string(label);
+    }
+  auto& s = e.seg[segment];
+  s.ms    += ms;
+  s.calls += 1;
+  s.bytes += std::max<int64_t>(bytes,0);
+  e.frameMs += ms;
+  }
+
+void ScriptProfiler::recordModuleMemory(size_t slot, std::string_view module, int64_t bytes) {
+  if(slot>=modules.size())
+    modules.resize(slot+1);
+  auto& m = modules[slot];
+  if(m.module!=module) {
+    m.module = std::string(module);
+    m.peak   = 0;
+    }
+  m.bytes = bytes;
+  m.peak  = std::max(m.peak,bytes);
+  }
+
+void ScriptProfiler::endFrame() {
+  if(!enabled)
+    return;
+
+  ++frameCounter;
+  for(auto& [k,e]:entries) {
+    auto& s = e.seg[segment];
+    s.peakMs = std::max(s.peakMs,e.frameMs);
+    if(e.kind!=K_Event && budgetMs>0 && e.frameMs>budgetMs &&
+       (e.lastWarning==0 || frameCounter-e.lastWarning>=windowFrames())) {
+      // at most one warning per window and entry
+      char ms[32] = {};
+      std::snprintf(ms,sizeof(ms),"%.2f",e.frameMs);
+      Log::i("[ScriptProfiler] ",kindName(e.kind)," #",e.id," (",e.label,") took ",ms," ms in one frame, budget is ",budgetMs," ms");
+      e.lastWarning = frameCounter;
+      }
+    e.frameMs = 0;
+    }
+
+  if(++frameInSegment<FramesPerSegment)
+    return;
+
+  frameInSegment = 0;
+  segment        = (segment+1)%Segments;
+  for(auto it=entries.begin(); it!=entries.end();) {
+    auto& e = it->second;
+    e.seg[segment] = Slot();
+    bool empty = true;
+    for(auto& s:e.seg)
+      empty &= (s.calls==0);
+    if(empty)
+      it = entries.erase(it); else
+      ++it;
+    }
+  }
+
+std::vector<ScriptProfiler::Row> ScriptProfiler::rows() const {
+  std::vector<Row> ret;
+  ret.reserve(entries.size());
+  for(auto& [k,e]:entries) {
+    Row r;
+    r.kind  = e.kind;
+    r.id    = e.id;
+    r.label = e.label;
+    for(auto& s:e.seg) {
+      r.ms     += s.ms;
+      r.peakMs  = std::max(r.peakMs,s.peakMs);
+      r.calls  += s.calls;
+      r.bytes  += s.bytes;
+      }
+    if(r.calls>0)
+      ret.push_back(std::move(r));
+    }
+  std::sort(ret.begin(),ret.end(),[](const Row& a, const Row& b){
+    return a.ms>b.ms;
+    });
+  return ret;
+  }
+
+std::vector<std::string> ScriptProfiler::report(size_t maxRows) const {
+  std::vector<std::string> ret;
+  auto r = rows();
+  if(r.size()>maxRows)
+    r.resize(maxRows);
+
+  char buf[256] = {};
+  for(auto& i:r) {
+    std::snprintf(buf,sizeof(buf),"%-7s #%-5lld %-24s %8.2f ms  peak %6.2f ms  %7llu calls  %9.1f KB",
+                  kindName(i.kind), static_cast<long long>(i.id), i.label.c_str(),
+                  i.ms, i.peakMs, static_cast<unsigned long long>(i.calls), double(i.bytes)/1024.0);
+    ret.emplace_back(buf);
+    }
+  for(auto& m:modules) {
+    if(m.peak==0)
+      continue;
+    std::snprintf(buf,sizeof(buf),"memory  %-40s %9.1f KB  peak %9.1f KB",
+                  m.module.c_str(),double(m.bytes)/1024.0,double(m.peak)/1024.0);
+    ret.emplace_back(buf);
+    }
+  return ret;
+  }
+
+std::string ScriptProfiler::toCsv() const {
+  std::string ret = "kind,id,label,ms,peak_frame_ms,calls,bytes\n";
+  char buf[128] = {};
+  for(auto& i:rows()) {
+    ret += kindName(i.kind);
+    std::snprintf(buf,sizeof(buf),",%lld,",static_cast<long long>(i.id));
+    ret += buf;
+    ret += i.label;
+    std::snprintf(buf,sizeof(buf),",%.4f,%.4f,%llu,%lld\n",i.ms,i.peakMs,
+                  static_cast<unsigned long long>(i.calls),static_cast<long long>(i.bytes));
+    ret += buf;
+    }
+  return ret;
+  }
+
+std::string ScriptProfiler::toJson() const {
+  char buf[160] = {};
+  std::snprintf(buf,sizeof(buf),"{\n  \"windowFrames\": %u,\n  \"budgetMs\": %.3f,\n  \"entries\": [",windowFrames(),budgetMs);
+  std::string ret = buf;
+
+  bool first = true;
+  for(auto& i:rows()) {
+    ret += first ? "\n" : ",\n";
+    first = false;
+    ret += "    {\"kind\": \"";
+    ret += kindName(i.kind);
+    std::snprintf(buf,sizeof(buf),"\", \"id\": %lld, \"label\": \"",static_cast<long long>(i.id));
+    ret += buf;
+    ret += jsonEscape(i.label);
+    std::snprintf(buf,sizeof(buf),"\", \"ms\": %.4f, \"peakFrameMs\": %.4f, \"calls\": %llu, \"bytes\": %lld}",
+                  i.ms,i.peakMs,static_cast<unsigned long long>(i.calls),static_cast<long long>(i.bytes));
+    ret += buf;
+    }
+  ret += "\n  ],\n  \"modules\": [";
+
+  first = true;
+  for(auto& m:modules) {
+    if(m.peak==0)
+      continue;
+    ret += first ? "\n" : ",\n";
+    first = false;
+    ret += "    {\"module\": \"";
+    ret += jsonEscape(m.module);
+    std::snprintf(buf,sizeof(buf),"\", \"bytes\": %lld, \"peakBytes\": %lld}",
+                  static_cast<long long>(m.bytes),static_cast<long long>(m.peak));
+    ret += buf;
+    }
+  ret += "\n  ]\n}\n";
+  return ret;
+  }
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Opt-in timing of Lua entry points (events, handlers, timer tasks),
+// aggregated over a rolling window of frames.
+class ScriptProfiler final {
+  public:
+    enum Kind : uint8_t {
+      K_Event,
+      K_Handler,
+      K_Timer,
+      };
+
+    struct Row {
+      Kind        kind   = K_Event;
+      int64_t     id     = 0;   // event id, handler id or timer task id
+      std::string label;        // event name, if known
+      double      ms     = 0;
+      double      peakMs = 0;   // worst single frame
+      uint64_t    calls  = 0;
+      int64_t     bytes  = 0;   // Lua heap growth during calls
+      };
+
+    // Lua heap held by a script module, sampled once per frame
+    struct ModuleMemory {
+      std::string module;
+      int64_t     bytes = 0;
+      int64_t     peak  = 0;   // since the profiler was enabled
+      };
+
+    void   setEnabled(bool e);
+    bool   isEnabled() const { return enabled; }
+    void   setFrameBudget(double ms) { budgetMs = ms; }
+    double frameBudget() const { return budgetMs; }
+    void   reset();
+
+    void   record(Kind k, int64_t id, std::string_view label, double ms, int64_t bytes);
+    void   endFrame();
+    void   recordModuleMemory(size_t slot, std::string_view module, int64_t bytes);
+
+    uint32_t                 windowFrames() const { return Segments*FramesPerSegment; }
+    std::vector<Row>         rows() const;
+    const std::vector<ModuleMemory>& moduleMemory() const { return modules; }
+    std::vector<std::string> report(size_t maxRows) const;
+    std::string              toCsv() const;
+    std::string              toJson() const;
+
+    static const char*       kindName(Kind k);
+
+  private:
+    static constexpr size_t   Segments         = 10;
+    static constexpr uint32_t FramesPerSegment = 30;
+
+    struct Slot {
+      double   ms     = 0;
+      double   peakMs = 0;
+      uint64_t calls  = 0;
+      int64_t  bytes  = 0;
+      };
+
+    struct Entry {
+      Kind                      kind = K_Event;
+      int64_t                   id   = 0;
+      std::string               label;
+      std::array<Slot,Segments> seg;
+      double                    frameMs     = 0;
+      uint32_t                  lastWarning = 0;
+      };
+
+    static uint64_t key(Kind k, int64_t id);
+
+    std::unordered_map<uint64_t,Entry> entries;
+    std::vector<ModuleMemory>          modules;
+    size_t                             segment        = 0;
+    uint32_t                           frameInSegment = 0;
+    uint32_t                           frameCounter   = 0;
+    bool                               enabled        = false;
+    double                             budgetMs       = 2.0;
+  };
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Wake-up queues for suspended Lua tasks: one binary min-heap per clock.
+// Entries are never removed in place; the owner drops stale ones by generation.
+class ScriptScheduler final {
+  public:
+    enum Clock : uint8_t {
+      C_Real, // seconds of script time
+      C_Game, // game minutes
+      C_Count,
+      };
+
+    void   clear() {
+      for(auto& h:heap)
+        h.clear();
+      }
+
+    size_t size() const {
+      size_t n = 0;
+      for(auto& h:heap)
+        n += h.size();
+      return n;
+      }
+
+    void   push(Clock c, double at, uint32_t id, uint32_t gen) {
+      auto& h = heap[c];
+      h.push_back(Node{at,seq++,id,gen});
+      std::push_heap(h.begin(),h.end(),std::greater<Node>());
+      }
+
+    // pops every entry due at 'now' in wake order; f(id,gen)
+    template<class F>
+    void   popDue(Clock c, double now, F f) {
+      auto& h = heap[c];
+      while(!h.empty() && h.front().at<=now) {
+        std::pop_heap(h.begin(),h.end(),std::greater<Node>());
+        const Node n = h.back();
+        h.pop_back();
+        f(n.id,n.gen);
+        }
+      }
+
+  private:
+    struct Node {
+      double   at  = 0;
+      uint64_t seq = 0; // FIFO among equal wake times
+      uint32_t id  = 0;
+      uint32_t gen = 0;
+
+      bool operator > (const Node& other) const {
+        if(at!=other.at)
+          return at>other.at;
+        return seq>other.seq;
+        }
+      };
+
+    std::vector<Node> heap[C_Count];
+    uint64_t          seq = 0;
+  };
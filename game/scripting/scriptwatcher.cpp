@@ -0,0 +1,117 @@
+#include "scriptwatcher.h"
+
+#include <Tempest/Log>
+
+#include <algorithm>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+using namespace Tempest;
+
+ScriptWatcher::ScriptWatcher() {
+#if defined(__linux__)
+  fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if(fd<0)
+    Log::i("[ScriptWatcher] inotify not available, polling every ", PollInterval.count(), " ms");
+#else
+  Log::i("[ScriptWatcher] polling every ", PollInterval.count(), " ms");
+#endif
+  lastPoll = std::chrono::steady_clock::now();
+  }
+
+ScriptWatcher::~ScriptWatcher() {
+#if defined(__linux__)
+  if(fd>=0)
+    close(fd);
+#endif
+  }
+
+std::string ScriptWatcher::normalize(const std::filesystem::path& p) {
+  std::error_code ec;
+  auto abs = std::filesystem::absolute(p, ec);
+  return (ec ? p : abs).lexically_normal().generic_string();
+  }
+
+void ScriptWatcher::add(const std::string& path) {
+  const std::filesystem::path p   = normalize(path);
+  const std::string           key = p.generic_string();
+  if(files.find(key)!=files.end())
+    return;
+
+  std::error_code ec;
+  File f;
+  f.path  = path;
+  f.mtime = std::filesystem::last_write_time(p, ec);
+  files[key] = std::move(f);
+
+#if defined(__linux__)
+  if(fd<0)
+    return;
+  const std::string dir = p.parent_path().generic_string();
+  for(auto& [wd, d] : dirs)
+    if(d==dir)
+      return;
+  const int wd = inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+  if(wd<0) {
+    Log::i("[ScriptWatcher] unable to watch ", dir, ", falling back to polling");
+    close(fd);
+    fd = -1;
+    dirs.clear();
+    return;
+    }
+  dirs[wd] = dir;
+#endif
+  }
+
+std::vector<std::string> ScriptWatcher::poll() {
+  std::vector<std::string> out;
+  if(fd>=0)
+    pollNative(out); else
+    pollTimes(out);
+  return out;
+  }
+
+void ScriptWatcher::pollNative(std::vector<std::string>& out) {
+#if defined(__linux__)
+  alignas(inotify_event) char buf[4096];
+  while(true) {
+    const ssize_t len = read(fd, buf, sizeof(buf));
+    if(len<=0)
+      break;
+    for(ssize_t at=0; at<len;) {
+      auto* ev = reinterpret_cast<const inotify_event*>(buf+at);
+      at += ssize_t(sizeof(inotify_event) + ev->len);
+
+      auto d = dirs.find(ev->wd);
+      if(ev->len==0 || d==dirs.end())
+        continue;
+      auto f = files.find(d->second + "/" + ev->name);
+      if(f==files.end())
+        continue;
+      if(std::find(out.begin(), out.end(), f->second.path)==out.end())
+        out.push_back(f->second.path);
+      }
+    }
+#else
+  (void)out;
+#endif
+  }
+
+void ScriptWatcher::pollTimes(std::vector<std::string>& out) {
+  const auto now = std::chrono::steady_clock::now();
+  if(now-lastPoll<PollInterval)
+    return;
+  lastPoll = now;
+
+  for(auto& [key, f] : files) {
+    std::error_code ec;
+    const auto mtime = std::filesystem::last_write_time(key, ec);
+    if(ec || mtime==f.mtime)
+      continue;
+    f.mtime = mtime;
+    out.push_back(f.path);
+    }
+  }
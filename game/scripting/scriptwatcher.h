@@ -0,0 +1,42 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Reports script files that were written since the last poll. Uses inotify on the
+// parent directories where available (editors often replace files by rename), and
+// falls back to comparing modification times every PollInterval.
+class ScriptWatcher final {
+  public:
+    ScriptWatcher();
+    ~ScriptWatcher();
+
+    ScriptWatcher(const ScriptWatcher&) = delete;
+    ScriptWatcher& operator=(const ScriptWatcher&) = delete;
+
+    void add(const std::string& path);
+    bool isNative() const { return fd>=0; }
+
+    // changed paths, as passed to add()
+    std::vector<std::string> poll();
+
+  private:
+    static constexpr std::chrono::milliseconds PollInterval{500};
+
+    struct File {
+      std::string                     path;
+      std::filesystem::file_time_type mtime;
+      };
+
+    int                                          fd = -1;
+    std::unordered_map<int, std::string>         dirs;  // inotify watch -> directory
+    std::unordered_map<std::string, File>        files; // normalized path -> file
+    std::chrono::steady_clock::time_point        lastPoll;
+
+    static std::string normalize(const std::filesystem::path& p);
+    void pollNative(std::vector<std::string>& out);
+    void pollTimes(std::vector<std::string>& out);
+  };
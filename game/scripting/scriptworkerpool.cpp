@@ -0,0 +1,154 @@
+#include "scriptworkerpool.h"
+
+#include <lua.h>
+#include <lualib.h>
+
+#include "storagecodec.h"
+#include "utils/workers.h"
+
+namespace {
+  constexpr uint32_t WorkerCheckInterval = 256;
+  }
+
+ScriptWorkerPool::~ScriptWorkerPool() {
+  clear();
+  }
+
+void ScriptWorkerPool::define(const std::string& name, std::string bytecode) {
+  auto& m = modules[name];
+  m.bytecode = std::move(bytecode);
+  m.version  = ++moduleVersion;
+  }
+
+bool ScriptWorkerPool::isDefined(const std::string& name) const {
+  return modules.find(name)!=modules.end();
+  }
+
+void ScriptWorkerPool::clear() {
+  std::lock_guard<std::mutex> guard(sync);
+  for(auto& s : states)
+    lua_close(s->L);
+  states.clear();
+  idle.clear();
+  modules.clear();
+  }
+
+void ScriptWorkerPool::run(std::vector<Item>& items) {
+  if(items.empty())
+    return;
+  Workers::parallelTasks(items.size(), [this, &items](size_t i) {
+    State* s = acquire();
+    runItem(*s, items[i]);
+    release(s);
+    });
+  }
+
+ScriptWorkerPool::State* ScriptWorkerPool::acquire() {
+  std::lock_guard<std::mutex> guard(sync);
+  if(!idle.empty()) {
+    State* s = idle.back();
+    idle.pop_back();
+    return s;
+    }
+  states.emplace_back(newState());
+  return states.back().get();
+  }
+
+void ScriptWorkerPool::release(State* s) {
+  std::lock_guard<std::mutex> guard(sync);
+  idle.push_back(s);
+  }
+
+ScriptWorkerPool::State* ScriptWorkerPool::newState() {
+  auto* s = new State();
+  s->L = luaL_newstate();
+  luaL_openlibs(s->L);
+
+  lua_pushnil(s->L);
+  lua_setglobal(s->L, "print");
+  lua_pushnil(s->L);
+  lua_setglobal(s->L, "os");
+  // read-only globals and libraries: modules keep state in locals only
+  luaL_sandbox(s->L);
+
+  lua_callbacks(s->L)->userdata  = s;
+  lua_callbacks(s->L)->interrupt = interrupt;
+  return s;
+  }
+
+void ScriptWorkerPool::interrupt(lua_State* L, int gc) {
+  if(gc>=0)
+    return;
+  auto* s = static_cast<State*>(lua_callbacks(L)->userdata);
+  if(s==nullptr || s->budget<=0)
+    return;
+  if((++s->ticks % WorkerCheckInterval)!=0)
+    return;
+  if(std::chrono::steady_clock::now()<s->deadline)
+    return;
+  luaL_error(L, "parallel worker exceeded the execution budget of %d ms", int(s->budget));
+  }
+
+// Pushes the module function, loading it into this state on first use or after a redefine
+bool ScriptWorkerPool::prepare(State& s, const std::string& name, std::string& err) {
+  auto m = modules.find(name);
+  if(m==modules.end()) {
+    err = "unknown parallel module '" + name + "'";
+    return false;
+    }
+
+  auto l = s.loaded.find(name);
+  if(l!=s.loaded.end() && l->second.version==m->second.version) {
+    lua_rawgeti(s.L, LUA_REGISTRYINDEX, l->second.ref);
+    return true;
+    }
+  if(l!=s.loaded.end()) {
+    lua_unref(s.L, l->second.ref);
+    s.loaded.erase(l);
+    }
+
+  auto& bc = m->second.bytecode;
+  if(luau_load(s.L, name.c_str(), bc.data(), bc.size(), 0)!=0 || lua_pcall(s.L, 0, 1, 0)!=0) {
+    err = lua_isstring(s.L, -1) ? lua_tostring(s.L, -1) : "module failed to load";
+    lua_pop(s.L, 1);
+    return false;
+    }
+  if(!lua_isfunction(s.L, -1)) {
+    err = "parallel module '" + name + "' must return a function";
+    lua_pop(s.L, 1);
+    return false;
+    }
+
+  Loaded ld;
+  ld.version = m->second.version;
+  ld.ref     = lua_ref(s.L, -1);
+  s.loaded[name] = ld;
+  return true;
+  }
+
+void ScriptWorkerPool::runItem(State& s, Item& item) {
+  lua_State* L = s.L;
+  s.budget   = budgetMs;
+  s.ticks    = 0;
+  s.deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                 std::chrono::duration<double, std::milli>(budgetMs));
+
+  if(!prepare(s, item.module, item.error)) {
+    lua_settop(L, 0);
+    return;
+    }
+  if(!StorageCodec::decode(L, item.input, item.error)) {
+    lua_settop(L, 0);
+    return;
+    }
+  if(lua_pcall(L, 1, 1, 0)!=0) {
+    item.error = lua_isstring(L, -1) ? lua_tostring(L, -1) : "error object is not a string";
+    lua_settop(L, 0);
+    return;
+    }
+
+  bool immutable = false;
+  if(!StorageCodec::encode(L, -1, item.output, immutable, item.error) && item.error.empty())
+    item.error = "result can't be encoded";
+  lua_settop(L, 0);
+  }
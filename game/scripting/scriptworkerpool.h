@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct lua_State;
+
+// Sandboxed lua_States for opengothic.parallel. Workers only see the Luau standard
+// libraries and the modules defined here; values cross over StorageCodec-encoded,
+// so nothing of the main state (or the engine) is reachable from a worker thread.
+class ScriptWorkerPool final {
+  public:
+    struct Item {
+      std::string module;
+      std::string input;  // StorageCodec
+      std::string output; // StorageCodec, valid if error is empty
+      std::string error;
+      };
+
+    ScriptWorkerPool() = default;
+    ~ScriptWorkerPool();
+
+    ScriptWorkerPool(const ScriptWorkerPool&) = delete;
+    ScriptWorkerPool& operator=(const ScriptWorkerPool&) = delete;
+
+    // bytecode of a chunk returning function(input) -> output
+    void   define(const std::string& name, std::string bytecode);
+    bool   isDefined(const std::string& name) const;
+    void   setBudget(double ms) { budgetMs = ms; }
+    void   clear();
+
+    // runs all items on Workers threads, returns once every item is done
+    void   run(std::vector<Item>& items);
+    size_t stateCount() const { return states.size(); }
+
+  private:
+    struct Module {
+      std::string bytecode;
+      uint32_t    version = 0;
+      };
+
+    struct Loaded {
+      uint32_t version = 0;
+      int      ref     = 0;
+      };
+
+    struct State {
+      lua_State*                              L      = nullptr;
+      double                                  budget = 0;
+      uint32_t                                ticks  = 0;
+      std::chrono::steady_clock::time_point   deadline;
+      std::unordered_map<std::string, Loaded> loaded;
+      };
+
+    std::unordered_map<std::string, Module> modules;
+    uint32_t                                moduleVersion = 0;
+    double                                  budgetMs      = 0;
+
+    std::mutex                              sync;
+    std::vector<std::unique_ptr<State>>     states;
+    std::vector<State*>                     idle;
+
+    State* acquire();
+    void   release(State* s);
+    bool   prepare(State& s, const std::string& name, std::string& err);
+    void   runItem(State& s, Item& item);
+
+    static State* newState();
+    static void   interrupt(lua_State* L, int gc);
+  };
@@ -0,0 +1,291 @@
+#include "storagecodec.h"
+
+#include <lua.h>
+
+#include <cmath>
+#include <cstring>
+
+bool StorageCodec::encode(lua_State* L, int idx, std::string& out, bool& immutable, std::string& err) {
+  immutable = true;
+  if(!isEncodable(lua_type(L, idx))) {
+    err = std::string("unsupported type ") + lua_typename(L, lua_type(L, idx));
+    return false;
+    }
+  return encodeValue(L, lua_absindex(L, idx), out, immutable, 0, err);
+  }
+
+bool StorageCodec::decode(lua_State* L, std::string_view data, std::string& err) {
+  Reader r;
+  r.at  = reinterpret_cast<const uint8_t*>(data.data());
+  r.end = r.at + data.size();
+
+  const int top = lua_gettop(L);
+  if(!decodeValue(L, r, 0, err) || r.at!=r.end) {
+    if(err.empty())
+      err = "trailing data";
+    lua_settop(L, top);
+    return false;
+    }
+  return true;
+  }
+
+bool StorageCodec::isEncodable(int type) {
+  return type==LUA_TNIL || type==LUA_TBOOLEAN || type==LUA_TNUMBER || type==LUA_TSTRING || type==LUA_TTABLE;
+  }
+
+bool StorageCodec::encodeValue(lua_State* L, int idx, std::string& out, bool& immutable, uint32_t depth, std::string& err) {
+  switch(lua_type(L, idx)) {
+    case LUA_TBOOLEAN:
+      out.push_back(char(lua_toboolean(L, idx) ? T_True : T_False));
+      return true;
+    case LUA_TNUMBER: {
+      const double v = lua_tonumber(L, idx);
+      if(v==std::floor(v) && std::fabs(v)<=9007199254740992.0 && !(v==0 && std::signbit(v))) {
+        const int64_t i = int64_t(v);
+        out.push_back(char(T_Int));
+        writeVarint(out, (uint64_t(i)<<1) ^ uint64_t(i>>63));
+        } else {
+        char raw[sizeof(double)];
+        std::memcpy(raw, &v, sizeof(v));
+        out.push_back(char(T_Number));
+        out.append(raw, sizeof(raw));
+        }
+      return true;
+      }
+    case LUA_TSTRING: {
+      size_t      len = 0;
+      const char* str = lua_tolstring(L, idx, &len);
+      out.push_back(char(T_String));
+      writeVarint(out, len);
+      out.append(str, len);
+      return true;
+      }
+    case LUA_TTABLE:
+      return encodeTable(L, idx, out, immutable, depth, err);
+    default:
+      // unsupported values inside tables: kept as holes
+      out.push_back(char(T_Nil));
+      return true;
+    }
+  }
+
+bool StorageCodec::encodeTable(lua_State* L, int idx, std::string& out, bool& immutable, uint32_t depth, std::string& err) {
+  if(depth>=MaxDepth) {
+    err = "tables nested too deep (or cyclic)";
+    return false;
+    }
+  if(!lua_checkstack(L, 4)) {
+    err = "out of stack space";
+    return false;
+    }
+  if(!lua_getreadonly(L, idx))
+    immutable = false;
+
+  int arrayLen = 0;
+  while(true) {
+    lua_rawgeti(L, idx, arrayLen+1);
+    const bool isNil = lua_isnil(L, -1);
+    lua_pop(L, 1);
+    if(isNil)
+      break;
+    ++arrayLen;
+    }
+
+  out.push_back(char(T_Table));
+  writeVarint(out, uint64_t(arrayLen));
+  for(int i=1; i<=arrayLen; ++i) {
+    lua_rawgeti(L, idx, i);
+    const bool ok = encodeValue(L, lua_gettop(L), out, immutable, depth+1, err);
+    lua_pop(L, 1);
+    if(!ok)
+      return false;
+    }
+
+  lua_pushnil(L);
+  while(lua_next(L, idx)!=0) {
+    const int kt = lua_type(L, -2);
+    bool      skip = !isEncodable(lua_type(L, -1)) || (kt!=LUA_TSTRING && kt!=LUA_TNUMBER && kt!=LUA_TBOOLEAN);
+    if(!skip && kt==LUA_TNUMBER) {
+      const double k = lua_tonumber(L, -2);
+      skip = (k>=1 && k<=arrayLen && k==std::floor(k));
+      }
+    if(!skip) {
+      const int top = lua_gettop(L);
+      if(!encodeValue(L, top-1, out, immutable, depth+1, err) ||
+         !encodeValue(L, top,   out, immutable, depth+1, err)) {
+        lua_pop(L, 2);
+        return false;
+        }
+      }
+    lua_pop(L, 1);
+    }
+  out.push_back(char(T_Nil));
+  return true;
+  }
+
+bool StorageCodec::decodeValue(lua_State* L, Reader& r, uint32_t depth, std::string& err) {
+  if(r.at>=r.end) {
+    err = "unexpected end of data";
+    return false;
+    }
+  if(!lua_checkstack(L, 4)) {
+    err = "out of stack space";
+    return false;
+    }
+
+  const uint8_t tag = *r.at++;
+  switch(tag) {
+    case T_Nil:
+      lua_pushnil(L);
+      return true;
+    case T_False:
+    case T_True:
+      lua_pushboolean(L, tag==T_True);
+      return true;
+    case T_Int: {
+      const uint64_t zz = readVarint(r);
+      const int64_t  i  = int64_t(zz>>1) ^ -int64_t(zz & 1);
+      lua_pushnumber(L, double(i));
+      break;
+      }
+    case T_Number: {
+      double v = 0;
+      if(r.end-r.at<int(sizeof(v))) {
+        r.ok = false;
+        break;
+        }
+      std::memcpy(&v, r.at, sizeof(v));
+      r.at += sizeof(v);
+      lua_pushnumber(L, v);
+      break;
+      }
+    case T_String: {
+      const uint64_t len = readVarint(r);
+      if(!r.ok || len>uint64_t(r.end-r.at)) {
+        r.ok = false;
+        break;
+        }
+      lua_pushlstring(L, reinterpret_cast<const char*>(r.at), size_t(len));
+      r.at += len;
+      break;
+      }
+    case T_Table: {
+      if(depth>=MaxDepth) {
+        err = "tables nested too deep";
+        return false;
+        }
+      const uint64_t arrayLen = readVarint(r);
+      if(!r.ok || arrayLen>uint64_t(r.end-r.at)) {
+        r.ok = false;
+        break;
+        }
+      lua_createtable(L, int(arrayLen), 0);
+      for(uint64_t i=1; i<=arrayLen; ++i) {
+        if(!decodeValue(L, r, depth+1, err))
+          return false;
+        lua_rawseti(L, -2, int(i));
+        }
+      while(true) {
+        if(r.at>=r.end) {
+          r.ok = false;
+          break;
+          }
+        if(*r.at==T_Nil) {
+          ++r.at;
+          break;
+          }
+        if(!decodeValue(L, r, depth+1, err) || !decodeValue(L, r, depth+1, err))
+          return false;
+        if(lua_isnumber(L, -2) && std::isnan(lua_tonumber(L, -2))) {
+          err = "NaN table key";
+          return false;
+          }
+        lua_rawset(L, -3);
+        }
+      break;
+      }
+    default:
+      err = "unknown tag " + std::to_string(tag);
+      return false;
+    }
+
+  if(!r.ok) {
+    err = "malformed data";
+    return false;
+    }
+  return true;
+  }
+
+uint64_t StorageCodec::hash(lua_State* L, int idx) {
+  return hashValue(L, lua_absindex(L, idx), 0);
+  }
+
+uint64_t StorageCodec::hashValue(lua_State* L, int idx, uint32_t depth) {
+  const int type = lua_type(L, idx);
+  switch(type) {
+    case LUA_TBOOLEAN:
+      return mix(uint64_t(type)<<32 | uint64_t(lua_toboolean(L, idx)));
+    case LUA_TNUMBER: {
+      const double v = lua_tonumber(L, idx);
+      uint64_t     bits = 0;
+      std::memcpy(&bits, &v, sizeof(v));
+      return mix(bits ^ uint64_t(type));
+      }
+    case LUA_TSTRING: {
+      // FNV-1a
+      size_t      len = 0;
+      const char* str = lua_tolstring(L, idx, &len);
+      uint64_t    h   = 0xcbf29ce484222325ull;
+      for(size_t i=0; i<len; ++i)
+        h = (h ^ uint8_t(str[i])) * 0x100000001b3ull;
+      return mix(h ^ uint64_t(type));
+      }
+    case LUA_TTABLE: {
+      // sum of entry hashes: the same content hashes equal whatever slot order lua_next has
+      uint64_t h = mix(uint64_t(type));
+      if(depth>=MaxDepth || !lua_checkstack(L, 3))
+        return h;
+      lua_pushnil(L);
+      while(lua_next(L, idx)!=0) {
+        const int top = lua_gettop(L);
+        h += mix(hashValue(L, top-1, depth+1)*31 + hashValue(L, top, depth+1));
+        lua_pop(L, 1);
+        }
+      return h;
+      }
+    default:
+      return mix(uint64_t(type));
+    }
+  }
+
+uint64_t StorageCodec::mix(uint64_t h) {
+  // splitmix64 finalizer
+  h ^= h >> 30;
+  h *= 0xbf58476d1ce4e5b9ull;
+  h ^= h >> 27;
+  h *= 0x94d049bb133111ebull;
+  h ^= h >> 31;
+  return h;
+  }
+
+void StorageCodec::writeVarint(std::string& out, uint64_t v) {
+  while(v>=0x80) {
+    out.push_back(char(uint8_t(v) | 0x80));
+    v >>= 7;
+    }
+  out.push_back(char(v));
+  }
+
+uint64_t StorageCodec::readVarint(Reader& r) {
+  uint64_t v = 0;
+  for(uint32_t shift=0; shift<64; shift+=7) {
+    if(r.at>=r.end)
+      break;
+    const uint8_t b = *r.at++;
+    v |= uint64_t(b & 0x7f) << shift;
+    if((b & 0x80)==0)
+      return v;
+    }
+  r.ok = false;
+  return 0;
+  }
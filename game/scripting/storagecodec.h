@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+struct lua_State;
+
+// Binary encoding of opengothic.storage values: nil, booleans, numbers, strings and
+// tables (array part + hash part, nested up to MaxDepth). Functions, userdata and
+// threads are skipped inside tables.
+class StorageCodec final {
+  public:
+    // bumped whenever the layout of an encoded value changes
+    static constexpr uint32_t Version  = 1;
+    static constexpr uint32_t MaxDepth = 32;
+
+    // appends value at 'idx'; 'immutable' is cleared if the value holds a table
+    // that is not frozen, i.e. may change without being reassigned
+    static bool encode(lua_State* L, int idx, std::string& out, bool& immutable, std::string& err);
+
+    // pushes the decoded value, or nothing on malformed data
+    static bool decode(lua_State* L, std::string_view data, std::string& err);
+
+    // content hash of the value at 'idx', independent of table iteration order;
+    // cheaper than encode, used to spot in-place changes of cached tables
+    static uint64_t hash(lua_State* L, int idx);
+
+  private:
+    enum Tag : uint8_t {
+      T_Nil,
+      T_False,
+      T_True,
+      T_Int,    // zigzag varint, integral numbers within 2^53
+      T_Number, // raw double
+      T_String, // varint length + bytes
+      T_Table,  // varint array length + values, then key/value pairs closed by T_Nil
+      };
+
+    struct Reader {
+      const uint8_t* at  = nullptr;
+      const uint8_t* end = nullptr;
+      bool           ok  = true;
+      };
+
+    static bool     isEncodable(int type);
+    static bool     encodeValue(lua_State* L, int idx, std::string& out, bool& immutable, uint32_t depth, std::string& err);
+    static bool     encodeTable(lua_State* L, int idx, std::string& out, bool& immutable, uint32_t depth, std::string& err);
+    static bool     decodeValue(lua_State* L, Reader& r, uint32_t depth, std::string& err);
+    static uint64_t hashValue(lua_State* L, int idx, uint32_t depth);
+    static uint64_t mix(uint64_t h);
+
+    static void     writeVarint(std::string& out, uint64_t v);
+    static uint64_t readVarint(Reader& r);
+  };
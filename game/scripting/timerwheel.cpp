@@ -0,0 +1,76 @@
+#include "timerwheel.h"
+
+#include <algorithm>
+
+void TimerWheel::clear() {
+  for(auto& s:level0)
+    s.clear();
+  for(auto& l:levelN)
+    for(auto& s:l)
+      s.clear();
+  overflow.clear();
+  due.clear();
+  current = 0;
+  count   = 0;
+  }
+
+void TimerWheel::schedule(uint32_t id, Tick at) {
+  insert(Node{id,std::max(at,current+1)},current);
+  ++count;
+  }
+
+void TimerWheel::insert(const Node& e, Tick base) {
+  // 'base' is the last processed tick, or the start of the span that is being cascaded
+  const Tick delta = e.at-base;
+  if(delta<L0Size) {
+    level0[e.at & (L0Size-1)].push_back(e);
+    return;
+    }
+  for(uint32_t l=0; l<Levels; ++l) {
+    // slot of level l is cascaded at the start of its span, which is always ahead of 'base'
+    if(delta < (Tick(1)<<(shift(l)+LnBits))) {
+      levelN[l][(e.at>>shift(l)) & (LnSize-1)].push_back(e);
+      return;
+      }
+    }
+  overflow.push_back(e);
+  }
+
+void TimerWheel::cascade(std::vector<Node>& slot, Tick base) {
+  if(slot.empty())
+    return;
+  due.swap(slot);
+  for(auto& n:due)
+    insert(n,base);
+  due.clear();
+  }
+
+void TimerWheel::implAdvance(Tick to, const void* ctx, void (*func)(const void*, uint32_t, Tick)) {
+  std::vector<Node> fire;
+  while(current<to) {
+    if(count==0) {
+      // nothing to cascade or fire: jump
+      current = to;
+      break;
+      }
+
+    const Tick t = current+1;
+    if((t & (L0Size-1))==0) {
+      // slot 't' of level0 is not processed yet: entries due at 't' may land there
+      uint32_t top = 0;
+      while(top<Levels-1 && ((t>>shift(top)) & (LnSize-1))==0)
+        ++top;
+      if(top==Levels-1 && ((t>>shift(top)) & (LnSize-1))==0)
+        cascade(overflow,t);
+      for(int l=int(top); l>=0; --l)
+        cascade(levelN[l][(t>>shift(uint32_t(l))) & (LnSize-1)],t);
+      }
+
+    fire.swap(level0[t & (L0Size-1)]);
+    current = t;
+    count  -= fire.size();
+    for(auto& n:fire)
+      func(ctx,n.id,n.at);
+    fire.clear();
+    }
+  }
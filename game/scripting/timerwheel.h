@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Hierarchical timer wheel (256 + 3x64 slots, overflow list beyond ~18.6h at 1ms ticks).
+// Advancing costs one slot per tick plus a cascade every 256 ticks; only due entries
+// are touched. Entries can't be removed - owner skips cancelled ids when they fire.
+class TimerWheel final {
+  public:
+    using Tick = uint64_t;
+
+    void   clear(); // also rewinds the wheel to tick 0
+    Tick   now()  const { return current; }
+    size_t size() const { return count;   }
+
+    // entries in the past fire on the next tick
+    void   schedule(uint32_t id, Tick at);
+
+    // fires every entry due up to and including 'to': f(id, at)
+    // callback may schedule new entries
+    template<class F>
+    void   advance(Tick to, const F& f) {
+      implAdvance(to,&f,[](const void* ctx, uint32_t id, Tick at){
+        auto& f = *reinterpret_cast<const F*>(ctx);
+        f(id,at);
+        });
+      }
+
+  private:
+    static constexpr uint32_t L0Bits = 8;
+    static constexpr uint32_t LnBits = 6;
+    static constexpr uint32_t L0Size = 1u<<L0Bits;
+    static constexpr uint32_t LnSize = 1u<<LnBits;
+    static constexpr uint32_t Levels = 3;
+
+    struct Node {
+      uint32_t id = 0;
+      Tick     at = 0;
+      };
+
+    std::vector<Node> level0[L0Size];
+    std::vector<Node> levelN[Levels][LnSize];
+    std::vector<Node> overflow;
+    std::vector<Node> due;
+    Tick              current = 0;
+    size_t            count   = 0;
+
+    void insert(const Node& e, Tick base);
+    void cascade(std::vector<Node>& slot, Tick base);
+    void implAdvance(Tick to, const void* ctx, void(*func)(const void*, uint32_t, Tick));
+
+    static uint32_t shift(uint32_t level) { return L0Bits + level*LnBits; }
+  };
@@ -34,6 +34,7 @@ class AiQueue {
     void     load(Serialize& fin);
 
     size_t   size() const { return aiActions.size(); }
+    auto     front() const -> const AiAction* { return aiActions.empty() ? nullptr : &aiActions.front(); }
     void     clear();
     void     pushBack (AiAction&& a);
     void     pushFront(AiAction&& a);
@@ -0,0 +1,129 @@
+#include "npcindex.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "world/objects/npc.h"
+
+using namespace Tempest;
+
+void NpcIndex::clear() {
+  for(auto& c:cells)
+    for(auto npc:c.second)
+      npc->indexCell = NoCell;
+  cells.clear();
+  count = 0;
+  }
+
+void NpcIndex::add(Npc& npc) {
+  if(npc.indexCell!=NoCell)
+    return;
+  insert(npc,cellOf(npc.position()));
+  ++count;
+  }
+
+void NpcIndex::del(Npc& npc) {
+  if(npc.indexCell==NoCell)
+    return;
+  remove(npc,npc.indexCell);
+  npc.indexCell = NoCell;
+  --count;
+  }
+
+void NpcIndex::move(Npc& npc) {
+  if(npc.indexCell==NoCell)
+    return;
+  const uint64_t cell = cellOf(npc.position());
+  if(cell==npc.indexCell)
+    return;
+  remove(npc,npc.indexCell);
+  insert(npc,cell);
+  }
+
+void NpcIndex::insert(Npc& npc, uint64_t cell) {
+  cells[cell].push_back(&npc);
+  npc.indexCell = cell;
+  }
+
+void NpcIndex::remove(Npc& npc, uint64_t cell) {
+  auto it = cells.find(cell);
+  if(it==cells.end())
+    return;
+  auto& c = it->second;
+  for(size_t i=0; i<c.size(); ++i) {
+    if(c[i]!=&npc)
+      continue;
+    c[i] = c.back();
+    c.pop_back();
+    break;
+    }
+  if(c.empty())
+    cells.erase(it);
+  }
+
+void NpcIndex::implFind(const Vec3& p, float R, const void* ctx, void (*func)(const void*, Npc&)) const {
+  const float qR    = R*R;
+  auto        visit = [&](const std::vector<Npc*>& c) {
+    for(auto npc:c)
+      if((npc->position()-p).quadLength()<qR)
+        func(ctx,*npc);
+    };
+
+  const int32_t x0 = coord(p.x-R), x1 = coord(p.x+R);
+  const int32_t z0 = coord(p.z-R), z1 = coord(p.z+R);
+  const uint64_t span = uint64_t(int64_t(x1)-x0+1)*uint64_t(int64_t(z1)-z0+1);
+  if(span>=cells.size()) {
+    // query covers more cells, than there are occupied
+    for(auto& c:cells)
+      visit(c.second);
+    return;
+    }
+
+  for(int32_t cz=z0; cz<=z1; ++cz)
+    for(int32_t cx=x0; cx<=x1; ++cx) {
+      auto it = cells.find(key(cx,cz));
+      if(it!=cells.end())
+        visit(it->second);
+      }
+  }
+
+void NpcIndex::nearest(const Vec3& p, float R, size_t k, const Npc* exclude, std::vector<Npc*>& out) const {
+  out.clear();
+  if(k==0)
+    return;
+
+  find(p,R,[&out,exclude](Npc& npc){
+    if(&npc!=exclude)
+      out.push_back(&npc);
+    });
+
+  auto less = [&p](const Npc* a, const Npc* b) {
+    return (a->position()-p).quadLength() < (b->position()-p).quadLength();
+    };
+  if(out.size()>k) {
+    std::partial_sort(out.begin(),out.begin()+int(k),out.end(),less);
+    out.resize(k);
+    } else {
+    std::sort(out.begin(),out.end(),less);
+    }
+  }
+
+int32_t NpcIndex::coord(float v) {
+  const float c = std::floor(v/CellSize);
+  if(!(c>-float(1<<30)))
+    return -(1<<30);
+  if(!(c<float(1<<30)))
+    return (1<<30);
+  return int32_t(c);
+  }
+
+uint64_t NpcIndex::key(int32_t cx, int32_t cz) {
+  // biased, so that no valid cell maps to NoCell
+  const uint32_t bx = uint32_t(cx)+0x80000000u;
+  const uint32_t bz = uint32_t(cz)+0x80000000u;
+  return (uint64_t(bx)<<32) | uint64_t(bz);
+  }
+
+uint64_t NpcIndex::cellOf(const Vec3& p) {
+  return key(coord(p.x),coord(p.z));
+  }
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <Tempest/Point>
+
+class Npc;
+
+// Uniform XZ-grid over live npc's. Cell of each npc is cached in npc itself,
+// so moving within a cell costs a single compare.
+class NpcIndex final {
+  public:
+    static constexpr uint64_t NoCell = uint64_t(-1);
+
+    void   clear();
+    size_t size() const { return count; }
+
+    void   add (Npc& npc);
+    void   del (Npc& npc);
+    void   move(Npc& npc);
+
+    // callback must not add, remove or move npc's
+    template<class Func>
+    void   find(const Tempest::Vec3& p, float R, const Func& f) const {
+      implFind(p,R,&f,[](const void* ctx, Npc& npc){
+        auto& f = *reinterpret_cast<const Func*>(ctx);
+        f(npc);
+        });
+      }
+
+    // up to k npc's within R, sorted by distance
+    void   nearest(const Tempest::Vec3& p, float R, size_t k, const Npc* exclude, std::vector<Npc*>& out) const;
+
+  private:
+    static constexpr float CellSize = 1000.f;
+
+    std::unordered_map<uint64_t,std::vector<Npc*>> cells;
+    size_t                                         count = 0;
+
+    void            implFind(const Tempest::Vec3& p, float R, const void* ctx, void(*func)(const void*, Npc&)) const;
+    void            insert(Npc& npc, uint64_t cell);
+    void            remove(Npc& npc, uint64_t cell);
+
+    static int32_t  coord(float v);
+    static uint64_t key(int32_t cx, int32_t cz);
+    static uint64_t cellOf(const Tempest::Vec3& p);
+  };
@@ -393,6 +393,7 @@ bool Npc::setPosition(float ix, float iy, float iz) {
   z = iz;
   durtyTranform |= TR_Pos;
   physic.setPosition(Vec3{x,y,z});
+  owner.updateNpcIndex(*this);
   return true;
   }
 
@@ -405,6 +406,7 @@ void Npc::setViewPosition(const Tempest::Vec3& pos) {
   y = pos.y;
   z = pos.z;
   durtyTranform |= TR_Pos;
+  owner.updateNpcIndex(*this);
   }
 
 int Npc::aiOutputOrderId() const {
@@ -1813,16 +1815,14 @@ bool Npc::implAiFlee(uint64_t dt) {
   const WayPoint* wp      = nullptr;
   const float     maxDist = 5*100; // 5 meters
 
-  owner.findWayPoint(position(),[&](const WayPoint& p) {
-    if(p.useCounter()>0 || qDistTo(&p)>maxDist*maxDist)
-      return false;
-    if(p.underWater)
-      return false;
+  owner.detectWayPoint(Vec3(x,y+translateY(),z),maxDist,[&](const WayPoint& p) {
+    if(p.useCounter()>0 || p.underWater)
+      return;
+    if(wp!=nullptr && oth.qDistTo(&p)<=oth.qDistTo(wp))
+      return;
     if(!canRayHitPoint(p.position() + Vec3(0,10,0),true))
-      return false;
-    if(wp==nullptr || oth.qDistTo(&p)>oth.qDistTo(wp))
-      wp = &p;
-    return false;
+      return;
+    wp = &p;
     });
 
   if(go2.flag!=GT_Flee && go2.flag!=GT_No) {
@@ -2028,7 +2028,17 @@ void Npc::takeDrownDamage() {
 Npc *Npc::updateNearestEnemy() {
   if(aiPolicy!=NpcProcessPolicy::AiNormal)
     return nullptr;
+  nearestEnemy = findNearestEnemy();
+  return nearestEnemy;
+  }
+
+Npc* Npc::updateNearestBody() {
+  if(aiPolicy!=NpcProcessPolicy::AiNormal)
+    return nullptr;
+  return findNearestBody();
+  }
 
+Npc* Npc::findNearestEnemy() const {
   Npc*  ret  = nullptr;
   float dist = std::numeric_limits<float>::max();
   if(nearestEnemy!=nullptr &&
@@ -2047,14 +2057,10 @@ Npc *Npc::updateNearestEnemy() {
       dist = d;
       }
     });
-  nearestEnemy = ret;
-  return nearestEnemy;
+  return ret;
   }
 
-Npc* Npc::updateNearestBody() {
-  if(aiPolicy!=NpcProcessPolicy::AiNormal)
-    return nullptr;
-
+Npc* Npc::findNearestBody() const {
   Npc*  ret  = nullptr;
   float dist = std::numeric_limits<float>::max();
 
@@ -2206,6 +2212,18 @@ void Npc::tick(uint64_t dt) {
 
   assert(go2.flag!=GoToHint::GT_EnemyG && go2.flag!=GoToHint::GT_EnemyA);
 
+  if(lodSkipped>0) {
+    // time-sliced far npc: catch up with the skipped frames, capped at about 2 x period x frame time,
+    // so a frame spike while skipped doesn't turn into one long movement step
+    const uint64_t maxCatchUp = 2*uint64_t(lodSkipped+1)*dt;
+    dt         = std::min(dt+lodDt, maxCatchUp);
+    lodDt      = 0;
+    lodSkipped = 0;
+    // routine boundary passed while skipped: don't wait for the next loop call
+    if(aiState.started && aiState.eTime<=owner.time())
+      aiState.loopNextTime = std::min(aiState.loopNextTime, owner.tickCount());
+    }
+
   tickAnimationTags();
 
   if(!visual.pose().hasAnim())
@@ -2263,6 +2281,11 @@ void Npc::tick(uint64_t dt) {
   implAiTick(dt);
   }
 
+void Npc::skipTick(uint64_t dt) {
+  lodDt += dt;
+  lodSkipped++;
+  }
+
 bool Npc::prepareTurn() {
   const auto st = bodyStateMasked();
   if(interactive()==nullptr && (st==BS_WALK || st==BS_SNEAK)) {
@@ -2362,7 +2385,7 @@ void Npc::nextAiAction(AiQueue& queue, uint64_t dt) {
         break;
         }
       if(wayPath.last()!=act.point) {
-        wayPath     = owner.wayTo(*this,*act.point);
+        wayPath     = takePreparedPath(*act.point);
         auto wpoint = wayPath.pop();
 
         if(wpoint!=nullptr) {
@@ -4301,6 +4324,51 @@ void Npc::addRoutine(gtime s, gtime e, uint32_t callback, std::string_view point
     });
   }
 
+void Npc::routinePoints(std::vector<const WayPoint*>& out) const {
+  for(auto& i:routines)
+    if(i.point!=nullptr)
+      out.push_back(i.point);
+  }
+
+const WayPoint* Npc::pendingGoToPoint() const {
+  if(isInAir())
+    return nullptr;
+  auto act = aiQueueOverlay.front();
+  if(act==nullptr) {
+    // tick returns before aiQueue while casting or waiting
+    if(castLevel!=CS_NoCast)
+      return nullptr;
+    if(waitTime>=owner.tickCount() || aniWaitTime>=owner.tickCount() || outWaitTime>owner.tickCount())
+      return nullptr;
+    act = aiQueue.front();
+    }
+  if(act==nullptr || act->act!=AI_GoToPoint || act->point==nullptr || wayPath.last()==act->point)
+    return nullptr;
+  return act->point;
+  }
+
+void Npc::setPreparedPath(WayQuery&& q) {
+  preparedPath.end    = q.end;
+  preparedPath.from   = currentFp;
+  preparedPath.pos    = position();
+  preparedPath.fromFp = q.begin.size()==1 && q.begin[0]==currentFp;
+  preparedPath.time   = owner.tickCount();
+  preparedPath.path   = std::move(q.path);
+  }
+
+WayPath Npc::takePreparedPath(const WayPoint& end) {
+  auto p = std::move(preparedPath);
+  preparedPath = PreparedPath();
+  if(p.end==&end && p.from==currentFp && p.time==owner.tickCount()) {
+    // same inputs as World::prepareWay saw, so the same result
+    if(p.pos==position())
+      return std::move(p.path);
+    if(p.fromFp && currentFp!=&end && MoveAlgo::isClose(*this,*currentFp))
+      return std::move(p.path);
+    }
+  return owner.wayTo(*this,end);
+  }
+
 void Npc::excRoutine(size_t callback) {
   routines.clear();
   owner.script().invokeState(this,currentOther,currentVictim,callback);
@@ -4552,23 +4620,40 @@ bool Npc::canRayHitPoint(const Tempest::Vec3 pos, bool freeLos, float extRange)
     return false;
 
   static const double ref = std::cos(100*M_PI/180.0); // spec requires +-100 view angle range
-  const DynamicWorld* w   = owner.physic();
   // npc eyesight height
   auto head = visual.mapHeadBone();
   if(freeLos) {
-    return !w->ray(head, pos).hasCol;
+    return !senseRay(head, pos);
     }
 
   float dx  = x-pos.x, dz=z-pos.z;
   float dir = angleDir(dx,dz);
   float da  = float(M_PI)*(visual.viewDirection()-dir)/180.f;
   if(double(std::cos(da))<=ref) {
-    if(!w->ray(head, pos).hasCol)
+    if(!senseRay(head, pos))
       return true;
     }
   return false;
   }
 
+bool Npc::senseRay(const Vec3& from, const Vec3& to) const {
+  return sense.ray(owner.tickCount(),from,to,[this](const Vec3& a, const Vec3& b){
+    return owner.physic()->ray(a,b).hasCol;
+    });
+  }
+
+void Npc::thinkPerception(const Npc& pl, bool verify) {
+  sense.begin(owner.tickCount());
+  // same checks as perceptionProcess(pl), in the same order
+  if(hasPerc(PERC_ASSESSPLAYER))
+    canSenseNpc(pl,false);
+  if(hasPerc(PERC_ASSESSENEMY))
+    findNearestEnemy();
+  if(hasPerc(PERC_ASSESSBODY))
+    findNearestBody();
+  sense.end(verify);
+  }
+
 SensesBit Npc::canSenseNpc(const Npc &oth, bool freeLos, float extRange) const {
   // NOTE1: https://github.com/Try/OpenGothic/pull/589#issuecomment-2045897394
   // NOTE2: interacting with chest(lockpicking) or some MOBSI should not produce 'noise'
@@ -12,6 +12,7 @@
 #include "physics/dynamicworld.h"
 #include "world/aiqueue.h"
 #include "world/fplock.h"
+#include "world/sensecache.h"
 #include "world/waypath.h"
 
 #include <cstdint>
@@ -21,6 +22,7 @@
 
 class Interactive;
 class WayPoint;
+struct WayQuery;
 
 class Npc final {
   public:
@@ -112,6 +114,12 @@ class Npc final {
     void       setWalkMode(WalkBit m);
     auto       walkMode() const { return wlkMode; }
     void       tick(uint64_t dt);
+    // frame without a tick, see WorldObjects::isTickDue; the next tick catches up with its dt
+    void       skipTick(uint64_t dt);
+    uint32_t   skippedTicks() const { return lodSkipped; }
+    // frame stamp of WorldObjects::isTickDue; npc's inserted later in the frame are not marked
+    void       markTickSkipped(uint64_t frame) { lodSkipFrame = frame; }
+    bool       isTickSkipped(uint64_t frame) const { return lodSkipFrame==frame; }
     void       tickAnimationTags();
     bool       startClimb(JumpStatus jump);
 
@@ -306,6 +314,16 @@ class Npc final {
     void      setStateTime(int64_t time);
 
     void      addRoutine(gtime s, gtime e, uint32_t callback, std::string_view point);
+    void      routinePoints(std::vector<const WayPoint*>& out) const;
+
+    // target of an AI_GoToPoint the next tick will start, if its path is not known yet
+    auto      pendingGoToPoint() const -> const WayPoint*;
+    // path solved ahead of tick, see WorldObjects::prepareGoToPaths
+    void      setPreparedPath(WayQuery&& q);
+    // casts the rays perceptionProcess(pl) is going to ask for; read-only otherwise, so
+    // it may run on a worker. See WorldObjects::thinkPerception
+    void      thinkPerception(const Npc& pl, bool verify);
+    auto      senseStats() const -> const SenseCache::Stats& { return sense.stats(); }
     void      excRoutine(size_t callback);
     void      multSpeed(float s);
 
@@ -421,6 +439,15 @@ class Npc final {
       std::string_view wayPointName() const;
       };
 
+    struct PreparedPath final {
+      const WayPoint*  end    = nullptr;
+      const WayPoint*  from   = nullptr; // currentFp at prepare time
+      Tempest::Vec3    pos;
+      bool             fromFp = false;   // searched from currentFp alone: pos doesn't matter
+      uint64_t         time   = 0;       // valid within this world tick only
+      WayPath          path;
+      };
+
     enum TransformBit : uint8_t {
       TR_Pos  =1,
       TR_Rot  =1<<1,
@@ -499,10 +526,14 @@ class Npc final {
 
     bool      isPlayerEnabledState(const ::AiState& st) const;
     void      tickRoutine();
+    WayPath   takePreparedPath(const WayPoint& end);
     void      nextAiAction(AiQueue& queue, uint64_t dt);
     void      commitDamage();
     Npc*      updateNearestEnemy();
     Npc*      updateNearestBody();
+    Npc*      findNearestEnemy() const;
+    Npc*      findNearestBody() const;
+    bool      senseRay(const Tempest::Vec3& from, const Tempest::Vec3& to) const;
     bool      checkHealth(bool onChange, bool forceKill);
     void      onNoHealth(bool death, HitSound sndMask);
     bool      hasAutoroll() const;
@@ -617,6 +648,8 @@ class Npc final {
     const WayPoint*                currentFp      =nullptr;
     FpLock                         currentFpLock;
     WayPath                        wayPath;
+    PreparedPath                   preparedPath;
+    mutable SenseCache             sense;
 
     MoveAlgo                       mvAlgo;
     FightAlgo                      fghAlgo;
@@ -627,5 +660,12 @@ class Npc final {
 
     Sound                          sfxWeapon;
 
+    uint64_t                       indexCell = uint64_t(-1);
+
+    uint64_t                       lodDt        = 0;
+    uint32_t                       lodSkipped   = 0;
+    uint64_t                       lodSkipFrame = 0;
+
   friend class MoveAlgo;
+  friend class NpcIndex;
   };
@@ -0,0 +1,53 @@
+#include "sensecache.h"
+
+using namespace Tempest;
+
+void SenseCache::begin(uint64_t tick) {
+  rays.clear();
+  time   = tick;
+  verify = false;
+  }
+
+void SenseCache::end(bool v) {
+  st           = Stats();
+  st.thinkRays = uint32_t(rays.size());
+  verify       = v;
+  }
+
+const SenseCache::Ray* SenseCache::find(const Vec3& from, const Vec3& to) const {
+  for(auto& r:rays)
+    if(r.from==from && r.to==to)
+      return &r;
+  return nullptr;
+  }
+
+void SenseCache::record(const Vec3& from, const Vec3& to, bool hasCol) {
+  rays.push_back({from,to,hasCol});
+  ++st.misses;
+  if(verify) {
+    st.serialHash   = hash(st.serialHash,  from,to,hasCol);
+    st.parallelHash = hash(st.parallelHash,from,to,hasCol);
+    }
+  }
+
+void SenseCache::verifyHit(const Vec3& from, const Vec3& to, bool cached, bool fresh) {
+  if(fresh!=cached)
+    ++st.mismatches;
+  st.serialHash   = hash(st.serialHash,  from,to,fresh);
+  st.parallelHash = hash(st.parallelHash,from,to,cached);
+  }
+
+uint64_t SenseCache::hash(uint64_t h, const Vec3& from, const Vec3& to, bool hasCol) {
+  auto mix = [&h](const void* data, size_t size) {
+    auto b = reinterpret_cast<const uint8_t*>(data);
+    for(size_t i=0; i<size; ++i) {
+      h ^= b[i];
+      h *= 1099511628211ull;
+      }
+    };
+  const uint8_t col = hasCol ? 1 : 0;
+  mix(&from,sizeof(from));
+  mix(&to,  sizeof(to));
+  mix(&col, sizeof(col));
+  return h;
+  }
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <Tempest/Point>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Perception rays of one npc, cast ahead of its perception scripts (see WorldObjects::thinkPerception).
+// Within the tick they were cast for, a ray with identical end points is reused instead of cast again;
+// any other ray is cast on demand. Ray results depend on the end points only, so reuse is exact.
+class SenseCache final {
+  public:
+    struct Stats final {
+      uint32_t  thinkRays  = 0; // cast ahead
+      uint32_t  hits       = 0; // of them, used later in the same tick
+      uint32_t  misses     = 0; // cast later, as the inputs have changed
+      uint32_t  mismatches = 0; // verify mode: cached result differs from a fresh ray
+      uint64_t  serialHash   = 14695981039346656037ull; // verify mode: FNV-1a of the rays as a serial tick sees them
+      uint64_t  parallelHash = 14695981039346656037ull; // ... and as the commit pass used them
+      };
+
+    // think phase: rays cast until end() are kept for 'tick'
+    void         begin(uint64_t tick);
+    void         end(bool verify);
+    auto         stats() const -> const Stats& { return st; }
+
+    // 'cast' is bool(from,to), true on collision
+    template<class Cast>
+    bool         ray(uint64_t tick, const Tempest::Vec3& from, const Tempest::Vec3& to, const Cast& cast);
+
+  private:
+    struct Ray final {
+      Tempest::Vec3 from, to;
+      bool          hasCol = false;
+      };
+
+    const Ray*      find(const Tempest::Vec3& from, const Tempest::Vec3& to) const;
+    void            record(const Tempest::Vec3& from, const Tempest::Vec3& to, bool hasCol);
+    void            verifyHit(const Tempest::Vec3& from, const Tempest::Vec3& to, bool cached, bool fresh);
+    static uint64_t hash(uint64_t h, const Tempest::Vec3& from, const Tempest::Vec3& to, bool hasCol);
+
+    std::vector<Ray> rays;
+    uint64_t         time   = uint64_t(-1); // rays are valid within this tick
+    bool             verify = false;
+    Stats            st;
+  };
+
+template<class Cast>
+bool SenseCache::ray(uint64_t tick, const Tempest::Vec3& from, const Tempest::Vec3& to, const Cast& cast) {
+  if(time!=tick)
+    return cast(from,to);
+  if(auto r = find(from,to)) {
+    ++st.hits;
+    if(verify)
+      verifyHit(from,to,r->hasCol,cast(from,to));
+    return r->hasCol;
+    }
+  const bool hasCol = cast(from,to);
+  record(from,to,hasCol);
+  return hasCol;
+  }
@@ -2,6 +2,7 @@
 
 #include <Tempest/Log>
 #include <algorithm>
+#include <chrono>
 #include <limits>
 
 #include "utils/dbgpainter.h"
@@ -10,6 +11,41 @@
 
 using namespace Tempest;
 
+namespace {
+// A* state of one query; one per thread, so wayTo can run on workers
+struct PathScratch {
+  struct Node {
+    int32_t         g     = 0;
+    uint16_t        gen   = 0;
+    uint16_t        begin = 0; // ==gen for the begin points of the query
+    const WayPoint* next  = nullptr; // towards the destination
+    };
+  struct Open {
+    int32_t  f  = 0;
+    int32_t  g  = 0;
+    uint32_t id = 0;
+    };
+  const void*       owner = nullptr;
+  uint16_t          gen   = 0;
+  std::vector<Node> nodes;
+  std::vector<Open> open;
+
+  // a node is valid only with gen==this->gen
+  void begin(const void* matrix, size_t size) {
+    gen++;
+    if(gen==0 || owner!=matrix || nodes.size()!=size) {
+      // new cycle
+      nodes.assign(size,Node());
+      owner = matrix;
+      gen   = 1;
+      }
+    open.clear();
+    }
+  };
+
+thread_local PathScratch pathScratch;
+}
+
 WayMatrix::WayMatrix(World &world, const zenkit::WayNet& dat)
   :world(world) {
 
@@ -25,9 +61,6 @@ WayMatrix::WayMatrix(World &world, const zenkit::WayNet& dat)
     e.b = size_t(std::distance(dat.points.begin(), std::find(dat.points.begin(), dat.points.end(), dat.edges[i].second)));
     edges[i] = e;
     }
-
-  stk[0].reserve(256);
-  stk[1].reserve(256);
   }
 
 void WayMatrix::buildIndex() {
@@ -39,12 +72,12 @@ void WayMatrix::buildIndex() {
     return a->name<b->name;
     });
 
-  for(auto& i:freePoints)
-    fpInd.push_back(&i);
-
-  std::sort(fpInd.begin(),fpInd.end(),[](const WayPoint* a,const WayPoint* b){
-    return a->pos.x < b->pos.x;
-    });
+  std::vector<const WayPoint*> pts;
+  for(auto& i:wayPoints)
+    pts.push_back(&i);
+  wayIndex.build(pts);
+  nextIndex.build(std::vector<const WayPoint*>(indexPoints.begin(),indexPoints.end()));
+  fpIndex.clear();
 
   for(auto& i:edges) {
     if(i.a<wayPoints.size() && i.b<wayPoints.size()) {
@@ -57,46 +90,13 @@ void WayMatrix::buildIndex() {
     }
 
   calculateLadderPoints();
-  }
-
-const WayPoint *WayMatrix::findWayPoint(const Vec3& at, const std::function<bool(const WayPoint&)>& filter) const {
-  const WayPoint* ret =nullptr;
-  float           dist=std::numeric_limits<float>::max();
-  for(auto& w:wayPoints) {
-    if(!filter(w))
-      continue;
-    auto  dp0 = at-w.position();
-    float l0  = dp0.quadLength();
-
-    if(l0<dist){
-      ret  = &w;
-      dist = l0;
-      }
-    }
-  return ret;
-  }
-
-const WayPoint *WayMatrix::findFreePoint(const Vec3& at, std::string_view name, const std::function<bool(const WayPoint&)>& filter) const {
-  auto&  index = findFpIndex(name);
-  return findFreePoint(at.x,at.y,at.z,index,filter);
+  resetPathCache();
   }
 
 const WayPoint *WayMatrix::findNextPoint(const Vec3& at) const {
-  const WayPoint* ret   = nullptr;
-  float           dist  = distanceThreshold;
-
-  dist*=dist;
-  for(auto pw:indexPoints){
-    auto& w  = *pw;
-    auto  dp = w.position()-at;
-    float l  = dp.quadLength();
-
-    if(l<dist && !w.isLocked()) {
-      ret  = &w;
-      dist = l;
-      }
-    }
-  return ret;
+  return nextIndex.nearest(at, distanceThreshold, [](const WayPoint& w){
+    return !w.isLocked();
+    });
   }
 
 void WayMatrix::addFreePoint(const Vec3& pos, const Vec3& dir, std::string_view name) {
@@ -248,59 +248,48 @@ const WayMatrix::FpIndex &WayMatrix::findFpIndex(std::string_view name) const {
     return *it;
     }
 
-  FpIndex id;
-  id.key = name;
+  std::vector<const WayPoint*> pts;
   for(auto& w:freePoints){
     if(!w.checkName(name))
       continue;
-    id.index.push_back(&w);
+    pts.push_back(&w);
     }
-  // TODO: good index, not sort by 'x' :)
-  std::sort(id.index.begin(),id.index.end(),[](const WayPoint* a,const WayPoint* b){
-    return a->pos.x < b->pos.x;
-    });
+
+  FpIndex id;
+  id.key = name;
+  id.index.build(pts);
 
   it = fpIndex.insert(it,std::move(id));
   return *it;
   }
 
-const WayPoint *WayMatrix::findFreePoint(float x, float y, float z, const FpIndex& ind,
-                                         const std::function<bool(const WayPoint&)>& filter) const {
-  float R = distanceThreshold;
-  auto b = std::lower_bound(ind.index.begin(),ind.index.end(), x-R ,[](const WayPoint *a, float b){
-    return a->pos.x < b;
-    });
-  auto e = std::upper_bound(ind.index.begin(),ind.index.end(), x+R ,[](float a,const WayPoint *b){
-    return a < b->pos.x;
-    });
+size_t WayMatrix::pointId(const WayPoint& p) const {
+  intptr_t id = std::distance<const WayPoint*>(wayPoints.data(),&p);
+  if(id<0 || size_t(id)>=wayPoints.size())
+    return size_t(-1);
+  return size_t(id);
+  }
 
-  const WayPoint* ret=nullptr;
-  auto  count = std::distance(b,e);(void) count;
-  float dist  = R*R;
-  for(auto i=b;i!=e;++i){
-    auto& w  = **i;
-    if(!w.isFreePoint())
-      continue;
-    float dx = w.pos.x-x;
-    float dy = w.pos.y-y;
-    float dz = w.pos.z-z;
-    float l  = dx*dx+dy*dy+dz*dz;
-    if(l>dist)
-      continue;
-    if(!filter(w))
-      continue;
-    ret  = &w;
-    dist = l;
-    }
-  return ret;
+void WayMatrix::resetPathCache() const {
+  std::lock_guard<std::mutex> guard(pathCacheSync);
+  pathCache.clear();
+  pathCacheIds.clear();
+  }
+
+WayMatrix::PathStats WayMatrix::pathStats() const {
+  PathStats st;
+  st.queries   = statQueries.load();
+  st.cacheHits = statCacheHits.load();
+  st.expanded  = statExpanded.load();
+  return st;
   }
 
 WayPath WayMatrix::wayTo(const WayPoint** begin, size_t beginSz, const Tempest::Vec3 exactBegin, const WayPoint& end) const {
   if(beginSz==0)
     return WayPath();
 
-  intptr_t endId = std::distance<const WayPoint*>(&wayPoints[0],&end);
-  if(endId<0 || size_t(endId)>=wayPoints.size()){
+  const size_t endId = pointId(end);
+  if(endId==size_t(-1)){
     if(!end.isConnected()) {
       // free-point
       WayPath ret;
@@ -310,75 +299,137 @@ WayPath WayMatrix::wayTo(const WayPoint** begin, size_t beginSz, const Tempest::
     return WayPath();
     }
 
-  pathGen++;
-  if(pathGen==1){
-    // new cycle
-    for(auto& i:wayPoints)
-      i.pathGen=0;
+  statQueries.fetch_add(1,std::memory_order_relaxed);
+  if(beginSz>1)
+    return findPath(begin,beginSz,exactBegin,endId);
+
+  // with one begin point the path doesn't depend on exactBegin
+  const size_t beginId = pointId(*begin[0]);
+  if(beginId==size_t(-1))
+    return findPath(begin,beginSz,exactBegin,endId);
+
+  const uint64_t key = (uint64_t(beginId)<<32) | uint64_t(endId);
+  {
+  std::lock_guard<std::mutex> guard(pathCacheSync);
+  auto it = pathCacheIds.find(key);
+  if(it!=pathCacheIds.end()) {
+    statCacheHits.fetch_add(1,std::memory_order_relaxed);
+    pathCache.splice(pathCache.begin(),pathCache,it->second);
+    return it->second->path;
+    }
+  }
+
+  // searched without the lock: two threads may solve the same pair, the second insert is skipped
+  WayPath ret = findPath(begin,beginSz,exactBegin,endId);
+
+  std::lock_guard<std::mutex> guard(pathCacheSync);
+  if(pathCacheIds.find(key)!=pathCacheIds.end())
+    return ret;
+  if(pathCache.size()>=PathCacheSize) {
+    pathCacheIds.erase(pathCache.back().key);
+    pathCache.pop_back();
     }
+  pathCache.push_front(CachedPath{key,ret});
+  pathCacheIds[key] = pathCache.begin();
+  return ret;
+  }
 
-  std::vector<const WayPoint*> *front=&stk[0], *back=&stk[1];
-  stk[0].clear();
-  stk[1].clear();
+// A* from the destination back to the begin points. Cost of a begin point is its path length
+// plus the straight distance to exactBegin, so that distance is the heuristic of every node
+// and a begin point's f is exactly its total cost: the search stops once no open node can beat
+// the best begin point found
+WayPath WayMatrix::findPath(const WayPoint** begin, size_t beginSz, const Tempest::Vec3& exactBegin, size_t endId) const {
+  auto& sc    = pathScratch;
+  auto& nodes = sc.nodes;
+  auto& open  = sc.open;
+  sc.begin(this,wayPoints.size());
 
-  end.pathLen = 0;
-  end.pathGen = pathGen;
-  front->push_back(&end);
+  for(size_t i=0; i<beginSz; ++i) {
+    const size_t id = pointId(*begin[i]);
+    if(id!=size_t(-1))
+      nodes[id].begin = sc.gen;
+    }
 
-  while(front->size()>0) {
-    bool done = true;
-    for(size_t i=0; i<beginSz; ++i)
-      if(begin[i]->pathGen!=pathGen) {
-        done = false;
-        break;
-        }
-    if(done)
+  auto heuristic = [&exactBegin](const WayPoint& w) {
+    return int32_t((exactBegin - w.position()).length());
+    };
+  auto cmp = [](const PathScratch::Open& a, const PathScratch::Open& b) {
+    return a.f>b.f;
+    };
+
+  auto& endNode = nodes[endId];
+  endNode.g    = 0;
+  endNode.gen  = sc.gen;
+  endNode.next = nullptr;
+  open.push_back(PathScratch::Open{heuristic(wayPoints[endId]),0,uint32_t(endId)});
+
+  const WayPoint* first    = nullptr;
+  int32_t         bestLen  = std::numeric_limits<int32_t>::max();
+  uint64_t        expanded = 0;
+  while(!open.empty()) {
+    std::pop_heap(open.begin(),open.end(),cmp);
+    const auto top = open.back();
+    open.pop_back();
+    if(top.f>=bestLen)
       break;
 
-    for(auto& wp:*front) {
-      int32_t l0 = wp->pathLen;
-
-      for(auto i:wp->connections()){
-        auto& w  = *i.point;
-        int32_t l1 = l0+i.len;
-        if(w.pathGen!=pathGen || w.pathLen>l1){
-          w.pathLen = l1;
-          w.pathGen = pathGen;
-          back->push_back(&w);
-          }
-        }
+    auto& node = nodes[top.id];
+    if(top.g!=node.g)
+      continue; // reached again with a shorter path
+    ++expanded;
+
+    const WayPoint& wp = wayPoints[top.id];
+    if(node.begin==sc.gen) {
+      bestLen = top.f;
+      first   = &wp;
       }
-    std::swap(front,back);
-    back->clear();
-    }
 
-  const WayPoint* first = begin[0];
-  for(size_t i=0; i<beginSz; ++i) {
-    int32_t iLen = begin[i]->pathLen + int((exactBegin - begin[i]->position()).length());
-    int32_t fLen = first   ->pathLen + int((exactBegin - first   ->position()).length());
-    if(iLen<fLen)
-      first = begin[i];
+    for(auto& i:wp.connections()) {
+      const size_t id = pointId(*i.point);
+      if(id==size_t(-1))
+        continue;
+      const int32_t g = node.g+i.len;
+      auto&         n = nodes[id];
+      if(n.gen==sc.gen && n.g<=g)
+        continue;
+      n.g    = g;
+      n.gen  = sc.gen;
+      n.next = &wp;
+      open.push_back(PathScratch::Open{g+heuristic(*i.point),g,uint32_t(id)});
+      std::push_heap(open.begin(),open.end(),cmp);
+      }
     }
+  statExpanded.fetch_add(expanded,std::memory_order_relaxed);
+
+  if(first==nullptr)
+    return WayPath();
 
   WayPath ret;
-  ret.add(*first);
-  const WayPoint* current = first;
-  while(current!=&end) {
-    int32_t l0 = current->pathLen, l1=l0;
-
-    const WayPoint* next=nullptr;
-    for(auto i:current->connections()){
-      if(i.point->pathGen==pathGen && i.point->pathLen+i.len<=l0 && i.point->pathLen<l1){
-        next = i.point;
-        l1   = i.point->pathLen;
-        }
+  for(const WayPoint* current=first; current!=nullptr; current=nodes[pointId(*current)].next)
+    ret.add(*current);
+  ret.reverse();
+  return ret;
+  }
+
+WayMatrix::Benchmark WayMatrix::benchmark(const std::vector<std::pair<const WayPoint*,const WayPoint*>>& routes) const {
+  Benchmark ret;
+  resetPathCache();
+
+  const uint64_t expanded0 = statExpanded.load();
+  for(int pass=0; pass<2; ++pass) {
+    const auto t0 = std::chrono::steady_clock::now();
+    for(auto& r:routes) {
+      const WayPoint* from = r.first;
+      auto path = wayTo(&from,1,from->position(),*r.second);
+      if(pass==0 && path.first()==nullptr)
+        ++ret.noPath;
       }
-    if(next==nullptr)
-      return WayPath();
-    ret.add(*next);
-    current=next;
+    const auto   t1 = std::chrono::steady_clock::now();
+    const double us = std::chrono::duration<double,std::micro>(t1-t0).count();
+    (pass==0 ? ret.coldUs : ret.warmUs) = routes.empty() ? 0 : us/double(routes.size());
     }
 
-  ret.reverse();
+  ret.queries  = routes.size();
+  ret.expanded = statExpanded.load()-expanded0;
   return ret;
   }
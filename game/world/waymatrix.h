@@ -6,21 +6,49 @@
 #include <zenkit/world/WayNet.hh>
 
 #include <vector>
-#include <functional>
+#include <atomic>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <unordered_map>
 
 #include "waypath.h"
 #include "waypoint.h"
+#include "waypointindex.h"
 
 class World;
 class DbgPainter;
 
+// path request of World::wayTo, see World::prepareWay
+struct WayQuery {
+  std::vector<const WayPoint*> begin;
+  Tempest::Vec3                exactBegin;
+  const WayPoint*              end = nullptr;
+  WayPath                      path;
+  };
+
 class WayMatrix final {
   public:
     WayMatrix(World& owner, const zenkit::WayNet& dat);
 
-    const WayPoint* findWayPoint (const Tempest::Vec3& at, const std::function<bool(const WayPoint&)>& filter) const;
-    const WayPoint* findFreePoint(const Tempest::Vec3& at, std::string_view name, const std::function<bool(const WayPoint&)>& filter) const;
+    // nearest waypoint, that passes filter; filter is called in increasing distance order
+    template<class Filter>
+    const WayPoint* findWayPoint (const Tempest::Vec3& at, const Filter& filter) const {
+      return wayIndex.nearest(at, std::numeric_limits<float>::max(), filter);
+      }
+    template<class Filter>
+    const WayPoint* findFreePoint(const Tempest::Vec3& at, std::string_view name, const Filter& filter) const {
+      auto& ind = findFpIndex(name);
+      return ind.index.nearest(at, distanceThreshold, [&filter](const WayPoint& w){
+        return w.isFreePoint() && filter(w);
+        });
+      }
     const WayPoint* findNextPoint(const Tempest::Vec3& at) const;
+    // visits waypoints within R
+    template<class Func>
+    void            detectWayPoint(const Tempest::Vec3& at, float R, const Func& f) const {
+      wayIndex.find(at, R, f);
+      }
 
     void            addFreePoint (const Tempest::Vec3& pos, const Tempest::Vec3& dir, std::string_view name);
     void            addStartPoint(const Tempest::Vec3& pos, const Tempest::Vec3& dir, std::string_view name);
@@ -35,6 +63,24 @@ class WayMatrix final {
 
     WayPath         wayTo(const WayPoint** begin, size_t beginSz, const Tempest::Vec3 exactBegin, const WayPoint& end) const;
 
+    struct PathStats {
+      uint64_t queries   = 0;
+      uint64_t cacheHits = 0;
+      uint64_t expanded  = 0; // nodes taken from the open list
+      };
+    PathStats        pathStats() const;
+    void             resetPathCache() const;
+
+    // replays (from, to) requests twice: with an empty path cache and with a warm one
+    struct Benchmark {
+      size_t   queries  = 0;
+      size_t   noPath   = 0;
+      uint64_t expanded = 0;
+      double   coldUs   = 0; // per query
+      double   warmUs   = 0;
+      };
+    Benchmark        benchmark(const std::vector<std::pair<const WayPoint*,const WayPoint*>>& routes) const;
+
   private:
     struct WayEdge {
       size_t a = 0;
@@ -57,21 +103,35 @@ class WayMatrix final {
     std::vector<WayPoint>  freePoints, startPoints;
     std::vector<WayPoint*> indexPoints;
 
-    std::vector<WayPoint*> fpInd;
+    WayPointIndex          wayIndex;  // wayPoints
+    WayPointIndex          nextIndex; // indexPoints
 
     struct FpIndex {
-      std::string                  key;
-      std::vector<const WayPoint*> index;
+      std::string          key;
+      WayPointIndex        index;
       };
     mutable std::vector<FpIndex>          fpIndex;
 
-    mutable uint16_t                      pathGen=0;
-    mutable std::vector<const WayPoint*>  stk[2];
+    // wayTo is reentrant: the A* state lives in a per-thread PathScratch (see waymatrix.cpp)
+    mutable std::atomic<uint64_t>         statQueries{0};
+    mutable std::atomic<uint64_t>         statCacheHits{0};
+    mutable std::atomic<uint64_t>         statExpanded{0};
+
+    // single-begin results, most recently used first. Routing ignores waypoint locks,
+    // so only a rebuild of the waynet invalidates them
+    struct CachedPath {
+      uint64_t key = 0;
+      WayPath  path;
+      };
+    static constexpr size_t               PathCacheSize = 1024;
+    mutable std::mutex                    pathCacheSync;
+    mutable std::list<CachedPath>         pathCache;
+    mutable std::unordered_map<uint64_t,std::list<CachedPath>::iterator> pathCacheIds;
 
     void                   adjustWaypoints(std::vector<WayPoint> &wp);
+    size_t                 pointId(const WayPoint& p) const;
+    WayPath                findPath(const WayPoint** begin, size_t beginSz, const Tempest::Vec3& exactBegin, size_t endId) const;
     void                   calculateLadderPoints();
 
     const FpIndex&         findFpIndex(std::string_view name) const;
-    const WayPoint*        findFreePoint(float x, float y, float z, const FpIndex &ind,
-                                         const std::function<bool(const WayPoint&)>& filter) const;
   };
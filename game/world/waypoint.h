@@ -40,10 +40,6 @@ class WayPoint final {
       int32_t   len  =0;
       };
 
-    // TODO: beautify
-    mutable int32_t  pathLen = std::numeric_limits<int32_t>::max();
-    mutable uint16_t pathGen = 0;
-
     float qDistTo(float x,float y,float z) const;
 
     void connect(WayPoint& w);
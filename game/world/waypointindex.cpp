@@ -0,0 +1,148 @@
+#include "waypointindex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "waypoint.h"
+
+using namespace Tempest;
+
+void WayPointIndex::clear() {
+  cellBegin.clear();
+  points.clear();
+  cellSize = MinCellSize;
+  dim[0] = dim[1] = dim[2] = 0;
+  }
+
+void WayPointIndex::build(const std::vector<const WayPoint*>& pts) {
+  clear();
+  if(pts.empty())
+    return;
+
+  Vec3 lo = pts[0]->pos, hi = lo;
+  for(auto w:pts) {
+    lo.x = std::min(lo.x,w->pos.x); hi.x = std::max(hi.x,w->pos.x);
+    lo.y = std::min(lo.y,w->pos.y); hi.y = std::max(hi.y,w->pos.y);
+    lo.z = std::min(lo.z,w->pos.z); hi.z = std::max(hi.z,w->pos.z);
+    }
+  origin = lo;
+
+  // keep grid sparse enough, so empty cells don't dominate nearest-queries
+  const size_t maxCells = std::max<size_t>(pts.size()*CellsPerPoint, 64);
+  const Vec3   ext      = hi-lo;
+  while(true) {
+    dim[0] = int32_t(ext.x/cellSize)+1;
+    dim[1] = int32_t(ext.y/cellSize)+1;
+    dim[2] = int32_t(ext.z/cellSize)+1;
+    if(size_t(dim[0])*size_t(dim[1])*size_t(dim[2])<=maxCells)
+      break;
+    cellSize *= 2.f;
+    }
+
+  const size_t       cells = size_t(dim[0])*size_t(dim[1])*size_t(dim[2]);
+  std::vector<size_t> id(pts.size());
+  cellBegin.assign(cells+1,0);
+  for(size_t i=0; i<pts.size(); ++i) {
+    auto& p = pts[i]->pos;
+    id[i] = cellId(coord(p.x,0),coord(p.y,1),coord(p.z,2));
+    cellBegin[id[i]+1]++;
+    }
+  for(size_t i=1; i<cellBegin.size(); ++i)
+    cellBegin[i] += cellBegin[i-1];
+
+  std::vector<uint32_t> fill(cellBegin.begin(),cellBegin.end()-1);
+  points.resize(pts.size());
+  for(size_t i=0; i<pts.size(); ++i)
+    points[fill[id[i]]++] = pts[i];
+  }
+
+int32_t WayPointIndex::coord(float v, int axis) const {
+  const float o = (axis==0 ? origin.x : (axis==1 ? origin.y : origin.z));
+  const float c = std::floor((v-o)/cellSize);
+  if(!(c>0.f))
+    return 0;
+  if(c>=float(dim[axis]-1))
+    return dim[axis]-1;
+  return int32_t(c);
+  }
+
+size_t WayPointIndex::cellId(int32_t cx, int32_t cy, int32_t cz) const {
+  return (size_t(cz)*size_t(dim[1]) + size_t(cy))*size_t(dim[0]) + size_t(cx);
+  }
+
+void WayPointIndex::implFind(const Vec3& p, float R, const void* ctx, void (*func)(const void*, const WayPoint&)) const {
+  if(points.empty())
+    return;
+  const float   qR = R*R;
+  const int32_t x0 = coord(p.x-R,0), x1 = coord(p.x+R,0);
+  const int32_t y0 = coord(p.y-R,1), y1 = coord(p.y+R,1);
+  const int32_t z0 = coord(p.z-R,2), z1 = coord(p.z+R,2);
+  for(int32_t z=z0; z<=z1; ++z)
+    for(int32_t y=y0; y<=y1; ++y) {
+      const size_t row = cellId(0,y,z);
+      for(uint32_t i=cellBegin[row+size_t(x0)]; i<cellBegin[row+size_t(x1)+1]; ++i) {
+        auto& w = *points[i];
+        if((w.pos-p).quadLength()<=qR)
+          func(ctx,w);
+        }
+      }
+  }
+
+const WayPoint* WayPointIndex::implNearest(const Vec3& p, float R, const void* ctx, bool (*func)(const void*, const WayPoint&)) const {
+  if(points.empty())
+    return nullptr;
+
+  const int32_t at[3] = {coord(p.x,0), coord(p.y,1), coord(p.z,2)};
+  int32_t       maxR  = 0;
+  for(int i=0; i<3; ++i)
+    maxR = std::max(maxR, std::max(at[i], dim[i]-1-at[i]));
+
+  const float qR = R*R;
+  std::vector<std::pair<float,const WayPoint*>> cand;
+
+  auto visit = [&](int32_t x, int32_t y, int32_t z) {
+    const size_t c = cellId(x,y,z);
+    for(uint32_t i=cellBegin[c]; i<cellBegin[c+1]; ++i) {
+      const float l = (points[i]->pos-p).quadLength();
+      if(l<=qR)
+        cand.emplace_back(l,points[i]);
+      }
+    };
+  auto less = [](const std::pair<float,const WayPoint*>& a, const std::pair<float,const WayPoint*>& b){
+    return a.first<b.first;
+    };
+
+  // shells of cells around p: every point of shell r is at least (r-1)*cellSize away,
+  // so after shell r candidates up to r*cellSize can be tested in final order
+  for(int32_t r=0; r<=maxR && float(r-1)*cellSize<=R; ++r) {
+    const int32_t y0 = std::max(at[1]-r,0), y1 = std::min(at[1]+r,dim[1]-1);
+    const int32_t z0 = std::max(at[2]-r,0), z1 = std::min(at[2]+r,dim[2]-1);
+    for(int32_t z=z0; z<=z1; ++z)
+      for(int32_t y=y0; y<=y1; ++y) {
+        if(std::abs(y-at[1])==r || std::abs(z-at[2])==r) {
+          const int32_t x0 = std::max(at[0]-r,0), x1 = std::min(at[0]+r,dim[0]-1);
+          for(int32_t x=x0; x<=x1; ++x)
+            visit(x,y,z);
+          continue;
+          }
+        if(at[0]-r>=0)
+          visit(at[0]-r,y,z);
+        if(at[0]+r<dim[0])
+          visit(at[0]+r,y,z);
+        }
+
+    std::sort(cand.begin(),cand.end(),less);
+    const float safe  = float(r)*cellSize;
+    size_t      count = 0;
+    for(; count<cand.size() && cand[count].first<=safe*safe; ++count)
+      if(func(ctx,*cand[count].second))
+        return cand[count].second;
+    cand.erase(cand.begin(),cand.begin()+ptrdiff_t(count));
+    }
+
+  for(auto& c:cand)
+    if(func(ctx,*c.second))
+      return c.second;
+  return nullptr;
+  }
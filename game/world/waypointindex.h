@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <Tempest/Point>
+
+class WayPoint;
+
+// Uniform 3D-grid over static waypoints, built once per waynet. Cells are stored densely:
+// points of cell i are points[cellBegin[i]..cellBegin[i+1]).
+class WayPointIndex final {
+  public:
+    void   clear();
+    void   build(const std::vector<const WayPoint*>& pts);
+    size_t size() const { return points.size(); }
+
+    // visits every point within R
+    template<class Func>
+    void   find(const Tempest::Vec3& p, float R, const Func& f) const {
+      implFind(p,R,&f,[](const void* ctx, const WayPoint& wp){
+        auto& f = *reinterpret_cast<const Func*>(ctx);
+        f(wp);
+        });
+      }
+
+    // nearest point within R, that passes filter. Candidates are tested in increasing
+    // distance order, so filter is not called for points behind the first match
+    template<class Func>
+    const WayPoint* nearest(const Tempest::Vec3& p, float R, const Func& filter) const {
+      return implNearest(p,R,&filter,[](const void* ctx, const WayPoint& wp) -> bool {
+        auto& f = *reinterpret_cast<const Func*>(ctx);
+        return f(wp);
+        });
+      }
+
+  private:
+    static constexpr float  MinCellSize = 1000.f;
+    static constexpr size_t CellsPerPoint = 8;
+
+    Tempest::Vec3                origin;
+    float                        cellSize = MinCellSize;
+    int32_t                      dim[3]   = {};
+    std::vector<uint32_t>        cellBegin;
+    std::vector<const WayPoint*> points;
+
+    void            implFind(const Tempest::Vec3& p, float R, const void* ctx, void(*func)(const void*, const WayPoint&)) const;
+    const WayPoint* implNearest(const Tempest::Vec3& p, float R, const void* ctx, bool(*func)(const void*, const WayPoint&)) const;
+
+    int32_t         coord(float v, int axis) const;
+    size_t          cellId(int32_t cx, int32_t cy, int32_t cz) const;
+  };
@@ -880,10 +880,6 @@ const WayPoint* World::findWayPoint(const Tempest::Vec3& pos) const {
   return wmatrix->findWayPoint(pos,[](const WayPoint&){ return true; });
   }
 
-const WayPoint* World::findWayPoint(const Tempest::Vec3& pos, const std::function<bool(const WayPoint&)>& f) const {
-  return wmatrix->findWayPoint(pos,f);
-  }
-
 const WayPoint* World::findWayPoint(const Tempest::Vec3& pos, std::string_view name) const {
   return wmatrix->findWayPoint(pos,[name](const WayPoint& wp) -> bool {
     if(wp.isLocked())
@@ -974,25 +970,45 @@ void World::detectNpc(const Tempest::Vec3& p, const float r, const std::function
   wobj.detectNpc(p.x,p.y,p.z,r,f);
   }
 
+void World::findNearestNpcs(const Tempest::Vec3& p, const float r, size_t k, const Npc* exclude, std::vector<Npc*>& out) const {
+  wobj.findNearestNpcs(p,r,k,exclude,out);
+  }
+
+void World::updateNpcIndex(Npc& npc) {
+  wobj.updateNpcIndex(npc);
+  }
+
 void World::detectItem(const Tempest::Vec3& p, const float r, const std::function<void(Item&)>& f) {
   wobj.detectItem(p.x,p.y,p.z,r,f);
   }
 
 WayPath World::wayTo(const Npc &npc, const WayPoint &end) const {
+  WayQuery q;
+  if(prepareWay(npc,end,q))
+    solveWay(q);
+  return std::move(q.path);
+  }
+
+bool World::prepareWay(const Npc& npc, const WayPoint& end, WayQuery& q) const {
   auto npcPos = npc.position();
   npcPos.y += npc.translateY();
 
+  q.begin.clear();
+  q.path.clear();
+  q.exactBegin = npcPos;
+  q.end        = &end;
+
   auto begin = npc.currentWayPoint();
   if(begin==&end && MoveAlgo::isClose(npc,end)) {
-    return WayPath();
+    return false;
     }
   if(begin==&end && !end.isConnected() && npc.canRayHitPoint(end.position()+Tempest::Vec3(0,10,0))) {
-    WayPath ret;
-    ret.add(end);
-    return ret;
+    q.path.add(end);
+    return false;
     }
   if(begin && begin->isConnected() && MoveAlgo::isClose(npc,*begin)) {
-    return wmatrix->wayTo(&begin,1,npcPos,end);
+    q.begin.push_back(begin);
+    return true;
     }
   auto near = wmatrix->findWayPoint(npcPos, [&npc](const WayPoint &wp) {
     if(!npc.canRayHitPoint(Tempest::Vec3(wp.pos.x,wp.pos.y+10,wp.pos.z),true))
@@ -1000,20 +1016,37 @@ WayPath World::wayTo(const Npc &npc, const WayPoint &end) const {
     return true;
     });
   if(near==nullptr)
-    return WayPath();
+    return false;
 
   if(MoveAlgo::isClose(npc,*near) && near==&end)
-    return WayPath();
+    return false;
 
-  std::vector<const WayPoint*> wpoint;
-  wpoint.push_back(near);
+  q.begin.push_back(near);
   for(auto& i:near->connections()) {
     auto p = i.point->position();
     if(npc.canRayHitPoint(Tempest::Vec3(p.x,p.y+10,p.z)))
-      wpoint.push_back(i.point);
+      q.begin.push_back(i.point);
     }
+  return true;
+  }
 
-  return wmatrix->wayTo(wpoint.data(),wpoint.size(),npcPos,end);
+void World::solveWay(WayQuery& q) const {
+  q.path = wmatrix->wayTo(q.begin.data(),q.begin.size(),q.exactBegin,*q.end);
+  }
+
+WayMatrix::Benchmark World::wayBenchmark() const {
+  std::vector<std::pair<const WayPoint*,const WayPoint*>> routes;
+  std::vector<const WayPoint*>                            points;
+  for(size_t i=0; i<wobj.npcCount(); ++i) {
+    points.clear();
+    wobj.npc(i).routinePoints(points);
+    for(size_t r=0; points.size()>1 && r<points.size(); ++r) {
+      auto a = points[r], b = points[(r+1)%points.size()];
+      if(a!=b)
+        routes.emplace_back(a,b);
+      }
+    }
+  return wmatrix->benchmark(routes);
   }
 
 GameScript& World::script() const {
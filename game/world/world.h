@@ -57,7 +57,8 @@ class World final {
     const WayPoint*      findPoint(std::string_view name, bool inexact=true) const;
     const WayPoint*      findWayPoint(std::string_view name) const;
     const WayPoint*      findWayPoint(const Tempest::Vec3& pos) const;
-    const WayPoint*      findWayPoint(const Tempest::Vec3& pos, const std::function<bool(const WayPoint&)>& f) const;
+    template<class Filter, std::enable_if_t<std::is_invocable_r_v<bool,const Filter&,const WayPoint&>,bool> = true>
+    const WayPoint*      findWayPoint(const Tempest::Vec3& pos, const Filter& f) const { return wmatrix->findWayPoint(pos,f); }
     const WayPoint*      findWayPoint(const Tempest::Vec3& pos, std::string_view name) const;
 
     const WayPoint*      findFreePoint(const Npc& pos,           std::string_view name) const;
@@ -72,10 +73,31 @@ class World final {
 
     void                 detectNpcNear(std::function<void(Npc&)> f);
     void                 detectNpc (const Tempest::Vec3& p, const float r, const std::function<void(Npc&)>& f);
+    void                 findNearestNpcs(const Tempest::Vec3& p, const float r, size_t k, const Npc* exclude, std::vector<Npc*>& out) const;
+    void                 updateNpcIndex(Npc& npc);
     void                 detectItem(const Tempest::Vec3& p, const float r, const std::function<void(Item&)>& f);
+    template<class Func>
+    void                 detectWayPoint(const Tempest::Vec3& p, const float r, const Func& f) const { wmatrix->detectWayPoint(p,r,f); }
 
     WayPath              wayTo(const Npc& pos,const WayPoint& end) const;
 
+    // wayTo in two steps: prepareWay picks the begin points (ray casts, main thread only) and
+    // returns false if the result is already known; solveWay is reentrant and may run on workers
+    bool                 prepareWay(const Npc& npc, const WayPoint& end, WayQuery& q) const;
+    void                 solveWay(WayQuery& q) const;
+    // replays the routine to routine walks of all npcs through the path finder
+    auto                 wayBenchmark() const -> WayMatrix::Benchmark;
+
+    void                 setNpcThink(WorldObjects::NpcThink m) { wobj.setNpcThink(m); }
+    auto                 npcThink() const -> WorldObjects::NpcThink { return wobj.npcThink(); }
+    auto                 thinkStats() const -> const WorldObjects::ThinkStats& { return wobj.thinkStats(); }
+    void                 resetThinkStats() { wobj.resetThinkStats(); }
+    uint64_t             stateHash() const { return wobj.stateHash(); }
+    void                 setAiLod(const WorldObjects::AiLod& l) { wobj.setAiLod(l); }
+    auto                 aiLod() const -> const WorldObjects::AiLod& { return wobj.aiLod(); }
+    auto                 aiLodStats() const -> const WorldObjects::AiLodStats& { return wobj.aiLodStats(); }
+    void                 resetAiLodStats() { wobj.resetAiLodStats(); }
+
     WorldView*           view()     const { return wview.get();    }
     WorldSound*          sound()          { return &wsound;        }
     DynamicWorld*        physic()   const { return wdynamic.get(); }
@@ -81,6 +81,7 @@ void WorldObjects::load(Serialize &fin) {
   for(size_t i=0; i<npcArr.size(); ++i) {
     npcArr[i]->load(fin,i,"/npc/");
     }
+  rebuildNpcIndex();
 
   if(fin.version()>50) {
     sz = fin.directorySize("worlds/",fin.worldName(),"/npc_invalid/");
@@ -172,12 +173,33 @@ void WorldObjects::tick(uint64_t dt, uint64_t dtPlayer) {
   auto       camera  = Gothic::inst().camera();
   const bool freeCam = (camera!=nullptr && camera->isFree());
   const auto pl      = owner.player();
+
+  uint32_t lodBudget[2] = {};
+  lodFrame++;
+  lodSt.frames++;
+  lodSt.deferred = 0;
+  std::fill(std::begin(lodSt.ticked), std::end(lodSt.ticked), 0);
+  std::fill(std::begin(lodSt.skipped),std::end(lodSt.skipped),0);
+  for(auto& i:npcArr)
+    if(!isTickDue(*i,lodBudget))
+      i->markTickSkipped(lodFrame);
+
+  prepareGoToPaths(pl);
   for(size_t i=0; i<npcArr.size(); ++i) {
     auto& npc = *npcArr[i];
     uint64_t d = (pl==&npc ? dtPlayer : dt);
     if(freeCam && pl==&npc)
       continue;
+    const size_t policy = size_t(npc.processPolicy());
+    // keyed on the npc: scripts may insert or remove npc's during this loop
+    if(npc.isTickSkipped(lodFrame)) {
+      npc.skipTick(d);
+      lodSt.skipped[policy]++;
+      continue;
+      }
     npc.tick(d);
+    lodSt.ticked[policy]++;
+    lodSt.total[policy]++;
     }
 
   for(auto& i:routines) {
@@ -242,6 +264,7 @@ void WorldObjects::tick(uint64_t dt, uint64_t dtPlayer) {
   if(pl==nullptr)
     return;
 
+  thinkPerception(*pl);
   for(auto& ptr:npcNear) {
     Npc& i = *ptr;
     if(i.isPlayer() || i.isDead())
@@ -257,6 +280,7 @@ void WorldObjects::tick(uint64_t dt, uint64_t dtPlayer) {
         passivePerceptionProcess(r, *ptr, *pl);
       }
     }
+  commitThinkStats();
   }
 
 uint32_t WorldObjects::npcId(const Npc *ptr) const {
@@ -299,6 +323,7 @@ Npc* WorldObjects::addNpc(size_t npcInstance, std::string_view at) {
     npc->updateTransform();
     owner.script().invokeRefreshAtInsert(*npc);
     npcArr.emplace_back(npc);
+    npcIndex.add(*npc);
     } else {
     Log::e("addNpc: ", npcInstance, " has invalid spawnpoint");
     auto& point = owner.deadPoint();
@@ -329,6 +354,7 @@ Npc* WorldObjects::addNpc(size_t npcInstance, const Vec3& pos) {
   owner.script().invokeRefreshAtInsert(*npc);
 
   npcArr.emplace_back(npc);
+  npcIndex.add(*npc);
 
   // Lua hook - notify NPC spawned
   if(Gothic::inst().onNpcSpawn) {
@@ -356,6 +382,7 @@ Npc* WorldObjects::insertPlayer(std::unique_ptr<Npc> &&npc, std::string_view at)
   npc->attachToPoint(pos);
   npc->updateTransform();
   npcArr.emplace_back(std::move(npc));
+  npcIndex.add(*npcArr.back());
   return npcArr.back().get();
   }
 
@@ -363,6 +390,7 @@ std::unique_ptr<Npc> WorldObjects::takeNpc(const Npc* ptr) {
   for(size_t i=0; i<npcArr.size(); ++i){
     auto& npc=*npcArr[i];
     if(&npc==ptr){
+      npcIndex.del(npc);
       auto ret=std::move(npcArr[i]);
       npcArr.erase(npcArr.begin() + int32_t(i));
       return ret;
@@ -387,6 +415,136 @@ void WorldObjects::removeNpc(Npc& npc) {
   npcRemoved.emplace_back(std::move(ptr));
   }
 
+void WorldObjects::rebuildNpcIndex() {
+  npcIndex.clear();
+  for(auto& i:npcArr)
+    npcIndex.add(*i);
+  }
+
+// Solves the go-to paths the npcs are about to ask for in this tick on the workers. Begin
+// points are picked here (ray casts); npcs whose state changed before their tick fall back
+// to World::wayTo
+void WorldObjects::prepareGoToPaths(const Npc* skip) {
+  goToNpc.clear();
+  for(auto& i:npcArr) {
+    // skipped by the level-of-detail scheduler this frame: the path would be thrown away
+    if(i.get()==skip || i->isTickSkipped(lodFrame))
+      continue;
+    auto end = i->pendingGoToPoint();
+    if(end==nullptr)
+      continue;
+    if(goToQuery.size()<=goToNpc.size())
+      goToQuery.resize(goToNpc.size()+1);
+    auto& q = goToQuery[goToNpc.size()];
+    if(!owner.prepareWay(*i,*end,q)) {
+      i->setPreparedPath(std::move(q));
+      continue;
+      }
+    goToNpc.push_back(i.get());
+    }
+
+  if(goToNpc.empty())
+    return;
+  Workers::parallelTasks(goToNpc.size(),[this](size_t i){
+    owner.solveWay(goToQuery[i]);
+    });
+  for(size_t i=0; i<goToNpc.size(); ++i)
+    goToNpc[i]->setPreparedPath(std::move(goToQuery[i]));
+  }
+
+void WorldObjects::thinkPerception(const Npc& pl) {
+  thinkNpc.clear();
+  if(thinkMode==NpcThink::Serial)
+    return;
+  // same selection as the perception loop in tick
+  for(auto ptr:npcNear) {
+    Npc& i = *ptr;
+    if(i.isPlayer() || i.isDead() || i.processPolicy()!=NpcProcessPolicy::AiNormal)
+      continue;
+    if(i.percNextTime()<=owner.tickCount())
+      thinkNpc.push_back(ptr);
+    }
+
+  const bool verify = (thinkMode==NpcThink::Verify);
+  Workers::parallelTasks(thinkNpc.size(),[this,&pl,verify](size_t i){
+    thinkNpc[i]->thinkPerception(pl,verify);
+    });
+  }
+
+void WorldObjects::commitThinkStats() {
+  thinkSt.ticks++;
+  for(auto npc:thinkNpc) {
+    auto& st = npc->senseStats();
+    thinkSt.npcs++;
+    thinkSt.thinkRays  += st.thinkRays;
+    thinkSt.hits       += st.hits;
+    thinkSt.misses     += st.misses;
+    thinkSt.mismatches += st.mismatches;
+    if(thinkMode==NpcThink::Verify) {
+      thinkSt.serialHash   = (thinkSt.serialHash  ^st.serialHash  )*1099511628211ull;
+      thinkSt.parallelHash = (thinkSt.parallelHash^st.parallelHash)*1099511628211ull;
+      }
+    }
+  }
+
+void WorldObjects::setAiLod(const AiLod& l) {
+  lod = l;
+  lod.farPeriod  = std::max(lod.farPeriod, 1u);
+  lod.far2Period = std::max(lod.far2Period,1u);
+  }
+
+bool WorldObjects::isTickDue(Npc& npc, uint32_t (&budget)[2]) {
+  const auto policy = npc.processPolicy();
+  if(policy==NpcProcessPolicy::Player || policy==NpcProcessPolicy::AiNormal)
+    return true;
+  // falling is integrated per frame
+  if(npc.isInAir())
+    return true;
+
+  const bool     far2   = (policy==NpcProcessPolicy::AiFar2);
+  const uint64_t period = far2 ? lod.far2Period : lod.farPeriod;
+  const uint32_t max    = far2 ? lod.far2Budget : lod.farBudget;
+  const uint64_t wait   = npc.skippedTicks();
+  // own bucket, or it was missed: period changed, policy changed or the budget was exhausted
+  if((lodFrame+uint64_t(uint32_t(npc.handle().id)))%period!=0 && wait<period)
+    return false;
+
+  auto& used = budget[far2 ? 1 : 0];
+  if(max>0 && used>=max && wait<2*period) {
+    lodSt.deferred++;
+    return false;
+    }
+  used++;
+  return true;
+  }
+
+uint64_t WorldObjects::stateHash() const {
+  uint64_t h   = 14695981039346656037ull;
+  auto     mix = [&h](const void* data, size_t size) {
+    auto b = reinterpret_cast<const uint8_t*>(data);
+    for(size_t i=0; i<size; ++i) {
+      h ^= b[i];
+      h *= 1099511628211ull;
+      }
+    };
+
+  for(auto& ptr:npcArr) {
+    auto&         npc = *ptr;
+    const Vec3    pos = npc.position();
+    const float   rot = npc.rotation();
+    const int32_t val[] = {npc.handle().id,
+                           npc.attribute(ATR_HITPOINTS),
+                           npc.attribute(ATR_MANA),
+                           int32_t(npc.bodyState()),
+                           int32_t(npc.weaponState()),
+                           npc.isDead() ? 1 : 0};
+    mix(&pos, sizeof(pos));
+    mix(&rot, sizeof(rot));
+    mix(val,  sizeof(val));
+    }
+  return h;
+  }
+
 void WorldObjects::tickNear(uint64_t /*dt*/) {
   for(Npc* i:npcNear) {
     auto pos = i->position() + Vec3(0,i->translateY(),0);
@@ -504,12 +662,11 @@ void WorldObjects::detectNpcNear(const std::function<void(Npc&)>& f) {
 
 void WorldObjects::detectNpc(const float x, const float y, const float z,
                              const float r, const std::function<void(Npc&)>& f) {
-  float maxDist=r*r;
-  for(auto& i:npcArr) {
-    auto qDist = (i->position()-Vec3(x,y,z)).quadLength();
-    if(qDist<maxDist)
-      f(*i);
-    }
+  npcIndex.find(Vec3(x,y,z),r,f);
+  }
+
+void WorldObjects::findNearestNpcs(const Vec3& p, const float r, size_t k, const Npc* exclude, std::vector<Npc*>& out) const {
+  npcIndex.nearest(p,r,k,exclude,out);
   }
 
 void WorldObjects::detectItem(const float x, const float y, const float z,
@@ -641,6 +798,11 @@ void WorldObjects::onItemRemoved(const Item& itm) {
   for(auto& i:npcArr)
     i->onWldItemRemoved(itm);
   owner.script().onWldItemRemoved(itm);
+
+  // Lua hook - notify item removed from world
+  if(Gothic::inst().onItemRemove) {
+    Gothic::inst().onItemRemove(itm);
+    }
   }
 
 Bullet& WorldObjects::shootBullet(const Item& itmId, const Vec3& pos, const Vec3& dir, float tgRange, float speed) {
@@ -970,9 +1132,12 @@ void WorldObjects::resetPositionToTA() {
     r.curState = 0;
 
   for(auto& i:npcInvalid)
-    if(i->handlePtr().use_count()>1)
-      npcArr.push_back(std::move(i)); else
+    if(i->handlePtr().use_count()>1) {
+      npcIndex.add(*i);
+      npcArr.push_back(std::move(i));
+      } else {
       npcRemoved.push_back(std::move(i));
+      }
   npcInvalid.clear();
 
   for(size_t i=0;i<npcArr.size();) {
@@ -980,6 +1145,7 @@ void WorldObjects::resetPositionToTA() {
     if(n.resetPositionToTA()){
       ++i;
       } else {
+      npcIndex.del(n);
       npcInvalid.emplace_back(std::move(npcArr[i]));
       npcArr.erase(npcArr.begin()+int(i));
 
@@ -7,6 +7,7 @@
 
 #include "bullet.h"
 #include "spaceindex.h"
+#include "npcindex.h"
 #include "game/gametime.h"
 #include "game/perceptionmsg.h"
 #include "game/constants.h"
@@ -21,6 +22,7 @@ class Serialize;
 class TriggerEvent;
 class AbstractTrigger;
 class CsCamera;
+struct WayQuery;
 class CollisionZone;
 
 class WorldObjects final {
@@ -66,6 +68,8 @@ class WorldObjects final {
     Item*          findItemByInstance(size_t instance, size_t n = 0);
     void           detectNpcNear(const std::function<void(Npc&)>& f);
     void           detectNpc (const float x, const float y, const float z, const float r, const std::function<void(Npc&)>&  f);
+    void           findNearestNpcs(const Tempest::Vec3& p, const float r, size_t k, const Npc* exclude, std::vector<Npc*>& out) const;
+    void           updateNpcIndex(Npc& npc) { npcIndex.move(npc); }
     void           detectItem(const float x, const float y, const float z, const float r, const std::function<void(Item&)>& f);
 
     uint32_t       npcId(const Npc *ptr) const;
@@ -136,6 +140,54 @@ class WorldObjects final {
 
     void           resetPositionToTA();
 
+    // perception pass in two phases: ray checks are cast on workers ahead (think), scripts
+    // run serially in npc id order (commit) and reuse rays with identical end points only.
+    // The rest of Npc::tick (ai queue, movement, routines) stays serial
+    enum class NpcThink : uint8_t {
+      Serial,
+      Parallel,
+      Verify,   // parallel, but every reused ray is cast again and compared
+      };
+    struct ThinkStats {
+      uint64_t       ticks      = 0;
+      uint64_t       npcs       = 0;
+      uint64_t       thinkRays  = 0;
+      uint64_t       hits       = 0;
+      uint64_t       misses     = 0;
+      uint64_t       mismatches = 0;
+      // verify mode: the perception rays of every tick folded in npc id order, as a serial run
+      // casts them and as the parallel commit used them; equal after N ticks means same decisions
+      uint64_t       serialHash   = 14695981039346656037ull;
+      uint64_t       parallelHash = 14695981039346656037ull;
+      };
+    void           setNpcThink(NpcThink m) { thinkMode = m; }
+    NpcThink       npcThink() const { return thinkMode; }
+    auto           thinkStats() const -> const ThinkStats& { return thinkSt; }
+    void           resetThinkStats() { thinkSt = ThinkStats(); }
+    // FNV-1a over the npc state, for determinism checks
+    uint64_t       stateHash() const;
+
+    // level-of-detail npc ticks: AiFar npc's are ticked every farPeriod frames and AiFar2 every
+    // far2Period, in round-robin buckets by npc id; a skipped frame hands its dt to the next tick
+    struct AiLod {
+      uint32_t       farPeriod  = 2;
+      uint32_t       far2Period = 8;
+      uint32_t       farBudget  = 0; // max ticks per frame, 0 - unlimited
+      uint32_t       far2Budget = 0;
+      };
+    struct AiLodStats {
+      static constexpr size_t PolicyCount = 4;
+      uint64_t       frames                = 0;
+      uint32_t       ticked  [PolicyCount] = {}; // last frame, by NpcProcessPolicy
+      uint32_t       skipped [PolicyCount] = {};
+      uint32_t       deferred              = 0;  // due last frame, but over budget
+      uint64_t       total   [PolicyCount] = {}; // ticks since reset
+      };
+    void           setAiLod(const AiLod& l);
+    auto           aiLod() const -> const AiLod& { return lod; }
+    auto           aiLodStats() const -> const AiLodStats& { return lodSt; }
+    void           resetAiLodStats() { lodSt = AiLodStats(); }
+
   private:
     struct MobRoutine {
       gtime   time;
@@ -171,6 +223,7 @@ class WorldObjects final {
     std::list<Bullet>                  bullets;
     std::vector<EffectState>           effects;
 
+    NpcIndex                           npcIndex;   // live npc's from npcArr
     std::vector<std::unique_ptr<Npc>>  npcArr;
     std::vector<std::unique_ptr<Npc>>  npcInvalid; // dead or invalid TA
     std::vector<std::unique_ptr<Npc>>  npcRemoved; // removed, but may have a dangling references in game
@@ -183,6 +236,17 @@ class WorldObjects final {
     std::vector<TriggerEvent>          triggerEvents;
     CsCamera*                          currentCsCamera = nullptr;
 
+    std::vector<Npc*>                  goToNpc;   // prepareGoToPaths scratch
+    std::vector<WayQuery>              goToQuery;
+
+    NpcThink                           thinkMode = NpcThink::Parallel;
+    ThinkStats                         thinkSt;
+    std::vector<Npc*>                  thinkNpc;  // thinkPerception scratch
+
+    AiLod                              lod;
+    AiLodStats                         lodSt;
+    uint64_t                           lodFrame = 0; // Npc::markTickSkipped stamp
+
     template<class T>
     auto findObj(T &src, const Npc &pl, const SearchOpt& opt) -> typename std::remove_reference<decltype(src[0])>::type;
 
@@ -194,7 +258,12 @@ class WorldObjects final {
     void             setMobState(std::string_view scheme, int32_t st);
     void             passivePerceptionProcess(PerceptionMsg& msg, Npc& npc, Npc& pl);
 
+    void             rebuildNpcIndex();
     void             tickNear(uint64_t dt);
+    void             prepareGoToPaths(const Npc* skip);
+    void             thinkPerception(const Npc& pl);
+    void             commitThinkStats();
+    bool             isTickDue(Npc& npc, uint32_t (&budget)[2]);
     void             tickTriggers(uint64_t dt);
     static bool      isTargetedBy(Npc& npc,Npc& by);
   };
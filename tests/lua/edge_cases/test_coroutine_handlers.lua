@@ -0,0 +1,71 @@
+-- Coroutine Handlers Test Suite
+-- Tests register(..., { coroutine = true }): explicit yields and budget preemption resume on later updates
+
+local test = opengothic.test
+
+local state = {
+    started = false,
+    done = false,
+    updateTicks = 0,
+    steps = 0,
+    stepsFinished = false,
+    spins = 0,
+    stopSpin = false,
+    spinFinished = false
+}
+
+opengothic.events.register("testCoroutineSteps", function()
+    for _ = 1, 3 do
+        state.steps = state.steps + 1
+        coroutine.yield()
+    end
+    state.stepsFinished = true
+end, { coroutine = true })
+
+opengothic.events.register("testCoroutineSpin", function()
+    -- never yields on its own, only the execution budget can pause it
+    while not state.stopSpin do
+        state.spins = state.spins + 1
+    end
+    state.spinFinished = true
+end, { coroutine = true })
+
+opengothic.events.register("onWorldLoaded", function()
+    test.suite("Coroutine Handlers")
+
+    test.assert_eq(opengothic.events.register("testCoroutineBad", function() end, 1), nil, "register rejects non-table options")
+
+    local handled = opengothic._dispatchEvent("testCoroutineSteps")
+    test.assert_eq(handled, false, "suspended coroutine handler counts as not handled")
+    test.assert_eq(state.steps, 1, "coroutine handler runs up to the first yield")
+
+    handled = opengothic._dispatchEvent("testCoroutineSpin")
+    test.assert_eq(handled, false, "preempted coroutine handler counts as not handled")
+    test.assert_true(state.spins > 0, "preempted handler made progress")
+    test.assert_eq(state.spinFinished, false, "preempted handler is not finished")
+
+    state.started = true
+end)
+
+opengothic.events.register("onUpdate", function()
+    if not state.started or state.done then
+        return false
+    end
+
+    state.updateTicks = state.updateTicks + 1
+    if state.updateTicks == 3 then
+        state.stopSpin = true
+    end
+
+    if state.updateTicks >= 6 then
+        test.assert_eq(state.steps, 3, "yielding handler resumed on later updates")
+        test.assert_true(state.stepsFinished, "yielding handler finished")
+        test.assert_true(state.spinFinished, "preempted handler finished after resume")
+        state.done = true
+        test.summary()
+    end
+
+    return false
+end)
+
+print("[Test] Coroutine Handlers test loaded - runs on world load")
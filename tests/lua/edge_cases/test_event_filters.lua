@@ -0,0 +1,98 @@
+-- Event Filter Test Suite
+-- Tests events.register options npcInstance / isPlayer / itemInstance / percType
+
+local test = opengothic.test
+
+opengothic.events.register("onWorldLoaded", function()
+    test.suite("Event Filters")
+
+    local player = opengothic.player()
+    if player == nil then
+        print("[SKIP] Event filters: no player")
+        return
+    end
+
+    -- Invalid options
+    local noop = function() end
+    test.assert_eq(opengothic.events.register("onNpcTakeDamage", noop, { percType = 1 }), nil,
+        "percType is only valid for onNpcPerception")
+    test.assert_eq(opengothic.events.register("onNpcPerception", noop, { percType = "1" }), nil,
+        "percType must be a number")
+    test.assert_eq(opengothic.events.register("onNpcPerception", noop, { isPlayer = 1 }), nil,
+        "isPlayer must be a boolean")
+    test.assert_eq(opengothic.events.register("onNpcPerception", noop, { npcInstance = "NONEXISTENT_NPC_12345" }), nil,
+        "unknown npcInstance name is rejected")
+    test.assert_eq(opengothic.events.register("onNpcPerception", noop, { npcInstance = {} }), nil,
+        "npcInstance must be an id or a name")
+
+    -- isPlayer: only the player passes
+    local playerHits = 0
+    local playerId = opengothic.events.register("testFilterProbe", function(npc)
+        playerHits = playerHits + 1
+    end, { isPlayer = true })
+    test.assert_type(playerId, "number", "register accepts isPlayer filter")
+
+    local allHits = 0
+    local allId = opengothic.events.register("testFilterProbe", function(npc)
+        allHits = allHits + 1
+    end)
+
+    opengothic._dispatchEvent("testFilterProbe", player)
+    test.assert_eq(playerHits, 1, "isPlayer handler runs for the player")
+    test.assert_eq(allHits, 1, "unfiltered handler runs for the player")
+
+    local world = opengothic.world()
+    local other = world and world:findNearestNpc(player, 100000) or nil
+    if other ~= nil then
+        opengothic._dispatchEvent("testFilterProbe", other)
+        test.assert_eq(playerHits, 1, "isPlayer handler skips other npcs")
+        test.assert_eq(allHits, 2, "unfiltered handler still runs for other npcs")
+    else
+        print("[SKIP] isPlayer negative case: no other npc nearby")
+    end
+
+    -- npcInstance by name and by id
+    local heroHits = 0
+    local heroId = opengothic.events.register("testFilterProbe", function(npc)
+        heroHits = heroHits + 1
+    end, { npcInstance = player:instanceId() })
+    opengothic._dispatchEvent("testFilterProbe", player)
+    test.assert_eq(heroHits, 1, "npcInstance id filter matches")
+
+    local scavenger = opengothic.resolve("SCAVENGER")
+    if scavenger ~= nil then
+        local scavengerHits = 0
+        local scavengerId = opengothic.events.register("testFilterProbe", function(npc)
+            scavengerHits = scavengerHits + 1
+        end, { npcInstance = "SCAVENGER" })
+        test.assert_type(scavengerId, "number", "npcInstance accepts a symbol name")
+        opengothic._dispatchEvent("testFilterProbe", player)
+        test.assert_eq(scavengerHits, 0, "npcInstance name filter skips other instances")
+        opengothic.events.unregister("testFilterProbe", scavengerId)
+    end
+
+    -- a filter on an npc never matches an event without one
+    local before = playerHits
+    opengothic._dispatchEvent("testFilterProbe", nil)
+    test.assert_eq(playerHits, before, "filtered handler skips events without an npc")
+
+    -- percType looks at the first number argument
+    local percHits = 0
+    local percId = opengothic.events.register("onNpcPerception", function(npc, o, percType)
+        percHits = percHits + 1
+    end, { percType = 7 })
+    test.assert_type(percId, "number", "register accepts percType for onNpcPerception")
+    opengothic._dispatchEvent("onNpcPerception", player, player, 3)
+    test.assert_eq(percHits, 0, "percType filter skips other perceptions")
+    opengothic._dispatchEvent("onNpcPerception", player, player, 7)
+    test.assert_eq(percHits, 1, "percType filter matches")
+
+    opengothic.events.unregister("testFilterProbe", playerId)
+    opengothic.events.unregister("testFilterProbe", allId)
+    opengothic.events.unregister("testFilterProbe", heroId)
+    opengothic.events.unregister("onNpcPerception", percId)
+
+    test.summary()
+end)
+
+print("[Test] Event Filters test loaded - runs on world load")
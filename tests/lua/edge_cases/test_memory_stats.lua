@@ -0,0 +1,53 @@
+-- Memory Stats Test Suite
+-- Tests opengothic.memoryStats and that handler allocations are charged to their script
+
+local test = opengothic.test
+
+local keep = nil
+
+local function snapshot()
+    local bytes = {}
+    for path, m in pairs(opengothic.memoryStats().modules) do
+        bytes[path] = m.bytes
+    end
+    return bytes
+end
+
+opengothic.events.register("onWorldLoaded", function()
+    test.suite("Memory Stats")
+
+    local stats = opengothic.memoryStats()
+    test.assert_type(stats, "table", "memoryStats returns a table")
+    test.assert_type(stats.total, "number", "total is a number")
+    test.assert_type(stats.reserved, "number", "reserved is a number")
+    test.assert_type(stats.engine, "number", "engine is a number")
+    test.assert_type(stats.modules, "table", "modules is a table")
+    test.assert_true(stats.total > 0 and stats.reserved >= stats.total, "allocator reserves what Lua uses")
+
+    local any = false
+    for path, m in pairs(stats.modules) do
+        any = true
+        test.assert_type(path, "string", "modules are keyed by script path")
+        test.assert_type(m.bytes, "number", "module bytes is a number")
+        test.assert_type(m.disabled, "boolean", "module disabled is a boolean")
+    end
+    test.assert_true(any, "loaded scripts are listed")
+
+    -- ~1 MB, allocated by this handler and kept alive
+    local before = snapshot()
+    keep = table.create(64 * 1024, 0)
+    for i = 1, #keep do
+        keep[i] = i
+    end
+    local after = snapshot()
+
+    local grown = 0
+    for path, bytes in pairs(after) do
+        grown = math.max(grown, bytes - (before[path] or 0))
+    end
+    test.assert_true(grown >= 512 * 1024, "handler allocation is charged to its script")
+
+    test.summary()
+end)
+
+print("[Test] Memory Stats test loaded - runs on world load")
@@ -0,0 +1,57 @@
+-- AI LOD Test Suite
+-- Configures time slicing of far NPC updates and checks the counters move with the frames
+
+local test = opengothic.test
+
+local state = {
+    started = false,
+    done = false,
+    updateTicks = 0,
+    config = nil
+}
+
+opengothic.events.register("onWorldLoaded", function()
+    test.suite("AI LOD")
+
+    local world = opengothic.world()
+    local st = world:aiLod()
+    test.assert_type(st, "table", "aiLod returns a table")
+    test.assert_true(st.farPeriod >= 1 and st.far2Period >= 1, "periods are positive")
+    test.assert_type(st.ticked, "table", "ticked counters per policy")
+    test.assert_type(st.skipped.far2, "number", "skipped counters per policy")
+    state.config = { farPeriod = st.farPeriod, far2Period = st.far2Period,
+                     farBudget = st.farBudget, far2Budget = st.far2Budget }
+
+    local ok = pcall(world.aiLod, world, { farPeriod = 0 })
+    test.assert_eq(ok, false, "zero period is rejected")
+    test.assert_eq(world:aiLod().farPeriod, state.config.farPeriod, "rejected config is not applied")
+
+    st = world:aiLod({ farPeriod = 3, far2Budget = 5 })
+    test.assert_eq(st.farPeriod, 3, "period is set")
+    test.assert_eq(st.far2Period, state.config.far2Period, "omitted fields are kept")
+    test.assert_eq(st.far2Budget, 5, "budget is set")
+    test.assert_eq(st.frames, 0, "changing the config resets the counters")
+
+    state.started = true
+end)
+
+opengothic.events.register("onUpdate", function()
+    if not state.started or state.done then
+        return false
+    end
+
+    state.updateTicks = state.updateTicks + 1
+    if state.updateTicks >= 30 then
+        local world = opengothic.world()
+        local st = world:aiLod()
+        test.assert_true(st.frames > 0, "frames are counted")
+        test.assert_eq(st.farPeriod, 3, "config is kept across frames")
+        world:aiLod(state.config)
+        state.done = true
+        test.summary()
+    end
+
+    return false
+end)
+
+print("[Test] AI LOD test loaded - runs on world load")
@@ -0,0 +1,92 @@
+-- Async Tasks Test Suite
+-- Tests opengothic.async tasks: wait, waitEvent, cancel and persistent task entry points
+
+local test = opengothic.test
+
+local state = {
+    started = false,
+    done = false,
+    updateTicks = 0,
+    steps = {},
+    eventArgs = nil,
+    canceledResumed = false,
+    persistentRuns = 0
+}
+
+opengothic.async.define("test.async.persistent", function(s)
+    state.persistentRuns = state.persistentRuns + 1
+    s.count = (s.count or 0) + 1
+    opengothic.async.wait(0)
+    s.count = s.count + 1
+end)
+
+opengothic.events.register("onWorldLoaded", function()
+    test.suite("Async Tasks")
+
+    test.assert_type(opengothic.async, "table", "opengothic.async module exists")
+    test.assert_type(opengothic.async.run, "function", "run exists")
+    test.assert_type(opengothic.async.wait, "function", "wait exists")
+    test.assert_type(opengothic.async.waitGameMinutes, "function", "waitGameMinutes exists")
+    test.assert_type(opengothic.async.waitEvent, "function", "waitEvent exists")
+
+    local ok = pcall(opengothic.async.wait, 1)
+    test.assert_eq(ok, false, "wait outside of a task raises an error")
+
+    local id = opengothic.async.run(function(a, b)
+        table.insert(state.steps, a + b)
+        opengothic.async.wait(0)
+        table.insert(state.steps, "next")
+        opengothic.async.wait(0.05)
+        table.insert(state.steps, "timed")
+    end, 1, 2)
+    test.assert_type(id, "number", "run returns task id")
+    test.assert_eq(state.steps[1], 3, "task runs up to its first wait with arguments")
+    test.assert_eq(#state.steps, 1, "task is suspended at wait")
+
+    opengothic.async.run(function()
+        local a, b = opengothic.async.waitEvent("testAsyncSignal")
+        state.eventArgs = { a, b }
+    end)
+    opengothic._dispatchEvent("testAsyncSignal", "x", 42)
+    test.assert_true(state.eventArgs ~= nil, "waitEvent resumes on dispatch")
+    test.assert_eq(state.eventArgs[1], "x", "waitEvent returns first event argument")
+    test.assert_eq(state.eventArgs[2], 42, "waitEvent returns second event argument")
+
+    local cancelId = opengothic.async.run(function()
+        opengothic.async.wait(0)
+        state.canceledResumed = true
+    end)
+    test.assert_eq(opengothic.async.cancel(cancelId), true, "cancel succeeds for suspended task")
+    test.assert_eq(opengothic.async.cancel(cancelId), false, "second cancel fails")
+
+    local taskId, err = opengothic.async.start("test.async.unknown")
+    test.assert_true(taskId == nil and err == "unknown_task", "start rejects undefined entry")
+
+    state.persistent = { count = 0 }
+    taskId = opengothic.async.start("test.async.persistent", state.persistent)
+    test.assert_type(taskId, "number", "start returns task id")
+    test.assert_eq(state.persistent.count, 1, "persistent task receives its state table")
+
+    state.started = true
+end)
+
+opengothic.events.register("onUpdate", function()
+    if not state.started or state.done then
+        return false
+    end
+
+    state.updateTicks = state.updateTicks + 1
+    if state.updateTicks >= 30 then
+        test.assert_eq(state.steps[2], "next", "wait(0) resumes on a later update")
+        test.assert_eq(state.steps[3], "timed", "timed wait resumes")
+        test.assert_eq(state.canceledResumed, false, "canceled task is never resumed")
+        test.assert_eq(state.persistent.count, 2, "persistent task finished")
+        test.assert_eq(state.persistentRuns, 1, "persistent entry ran once")
+        state.done = true
+        test.summary()
+    end
+
+    return false
+end)
+
+print("[Test] Async Tasks test loaded - runs on world load")
@@ -45,6 +45,7 @@ opengothic.events.register("onWorldLoaded", function()
     test.assert_type(opengothic.daedalus.get, "function", "daedalus.get exists")
     test.assert_type(opengothic.daedalus.set, "function", "daedalus.set exists")
     test.assert_type(opengothic.vm.callWithContext, "function", "vm.callWithContext exists")
+    test.assert_type(opengothic.daedalus.bind, "function", "daedalus.bind exists")
 
     local ok, err = pcall(opengothic.daedalus.call, nil)
     test.assert_eq(ok, false, "daedalus.call rejects invalid function name")
@@ -86,6 +87,30 @@ opengothic.events.register("onWorldLoaded", function()
         skip("Hlp_StrCmp probe skipped (symbol unavailable)")
     end
 
+    ok, err = pcall(opengothic.daedalus.bind, "__OG_DOES_NOT_EXIST__")
+    test.assert_eq(ok, false, "daedalus.bind fails for missing function")
+    test.assert_type(err, "string", "daedalus.bind missing function returns error string")
+
+    if hasSymbol("Hlp_StrCmp") then
+        local bindOk, bindErr = pcall(opengothic.daedalus.bind, "Hlp_StrCmp")
+        assertExternalUnsupported(bindOk, bindErr, "daedalus.bind rejects external functions")
+    else
+        skip("Hlp_StrCmp bind probe skipped (symbol unavailable)")
+    end
+
+    if hasSymbol("B_GivePlayerXP") then
+        local bound = opengothic.daedalus.bind("B_GivePlayerXP")
+        test.assert_type(bound, "userdata", "daedalus.bind returns callable handle")
+        test.assert_true(string.find(tostring(bound), "B_GivePlayerXP", 1, true) ~= nil, "bound function prints its name")
+        local callOk, callErr = pcall(bound, {})
+        test.assert_eq(callOk, false, "bound call rejects unsupported argument types")
+        test.assert_type(callErr, "string", "bound call argument error is string")
+        callOk = pcall(bound)
+        test.assert_eq(callOk, false, "bound call checks argument count")
+    else
+        skip("B_GivePlayerXP bind probe skipped (symbol unavailable)")
+    end
+
     if hasSymbol("PLAYER_CHAPTER") then
         local oldChapter = opengothic.daedalus.get("PLAYER_CHAPTER")
         test.assert_type(oldChapter, "number", "daedalus.get returns chapter number")
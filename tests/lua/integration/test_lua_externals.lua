@@ -0,0 +1,60 @@
+-- Lua Externals Test Suite
+-- Validates vm.registerExternal signatures and argument/return marshalling.
+
+local test = opengothic.test
+
+local function raises(fn, message)
+    local ok, err = pcall(fn)
+    test.assert_eq(ok, false, message)
+    test.assert_type(err, "string", message .. " returns error string")
+end
+
+opengothic.events.register("onWorldLoaded", function()
+    test.suite("Lua Externals")
+
+    local noop = function() end
+    raises(function()
+        opengothic.vm.registerExternal("NONEXISTENT_FUNC_12345", noop)
+    end, "unknown function is rejected")
+    raises(function()
+        opengothic.vm.registerExternal("B_GivePlayerXP", noop, { params = { "pointer" } })
+    end, "unknown parameter type is rejected")
+    raises(function()
+        opengothic.vm.registerExternal("B_GivePlayerXP", noop, { params = { "string" } })
+    end, "mismatching parameter type is rejected")
+    raises(function()
+        opengothic.vm.registerExternal("B_GivePlayerXP", noop, { params = { "int" }, returns = "int" })
+    end, "mismatching return type is rejected")
+
+    if opengothic.vm.getSymbol("TEST_LUAEXTERNAL") == nil then
+        print("[SKIP] Lua externals: TEST_LUAEXTERNAL is only defined by the test runner")
+        test.summary()
+        return
+    end
+
+    local player = opengothic.player()
+    local seen = nil
+    opengothic.vm.registerExternal("TEST_LUAEXTERNAL", function(npc, amount, text)
+        seen = { npc = npc, amount = amount, text = text }
+        return amount * 2
+    end, { params = { "instance", "int", "string" }, returns = "int" })
+
+    local ret = opengothic.daedalus.call("TEST_LUAEXTERNAL", player, 21, "hello")
+    test.assert_not_nil(seen, "Lua implementation is called")
+    if seen ~= nil then
+        test.assert_eq(seen.amount, 21, "int argument is passed")
+        test.assert_eq(seen.text, "hello", "string argument is passed")
+        test.assert_true(seen.npc ~= nil and seen.npc:isPlayer(), "instance argument is passed as Npc")
+    end
+    test.assert_eq(ret, 42, "int result is returned to Daedalus")
+
+    -- without a signature the Daedalus one is used; registering again replaces the function
+    opengothic.vm.registerExternal("TEST_LUAEXTERNAL", function(npc, amount, text)
+        return #text
+    end)
+    test.assert_eq(opengothic.daedalus.call("TEST_LUAEXTERNAL", player, 1, "four"), 4, "re-registered function is used")
+
+    test.summary()
+end)
+
+print("[Test] Lua Externals test loaded - runs on world load")
@@ -0,0 +1,29 @@
+-- Module Reload Test Suite
+-- Tests per-script ownership of event handlers used by incremental reload
+
+local test = opengothic.test
+
+local module = opengothic._callerModule()
+
+opengothic.events.register("onWorldLoaded", function()
+    test.suite("Module Reload")
+
+    test.assert_type(module, "number", "script chunk has a module id")
+    test.assert_eq(opengothic._callerModule(), module, "handler runs as its own module")
+    test.assert_type(opengothic.events._unregisterModule, "function", "_unregisterModule exists")
+
+    local id = opengothic.events.register("testModuleReloadSignal", function() end)
+    local entry = opengothic.events._handlers["testModuleReloadSignal"][1]
+    test.assert_eq(entry.module, module, "handler is tagged with its module")
+
+    test.assert_eq(opengothic.events._unregisterModule(-1), 0, "unknown module drops nothing")
+    test.assert_eq(entry.callback ~= nil, true, "handler survives reload of other modules")
+
+    -- drops this file's handlers, including the running onWorldLoaded one
+    test.assert_true(opengothic.events._unregisterModule(module) >= 2, "module handlers are dropped")
+    test.assert_eq(opengothic.events.unregister("testModuleReloadSignal", id), false, "dropped handler is gone")
+
+    test.summary()
+end)
+
+print("[Test] Module Reload test loaded - runs on world load")
@@ -0,0 +1,61 @@
+-- NPC Think Test Suite
+-- Runs the perception pass in verify mode: every ray cast ahead on a worker and reused
+-- by the serial commit is cast again, so a single mismatch means a non-deterministic tick.
+-- The serial and parallel hashes over all rays of 120 ticks must be equal
+
+local test = opengothic.test
+
+local state = {
+    started = false,
+    done = false,
+    updateTicks = 0,
+    hash = nil
+}
+
+opengothic.events.register("onWorldLoaded", function()
+    test.suite("NPC Think")
+
+    local world = opengothic.world()
+    local st = world:npcThink()
+    test.assert_type(st, "table", "npcThink returns a table")
+    test.assert_eq(st.mode, "parallel", "parallel think is the default")
+
+    local ok = pcall(world.npcThink, world, "sometimes")
+    test.assert_eq(ok, false, "unknown mode is rejected")
+
+    st = world:npcThink("verify")
+    test.assert_eq(st.mode, "verify", "mode is switched")
+    test.assert_eq(st.ticks, 0, "switching the mode resets the counters")
+    test.assert_eq(st.mismatches, 0, "no mismatches before a tick")
+
+    state.hash = world:stateHash()
+    test.assert_type(state.hash, "string", "stateHash returns a string")
+    test.assert_eq(#state.hash, 16, "stateHash is 64 bit hex")
+    test.assert_eq(world:stateHash(), state.hash, "stateHash is stable within a frame")
+
+    state.started = true
+end)
+
+opengothic.events.register("onUpdate", function()
+    if not state.started or state.done then
+        return false
+    end
+
+    state.updateTicks = state.updateTicks + 1
+    if state.updateTicks >= 120 then
+        local world = opengothic.world()
+        local st = world:npcThink()
+        test.assert_eq(st.mode, "verify", "mode is kept across ticks")
+        test.assert_eq(st.mismatches, 0, "reused rays match a fresh cast")
+        test.assert_type(st.serialHash, "string", "serial hash is reported")
+        test.assert_eq(st.parallelHash, st.serialHash, "serial and parallel perception hashes agree after 120 ticks")
+        test.assert_true(st.ticks > 0, "perception pass is counted")
+        world:npcThink("parallel")
+        state.done = true
+        test.summary()
+    end
+
+    return false
+end)
+
+print("[Test] NPC Think test loaded - runs on world load")
@@ -0,0 +1,100 @@
+-- Parallel Map Test Suite
+-- Tests opengothic.parallel worker modules, task and callback completion
+
+local test = opengothic.test
+
+local state = {
+    started = false,
+    done = false,
+    updateTicks = 0,
+    taskResults = nil,
+    taskErr = nil,
+    callbackResults = nil,
+    callbackErr = nil
+}
+
+opengothic.events.register("onWorldLoaded", function()
+    test.suite("Parallel Map")
+
+    test.assert_type(opengothic.parallel, "table", "opengothic.parallel module exists")
+    test.assert_type(opengothic.parallel.define, "function", "define exists")
+    test.assert_type(opengothic.parallel.map, "function", "map exists")
+
+    local ok, err = opengothic.parallel.define("test.parallel.square", [[
+        return function(input)
+            if type(input) == "table" then
+                local out = {}
+                for i, v in ipairs(input) do
+                    out[i] = v * v
+                end
+                return { sum = #out, values = out }
+            end
+            if input == "fail" then
+                error("bad input")
+            end
+            if input == "engine" then
+                return opengothic == nil
+            end
+            return input * input
+        end
+    ]])
+    test.assert_eq(ok, true, "define compiles module")
+    test.assert_true(err == nil, "define returns no error")
+
+    ok, err = opengothic.parallel.define("test.parallel.broken", "return function(")
+    test.assert_true(ok == nil, "define rejects invalid source")
+    test.assert_type(err, "string", "define returns compile error")
+
+    local id
+    id, err = opengothic.parallel.map("test.parallel.unknown", { 1 }, function() end)
+    test.assert_true(id == nil and err == "unknown_module", "map rejects unknown module")
+
+    id, err = opengothic.parallel.map("test.parallel.square", { function() end }, function() end)
+    test.assert_true(id == nil and type(err) == "string", "map rejects non-encodable input")
+
+    local callOk = pcall(opengothic.parallel.map, "test.parallel.square", { 1 })
+    test.assert_eq(callOk, false, "map without callback outside of a task raises an error")
+
+    opengothic.async.run(function()
+        state.taskResults, state.taskErr = opengothic.parallel.map("test.parallel.square", { 2, 3, { 4, 5 }, "engine" })
+    end)
+
+    id = opengothic.parallel.map("test.parallel.square", { 6, "fail", 7 }, function(results, cbErr)
+        state.callbackResults = results
+        state.callbackErr = cbErr
+    end)
+    test.assert_type(id, "number", "map with callback returns job id")
+    test.assert_eq(opengothic.parallel.stats().pending >= 2, true, "jobs are pending until next update")
+
+    state.started = true
+end)
+
+opengothic.events.register("onUpdate", function()
+    if not state.started or state.done then
+        return false
+    end
+
+    state.updateTicks = state.updateTicks + 1
+    if state.updateTicks >= 5 then
+        test.assert_true(state.taskResults ~= nil, "task is resumed with results")
+        test.assert_true(state.taskErr == nil, "task job has no error")
+        test.assert_eq(state.taskResults[1], 4, "first result")
+        test.assert_eq(state.taskResults[2], 9, "second result")
+        test.assert_eq(state.taskResults[3].values[2], 25, "nested table result")
+        test.assert_eq(state.taskResults[4], true, "worker has no engine access")
+
+        test.assert_true(state.callbackResults ~= nil, "callback is called")
+        test.assert_eq(state.callbackResults[1], 36, "callback result")
+        test.assert_true(state.callbackResults[2] == nil, "failed item is nil")
+        test.assert_eq(state.callbackResults[3], 49, "items after a failure still run")
+        test.assert_type(state.callbackErr, "string", "callback gets first error")
+
+        test.assert_true(opengothic.parallel.stats().jobs >= 2, "stats counts completed jobs")
+        state.done = true
+        test.summary()
+    end
+
+    return false
+end)
+
+print("[Test] Parallel Map test loaded - runs on world load")
@@ -21,6 +21,10 @@ opengothic.events.register("onWorldLoaded", function()
     test.assert_type(opengothic.timer.every, "function", "every exists")
     test.assert_type(opengothic.timer.cancel, "function", "cancel exists")
     test.assert_type(opengothic.timer.everyGameMinute, "function", "everyGameMinute exists")
+    test.assert_type(opengothic.timer.stats, "function", "stats exists")
+
+    local before = opengothic.timer.stats()
+    state.firedBefore = before.fired
 
     -- Invalid argument handling
     local id, err = opengothic.timer.after(-1, function() end)
@@ -67,6 +71,11 @@ opengothic.events.register("onWorldLoaded", function()
     test.assert_type(minuteId, "number", "everyGameMinute returns timer id")
     test.assert_true(err == nil, "everyGameMinute success returns nil error")
     test.assert_eq(opengothic.timer.cancel(minuteId), true, "cancel succeeds for game-minute timer")
+    test.assert_eq(opengothic.timer.cancel(minuteId), false, "second cancel fails")
+
+    local stats = opengothic.timer.stats()
+    test.assert_eq(stats.active, before.active + 2, "stats counts active timers")
+    test.assert_eq(stats.cancelled, before.cancelled + 2, "stats counts cancelled timers")
 
     state.started = true
 end)
@@ -86,6 +95,7 @@ opengothic.events.register("onUpdate", function(dt)
         test.assert_eq(state.afterFired, 1, "after fires exactly once")
         test.assert_true(state.everyFired >= 3, "every fires repeatedly until canceled")
         test.assert_eq(state.canceledFired, false, "canceled timer callback does not fire")
+        test.assert_true(opengothic.timer.stats().fired >= state.firedBefore + 4, "stats counts fired callbacks")
         state.done = true
         test.summary()
     end
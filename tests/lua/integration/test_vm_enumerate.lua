@@ -0,0 +1,50 @@
+-- VM Enumerate Test Suite
+-- Validates vm.enumerate class filtering against the packed vm.enumerateIndices variant.
+
+local test = opengothic.test
+
+local function collect(className)
+    local indices = {}
+    opengothic.vm.enumerate(className, function(sym)
+        table.insert(indices, sym.index)
+    end)
+    return indices
+end
+
+opengothic.events.register("onWorldLoaded", function()
+    test.suite("VM Enumerate")
+
+    test.assert_type(opengothic.vm.enumerateIndices, "function", "vm.enumerateIndices exists")
+
+    local items = opengothic.vm.enumerateIndices("C_ITEM")
+    test.assert_type(items, "table", "enumerateIndices returns a table")
+    test.assert_true(#items > 0, "C_ITEM has instances")
+
+    local visited = collect("C_ITEM")
+    test.assert_eq(#visited, #items, "enumerate and enumerateIndices agree on count")
+    for i = 1, #items do
+        if visited[i] ~= items[i] then
+            test.assert_eq(visited[i], items[i], "enumerate and enumerateIndices agree on order")
+            break
+        end
+    end
+
+    local first = opengothic.vm.getSymbol("ITMI_GOLD")
+    if first ~= nil then
+        test.assert_true(table.find(items, first.index) ~= nil, "ITMI_GOLD is listed under C_ITEM")
+    end
+
+    local stopped = 0
+    opengothic.vm.enumerate("C_ITEM", function()
+        stopped = stopped + 1
+        return false
+    end)
+    test.assert_eq(stopped, 1, "returning false stops enumeration")
+
+    test.assert_eq(#opengothic.vm.enumerateIndices("NONEXISTENT_CLASS_12345"), 0, "unknown class yields no symbols")
+    test.assert_true(#opengothic.vm.enumerateIndices("") > #items, "empty class name lists all symbols")
+
+    test.summary()
+end)
+
+print("[Test] VM Enumerate test loaded - runs on world load")
@@ -26,7 +26,61 @@ opengothic.events.register("onWorldLoaded", function()
     test.assert_not_nil(player, "world:player() returns player")
     test.assert_true(player:isPlayer(), "returned npc is player")
 
-    -- Symbol resolution and find tests
+    -- Proxy identity: one handle per engine object
+    test.assert_true(player == opengothic.player(), "world:player() == opengothic.player()")
+    test.assert_true(world == player:world(), "opengothic.world() == player:world()")
+    test.assert_true(player:inventory() == player:inventory(), "inventory handle is stable")
+    local keyed = {}
+    keyed[player] = true
+    test.assert_true(keyed[world:player()] == true, "npc handle usable as table key")
+
+    -- k-nearest query: origin excluded, at most k results, sorted by distance
+    local nearestList = world:findNearestNpcs(player, 3, 5000)
+    test.assert_type(nearestList, "table", "findNearestNpcs returns table")
+    test.assert_true(#nearestList <= 3, "findNearestNpcs respects k")
+    local sorted = true
+    for i, npc in ipairs(nearestList) do
+        if npc == player then
+            sorted = false
+        end
+        if i > 1 and player:distanceTo(nearestList[i - 1]) > player:distanceTo(npc) then
+            sorted = false
+        end
+    end
+    test.assert_true(sorted, "findNearestNpcs excludes origin and sorts by distance")
+    if #nearestList > 0 then
+        test.assert_true(world:findNearestNpc(player, 5000) == nearestList[1], "findNearestNpc matches first of findNearestNpcs")
+    end
+
+    -- Batched npc access: struct-of-arrays snapshot and column writes
+    local snap = world:snapshotNpcs({ "npc", "position", "hp", "flags" })
+    test.assert_type(snap, "table", "snapshotNpcs returns table")
+    test.assert_true(snap.count > 0, "snapshot contains npcs")
+    test.assert_eq(#snap.id, snap.count, "id column has one row per npc")
+    test.assert_eq(#snap.x, snap.count, "position columns have one row per npc")
+    test.assert_eq(snap.level, nil, "columns not requested are omitted")
+    local playerRow = nil
+    for row = 1, snap.count do
+        if snap.npc[row] == player then
+            playerRow = row
+        end
+    end
+    test.assert_not_nil(playerRow, "player is in the snapshot")
+    if playerRow then
+        local flags = opengothic.CONSTANTS.NpcFlag
+        local px, py, pz = player:position()
+        test.assert_eq(snap.x[playerRow], px, "snapshot x matches npc:position()")
+        test.assert_eq(snap.hp[playerRow], player:attribute(opengothic.CONSTANTS.Attribute.ATR_HITPOINTS), "snapshot hp matches npc:attribute()")
+        test.assert_true(bit32.band(snap.flags[playerRow], flags.NPC_PLAYER) ~= 0, "player flag is set for the player")
+
+        local hp = snap.hp[playerRow]
+        local changed = world:applyNpcChanges({ id = { snap.id[playerRow] }, hp = { hp } })
+        test.assert_eq(changed, 1, "applyNpcChanges reports changed npcs")
+        test.assert_eq(world:applyNpcChanges({ id = { -1 }, hp = { 1 } }), 0, "applyNpcChanges skips invalid ids")
+        test.assert_eq(player:attribute(opengothic.CONSTANTS.Attribute.ATR_HITPOINTS), hp, "applyNpcChanges writes hp")
+    end
+    test.assert_true(not pcall(world.snapshotNpcs, world, { "bogus" }), "snapshotNpcs rejects unknown fields")
+
     local heroId = opengothic.resolve("PC_HERO")
     if heroId then
         test.assert_type(heroId, "number", "resolve returns number for valid symbol")
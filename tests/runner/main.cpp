@@ -0,0 +1,242 @@
+#include <Tempest/Log>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "scripting/scriptengine.h"
+#include "commandline.h"
+#include "gothic.h"
+#include "world/world.h"
+#include "world/objects/npc.h"
+#include "world/objects/interactive.h"
+
+#include "stubscene.h"
+
+// luatests [root] [--filter <substr>] [--frames <n>] [--budget <ms>] [--no-timing] [-v]
+// luatests --think-check <ticks>
+//
+// Runs every *.lua below root (tests/lua by default) in its own ScriptEngine over the stub
+// world: the scene is built, the file is loaded, onStartGame/onWorldLoaded and
+// onOpen(player, chest) are raised and the world is updated for a number of frames so that
+// async tasks and timers get to run. A file passes when it loads, no script error was
+// logged and opengothic.test saw no failure.
+//
+// --think-check ticks the scene with perception on for every npc, once per npcThink mode,
+// and passes when all runs end with the same World::stateHash.
+
+using namespace Tempest;
+
+namespace {
+  struct Options {
+    std::string root   = "tests/lua";
+    std::string filter;
+    int         frames = 180;
+    double      budget = 50.0;
+    bool        timing = true;
+    bool        verbose = false;
+    int         thinkCheck = 0;
+    };
+
+  struct EntryTotal {
+    uint64_t calls = 0;
+    double   ms    = 0;
+    };
+
+  // output of the engine for the file that is running
+  struct Capture {
+    std::string output;
+    uint32_t    errors = 0;
+    bool        echo   = false;
+
+    void onPrint(std::string_view msg) { Log::i("[message] ", msg); }
+    };
+  Capture capture;
+
+  bool parseArgs(int argc, char** argv, Options& opt) {
+    for(int i=1; i<argc; ++i) {
+      const char* a = argv[i];
+      if(std::strcmp(a, "--filter")==0 && i+1<argc)
+        opt.filter = argv[++i];
+      else if(std::strcmp(a, "--frames")==0 && i+1<argc)
+        opt.frames = std::max(0, std::atoi(argv[++i]));
+      else if(std::strcmp(a, "--budget")==0 && i+1<argc)
+        opt.budget = std::atof(argv[++i]);
+      else if(std::strcmp(a, "--think-check")==0 && i+1<argc)
+        opt.thinkCheck = std::max(1, std::atoi(argv[++i]));
+      else if(std::strcmp(a, "--no-timing")==0)
+        opt.timing = false;
+      else if(std::strcmp(a, "-v")==0)
+        opt.verbose = true;
+      else if(a[0]!='-')
+        opt.root = a;
+      else {
+        std::fprintf(stderr, "luatests: unknown argument '%s'\n", a);
+        return false;
+        }
+      }
+    return true;
+    }
+
+  std::vector<std::filesystem::path> collect(const Options& opt) {
+    std::vector<std::filesystem::path> ret;
+    std::error_code ec;
+    for(auto& e : std::filesystem::recursive_directory_iterator(opt.root, ec)) {
+      if(!e.is_regular_file() || e.path().extension()!=".lua")
+        continue;
+      if(!opt.filter.empty() && e.path().generic_string().find(opt.filter)==std::string::npos)
+        continue;
+      ret.push_back(e.path());
+      }
+    std::sort(ret.begin(), ret.end());
+    return ret;
+    }
+
+  int testCounter(ScriptEngine& engine, const char* name) {
+    const std::string ret = engine.executeString(std::string("return opengothic.test.") + name);
+    return std::atoi(ret.c_str());
+    }
+
+  bool runFile(const Options& opt, const std::filesystem::path& file, std::map<std::string, EntryTotal>& totals) {
+    capture        = Capture();
+    capture.echo   = opt.verbose;
+
+    CommandLine cmd(uint32_t(std::max(0.0, opt.budget)));
+    Gothic      gothic;
+    gothic.setWorld(std::make_unique<World>());
+    buildScene(*gothic.world());
+    gothic.onPrint.bind(&capture, &Capture::onPrint);
+
+    World& world = *gothic.world();
+    bool   ok    = false;
+    int    passed = 0, failed = 0;
+    {
+    ScriptEngine engine;
+    engine.initialize();
+    engine.setProfiling(opt.timing);
+    engine.loadModScripts();
+    ok = engine.loadGlobalScript(file.string());
+    if(ok) {
+      gothic.onStartGame("NEWWORLD.ZEN");
+      gothic.onWorldLoaded();
+      if(gothic.onOpen && world.player()!=nullptr && world.mobsiById(0)!=nullptr)
+        gothic.onOpen(*world.player(), *world.mobsiById(0));
+      for(int i=0; i<opt.frames; ++i) {
+        world.tick(16);
+        engine.update(1.f/60.f);
+        }
+      }
+    passed = testCounter(engine, "_passed");
+    failed = testCounter(engine, "_failed");
+
+    for(auto& r : engine.scriptProfiler().rows()) {
+      auto& t = totals[std::string(ScriptProfiler::kindName(r.kind)) + " " + r.label];
+      t.calls += r.calls;
+      t.ms    += r.ms;
+      }
+    }
+    ok = ok && failed==0 && capture.errors==0;
+
+    std::printf("%s %s (%d passed, %d failed)\n", ok ? "PASS" : "FAIL", file.generic_string().c_str(), passed, failed);
+    if(!ok && !opt.verbose)
+      std::fputs(capture.output.c_str(), stdout);
+    return ok;
+    }
+
+  uint64_t thinkRun(WorldObjects::NpcThink mode, int ticks, WorldObjects::ThinkStats& st, uint64_t& start) {
+    CommandLine cmd(0);
+    Gothic      gothic;
+    gothic.setWorld(std::make_unique<World>());
+    World& world = *gothic.world();
+    buildScene(world);
+    for(uint32_t i=0; i<world.npcCount(); ++i)
+      world.npcById(i)->setPerception(true);
+    world.setNpcThink(mode);
+    start = world.stateHash();
+    for(int i=0; i<ticks; ++i)
+      world.tick(16);
+    st = world.thinkStats();
+    return world.stateHash();
+    }
+
+  bool thinkCheck(int ticks) {
+    static const WorldObjects::NpcThink modes[] = {WorldObjects::NpcThink::Serial, WorldObjects::NpcThink::Parallel,
+                                                   WorldObjects::NpcThink::Verify};
+    static const char* names[] = {"serial", "parallel", "verify"};
+
+    bool     ok = true;
+    uint64_t ref = 0;
+    for(size_t i=0; i<3; ++i) {
+      WorldObjects::ThinkStats st;
+      uint64_t start = 0;
+      const uint64_t h = thinkRun(modes[i], ticks, st, start);
+      std::printf("%-8s stateHash %016llx, %llu rays cast ahead, %llu reused, %llu mismatches\n", names[i],
+                  (unsigned long long)h, (unsigned long long)st.thinkRays, (unsigned long long)st.hits,
+                  (unsigned long long)st.mismatches);
+      if(i==0) {
+        ref = h;
+        // nothing moved: the runs would agree without testing anything
+        if(h==start) {
+          std::printf("FAIL npc think: the scene did not change in %d ticks\n", ticks);
+          return false;
+          }
+        continue;
+        }
+      if(h!=ref || st.hits==0 || st.mismatches!=0 || st.serialHash!=st.parallelHash)
+        ok = false;
+      }
+    std::printf("%s npc think: serial and parallel %s after %d ticks\n", ok ? "PASS" : "FAIL", ok ? "agree" : "differ", ticks);
+    return ok;
+    }
+
+  void printTimings(const std::map<std::string, EntryTotal>& totals) {
+    std::vector<std::pair<std::string, EntryTotal>> rows;
+    for(auto& [name, t] : totals)
+      if(t.calls>0)
+        rows.emplace_back(name, t);
+    std::sort(rows.begin(), rows.end(), [](auto& a, auto& b) { return a.second.ms > b.second.ms; });
+
+    std::printf("\n%-40s %10s %12s %10s\n", "entry", "calls", "total ms", "us/call");
+    for(auto& [name, t] : rows)
+      std::printf("%-40s %10llu %12.3f %10.2f\n", name.c_str(), (unsigned long long)t.calls,
+                  t.ms, t.ms*1000.0/double(t.calls));
+    }
+  }
+
+int main(int argc, char** argv) {
+  Options opt;
+  if(!parseArgs(argc, argv, opt))
+    return 2;
+  if(opt.thinkCheck>0)
+    return thinkCheck(opt.thinkCheck) ? 0 : 1;
+
+  const auto files = collect(opt);
+  if(files.empty()) {
+    std::fprintf(stderr, "luatests: no test files under '%s'\n", opt.root.c_str());
+    return 2;
+    }
+
+  Log::setOutputCallback([](Log::Mode mode, const char* text) {
+    if(mode==Log::Error)
+      ++capture.errors;
+    capture.output += text;
+    capture.output += '\n';
+    if(capture.echo)
+      std::printf("%s\n", text);
+    });
+
+  std::map<std::string, EntryTotal> totals;
+  size_t failedFiles = 0;
+  for(auto& f : files)
+    failedFiles += runFile(opt, f, totals) ? 0 : 1;
+
+  if(opt.timing)
+    printTimings(totals);
+  std::printf("\n%zu/%zu test files passed\n", files.size()-failedFiles, files.size());
+  return failedFiles==0 ? 0 : 1;
+  }
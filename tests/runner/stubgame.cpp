@@ -0,0 +1,92 @@
+#include "gothic.h"
+#include "commandline.h"
+#include "resources.h"
+
+#include <cassert>
+
+// fonts are never measured or drawn by the runner
+class GthFont final {};
+
+static CommandLine* cmdInstance = nullptr;
+
+CommandLine::CommandLine(uint32_t luaBudgetMs)
+  :luaBudget(luaBudgetMs) {
+  cmdInstance = this;
+  }
+
+const CommandLine& CommandLine::inst() {
+  assert(cmdInstance!=nullptr);
+  return *cmdInstance;
+  }
+
+std::u16string CommandLine::nestedPath(const std::initializer_list<const char16_t*>&, Tempest::Dir::FileType) const {
+  return std::u16string();
+  }
+
+const GthFont& Resources::font(std::string_view, FontType, const float) {
+  static GthFont fnt;
+  return fnt;
+  }
+
+// in-memory part of game/game/questlog.cpp; save/load needs the zip archive and is not used
+QuestLog::QuestLog() {
+  }
+
+QuestLog::Quest& QuestLog::add(std::string_view name, Section s) {
+  if(auto m = find(name))
+    return *m;
+  Quest q;
+  q.name    = name;
+  q.section = s;
+  quests.emplace_back(q);
+  return quests.back();
+  }
+
+void QuestLog::setStatus(std::string_view name, QuestLog::Status s) {
+  auto m = find(name);
+  if(m==nullptr && s==Status::Obsolete)
+    return;
+  auto& q  = add(name,Mission);
+  q.status = s;
+  }
+
+void QuestLog::addEntry(std::string_view name, std::string_view entry) {
+  if(auto m = find(name))
+    m->entry.emplace_back(entry);
+  }
+
+QuestLog::Quest* QuestLog::find(std::string_view name) {
+  for(auto& i:quests)
+    if(i.name==name)
+      return &i;
+  return nullptr;
+  }
+
+Gothic* Gothic::instance = nullptr;
+
+Gothic::Gothic() {
+  assert(instance==nullptr);
+  instance = this;
+  }
+
+Gothic::~Gothic() {
+  wrld.reset();
+  instance = nullptr;
+  }
+
+Gothic& Gothic::inst() {
+  assert(instance!=nullptr);
+  return *instance;
+  }
+
+void Gothic::setWorld(std::unique_ptr<World>&& w) {
+  wrld = std::move(w);
+  }
+
+const VisualFx* Gothic::loadVisualFx(std::string_view) {
+  // no effect data: world:playEffect reports the effect as not started
+  return nullptr;
+  }
+
+void Gothic::emitGlobalSound(std::string_view) {
+  }
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <Tempest/Dir>
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+
+// Command line of the runner: no game directory, no bytecode cache, no native code and no
+// file watcher; only the execution budget is configurable (luatests --budget).
+class CommandLine {
+  public:
+    explicit CommandLine(uint32_t luaBudgetMs);
+    static const CommandLine& inst();
+
+    enum LuaNative : uint8_t {
+      NativeAll,
+      NativeAnnotated,
+      NativeOff,
+      };
+    std::u16string      nestedPath(const std::initializer_list<const char16_t*> &name, Tempest::Dir::FileType type) const;
+
+    bool                isLuaBytecodeCache() const { return false;        }
+    uint32_t            luaBudgetMs()      const { return luaBudget;      }
+    uint32_t            luaMemSoftMb()     const { return 64;             }
+    uint32_t            luaMemHardMb()     const { return 256;            }
+    LuaNative           luaNative()        const { return NativeOff;      }
+    bool                isLuaWatch()       const { return false;          }
+
+  private:
+    uint32_t            luaBudget = 50;
+  };
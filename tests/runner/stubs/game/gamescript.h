@@ -0,0 +1,52 @@
+#pragma once
+
+#include <zenkit/DaedalusVm.hh>
+#include <zenkit/addon/daedalus.hh>
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class ScriptFn final {
+  public:
+    ScriptFn()=default;
+    ScriptFn(size_t v):ptr(v){}
+
+    size_t ptr=size_t(-1);
+
+    bool isValid() const { return ptr!=size_t(-1); }
+
+  friend bool operator == (const ScriptFn& a,const ScriptFn& b) {
+    return a.ptr==b.ptr;
+    }
+  };
+
+// Script side of the runner world: the VM image built by buildScene and the lookups of
+// GameScript that ScriptEngine uses. There are no spells; spellDesc returns an empty C_SPELL.
+class GameScript final {
+  public:
+    GameScript();
+
+    inline auto& getVm() { return vm; }
+
+    auto*                       goldId() const { return itMi_Gold; }
+    void                        setGoldId(zenkit::DaedalusSymbol* sym) { itMi_Gold = sym; }
+    float                       tradeValueMultiplier() const { return tradeValMult; }
+
+    zenkit::DaedalusSymbol*     findSymbol(std::string_view s);
+    zenkit::DaedalusSymbol*     findSymbol(const size_t s);
+    size_t                      findSymbolIndex(std::string_view s);
+    size_t                      symbolsCount() const;
+    auto                        symbolsWithParent(size_t parent) -> std::span<const uint32_t>;
+
+    const zenkit::ISpell&       spellDesc(int32_t splId);
+
+  private:
+    zenkit::DaedalusVm                                  vm;
+    zenkit::DaedalusSymbol*                             itMi_Gold    = nullptr;
+    float                                               tradeValMult = 0.1f; // TRADE_VALUE_MULTIPLIER
+    zenkit::ISpell                                      noSpell;
+    std::unordered_map<size_t, std::vector<uint32_t>>   symByParent;
+  };
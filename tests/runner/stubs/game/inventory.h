@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <string_view>
+#include <string>
+
+#include "game/constants.h"
+
+class Item;
+class World;
+class Npc;
+class Interactive;
+
+// Inventory of the runner: a flat list of stacks, one per item class. Equipping only flags
+// the item; the active weapon is the first equipped melee or ranged weapon.
+class Inventory final {
+  public:
+    Inventory();
+    Inventory(Inventory&&)=default;
+    Inventory& operator = (Inventory&&)=default;
+    ~Inventory();
+
+    bool         isEmpty() const { return items.empty(); }
+
+    enum IteratorType : uint8_t {
+      T_Inventory,
+      T_Trade,
+      T_Ransack,
+      };
+
+    class Iterator {
+      public:
+        const Item& operator*   () const;
+        const Item* operator -> () const;
+
+        size_t      count() const;
+        bool        isEquipped() const;
+
+        Iterator&   operator++();
+
+        bool        isValid() const;
+
+      private:
+        Iterator(IteratorType t, const Inventory* owner);
+        void skipHidden();
+
+        IteratorType     type  = T_Inventory;
+        const Inventory* owner = nullptr;
+        size_t           at    = 0;
+      friend class Inventory;
+      };
+
+    Iterator     iterator(IteratorType t) const;
+
+    size_t       itemCount(const size_t id) const;
+
+    static void  transfer(Inventory& to, Inventory& from, Npc *fromNpc, size_t cls, size_t count, World &wrld);
+
+    Item*  getItem(size_t instance);
+    Item*  addItem(std::unique_ptr<Item>&& p);
+    Item*  addItem(size_t cls, size_t count, World &owner);
+    bool   equip  (size_t cls, Npc &owner, bool force);
+
+    const Item*  activeWeapon() const;
+    Item*  activeWeapon();
+
+  private:
+    std::vector<std::unique_ptr<Item>> items;
+  };
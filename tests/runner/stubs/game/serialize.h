@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// In-memory stand-in for the save archive: the same write/read interface over a byte buffer,
+// so that the save/load paths of ScriptEngine can be round-tripped without a zip file.
+class Serialize final {
+  public:
+    Serialize() = default;
+
+    template<class ... Arg>
+    void write(const Arg& ... a){
+      (implWrite(a),... );
+      }
+
+    template<class ... Arg>
+    void read(Arg& ... a){
+      (implRead(a),... );
+      }
+
+    // restarts reading from the beginning of the written data
+    void rewind() { at = 0; }
+    bool isEof() const { return at>=data.size(); }
+
+  private:
+    template<class T, std::enable_if_t<std::is_arithmetic<T>::value,bool> = true>
+    void implWrite(T i) { writeBytes(&i,sizeof(i)); }
+    template<class T, std::enable_if_t<std::is_arithmetic<T>::value,bool> = true>
+    void implRead (T& i) { readBytes(&i,sizeof(i)); }
+
+    void implWrite(const std::string& s) {
+      implWrite(uint32_t(s.size()));
+      writeBytes(s.data(),s.size());
+      }
+    void implRead (std::string& s) {
+      uint32_t sz = 0;
+      implRead(sz);
+      s.resize(sz);
+      readBytes(s.data(),sz);
+      }
+
+    void writeBytes(const void* v,size_t sz) {
+      auto b = reinterpret_cast<const uint8_t*>(v);
+      data.insert(data.end(),b,b+sz);
+      }
+    void readBytes (void* v,size_t sz) {
+      if(at+sz>data.size()) {
+        std::memset(v,0,sz);
+        at = data.size();
+        return;
+        }
+      std::memcpy(v,data.data()+at,sz);
+      at += sz;
+      }
+
+    std::vector<uint8_t> data;
+    size_t               at = 0;
+  };
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <Tempest/Signal>
+
+#include <functional>
+#include <memory>
+#include <string_view>
+
+#include "game/questlog.h"
+#include "world/world.h"
+
+class GthFont;
+class Interactive;
+class Item;
+class Npc;
+class VisualFx;
+
+// Game instance of the runner: owns the stub world and carries the script hooks of the real
+// Gothic class with the same types, so ScriptEngine binds to them unchanged. The hooks are
+// raised by the stub objects at the same points as in the game (death, removal, ...) and by
+// the runner for the lifecycle signals.
+class Gothic final {
+  public:
+    Gothic();
+    ~Gothic();
+
+    static Gothic& inst();
+
+    enum class LoadState:int {
+      Idle       = 0,
+      Loading    = 1,
+      Saving     = 2,
+      Finalize   = 3,
+      FailedLoad = 4,
+      FailedSave = 5
+      };
+
+    World*       world() { return wrld.get(); }
+    void         setWorld(std::unique_ptr<World>&& w);
+
+    auto         questLog() const -> const QuestLog* { return &quests; }
+    auto         loadVisualFx  (std::string_view name) -> const VisualFx*;
+    void         emitGlobalSound(std::string_view sfx);
+    LoadState    checkLoading() const { return LoadState::Idle; }
+
+    Tempest::Signal<void(std::string_view)>                             onStartGame;
+    Tempest::Signal<void(std::string_view)>                             onLoadGame;
+    Tempest::Signal<void(std::string_view,std::string_view)>            onSaveGame;
+
+    std::function<bool(Npc&, Interactive&)>                             onOpen;
+    std::function<bool(Npc&, Npc&)>                                     onRansack;
+    std::function<bool(Npc&, Npc&, bool, int)>                          onNpcTakeDamage;
+    std::function<bool(Npc&, Npc*, bool)>                               onNpcDeath;      // victim, killer, isDeath (vs unconscious)
+    std::function<bool(Npc&, Item&)>                                    onItemPickup;
+    std::function<bool(Npc&, Npc&)>                                     onDialogStart;   // npc, player
+    std::function<bool(Npc&, Npc&, std::string_view)>                   onDialogOption;  // npc, player, infoName - return true to hide option
+    std::function<bool(Npc&, Npc*, int)>                                onSpellCast;     // caster, target, spellId
+    std::function<bool(Npc&, Item&)>                                    onUseItem;       // npc, item
+    std::function<bool(Npc&, Item&)>                                    onEquip;         // npc, item
+    std::function<bool(Npc&, Item&)>                                    onUnequip;       // npc, item
+    std::function<bool(Npc&, size_t, size_t)>                          onDropItem;      // npc, itemId, count
+    std::function<bool(Npc&, int)>                                      onDrawWeapon;    // npc, weaponType
+    std::function<bool(Npc&)>                                           onCloseWeapon;   // npc
+    std::function<bool(Npc&, Npc&, int)>                                onNpcPerception; // npc, other, percType
+    std::function<bool(Npc&, Npc&, size_t, size_t, bool)>               onTrade;         // buyer, seller, itemId, count, isBuying
+    std::function<void(Npc&)>                                           onNpcSpawn;      // npc (notification only)
+    std::function<void(Npc&)>                                           onNpcRemove;     // npc (notification only)
+    std::function<void(const Item&)>                                    onItemRemove;    // item (notification only, removed from world or destroyed in an inventory)
+    std::function<bool(Npc&, Interactive&)>                             onMobInteract;   // npc, mob
+    std::function<bool(Npc&)>                                           onJump;          // npc
+    std::function<void(Npc&)>                                           onSwimStart;     // npc (notification only)
+    std::function<void(Npc&)>                                           onSwimEnd;       // npc (notification only)
+    std::function<void(Npc&)>                                           onDiveStart;     // npc (notification only)
+    std::function<void(Npc&)>                                           onDiveEnd;       // npc (notification only)
+
+    Tempest::Signal<void(std::string_view,int,int,int,const GthFont&)>  onPrintScreen;
+    Tempest::Signal<void(std::string_view)>                             onPrint;
+    Tempest::Signal<void()>                                             onWorldLoaded;
+    Tempest::Signal<void()>                                             onStartLoading;
+    Tempest::Signal<void()>                                             onSessionExit;
+    Tempest::Signal<void()>                                             onSettingsChanged;
+
+  private:
+    std::unique_ptr<World>                  wrld;
+    QuestLog                                quests;
+    static Gothic*                          instance;
+  };
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <Tempest/Point>
+
+class World;
+class Npc;
+class VisualFx;
+
+// Effect of the runner: remembers what was started and where, nothing is rendered.
+class Effect final {
+  public:
+    Effect() = default;
+    Effect(Effect&&) = default;
+    Effect(const VisualFx& vfx, World& owner, const Tempest::Vec3& pos);
+    ~Effect() = default;
+
+    Effect&  operator = (Effect&&) = default;
+    const VisualFx* handle() const { return root; }
+    auto     position() const -> const Tempest::Vec3& { return pos; }
+
+    void     setTarget(const Npc* npc) { target = npc; }
+
+  private:
+    const VisualFx* root   = nullptr;
+    const Npc*      target = nullptr;
+    Tempest::Vec3   pos;
+  };
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+class GthFont;
+
+// Resources of the runner: there is nothing to render, fonts are opaque handles.
+class Resources final {
+  public:
+    enum class FontType : uint8_t {
+      Normal,
+      Hi,
+      Disabled,
+      Yellow,
+      Red
+      };
+
+    static const GthFont& font(std::string_view fname, FontType type, const float scale);
+  };
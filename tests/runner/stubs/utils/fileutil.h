@@ -0,0 +1,8 @@
+#pragma once
+
+#include <Tempest/Dir>
+#include <string>
+
+// The runner reads no game data: ScriptEngine includes this header, but calls nothing from it.
+namespace FileUtil {
+  }
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <Tempest/Point>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "game/inventory.h"
+
+class Npc;
+class World;
+
+// Mob of the runner: focus name, scheme and lock state, a container inventory and a
+// two-state use cycle (attach moves it to state 1, detach back to 0) with no animation.
+class Interactive final {
+  public:
+    struct Desc final {
+      std::string   focusName;
+      std::string   scheme;
+      bool          container = false;
+      bool          door      = false;
+      bool          ladder    = false;
+      bool          locked    = false;
+      Tempest::Vec3 pos;
+      };
+
+    Interactive(World& world, Desc&& desc);
+    Interactive(const Interactive&)=delete;
+
+    std::string_view    focusName() const { return desc.focusName; }
+    std::string_view    displayName() const { return desc.focusName; }
+
+    int32_t             stateId() const { return state; }
+    int32_t             stateCount() const { return 1; }
+    std::string_view    schemeName() const { return desc.scheme; }
+
+    bool                isContainer() const { return desc.container; }
+    bool                isDoor() const { return desc.door; }
+    bool                isTrueDoor(const Npc& npc) const;
+    bool                isLadder() const { return desc.ladder; }
+    void                setAsCracked(bool c) { isLockCracked = c; }
+    bool                isCracked() const { return isLockCracked; }
+    bool                needToLockpick(const Npc& pl) const;
+
+    Inventory&          inventory() { return invent; }
+    Tempest::Vec3       position() const { return desc.pos; }
+    float               qDistTo(const Npc& npc) const;
+
+    bool                attach (Npc& npc);
+    bool                detach(Npc& npc,bool quick);
+
+  private:
+    Desc                desc;
+    Inventory           invent;
+    int32_t             state         = 0;
+    bool                isLockCracked = false;
+  };
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <Tempest/Point>
+
+#include <zenkit/addon/daedalus.hh>
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+#include "game/constants.h"
+
+class World;
+class Npc;
+
+// Item of the runner: the C_ITEM instance plus count, equip state and a position.
+class Item final {
+  public:
+    enum Type : uint8_t {
+      T_World,
+      T_WorldDyn,
+      T_Inventory,
+      };
+
+    Item(World& owner, size_t inst, Type type);
+    Item(const Item&)=delete;
+    ~Item();
+
+    void    setPosition  (float x,float y,float z) { pos = {x,y,z}; }
+
+    bool    isMission() const;
+    bool    isEquipped() const { return equipped>0; }
+    void    setAsEquipped(bool e) { equipped = e ? 1 : 0; }
+
+    std::string_view    displayName() const;
+    std::string_view    description() const;
+    Tempest::Vec3       position() const { return pos; }
+    bool                isGold() const;
+    ItmFlags            mainFlag() const;
+    int32_t             itemFlag() const;
+
+    bool                isMulti() const;
+    bool                is2H() const;
+    bool                isCrossbow() const;
+    bool                isRing() const;
+    bool                isArmor() const;
+    bool                isSpellShoot() const;
+    bool                isSpellOrRune() const;
+    bool                isSpell() const;
+    bool                isRune() const;
+
+    void                setCount(size_t cnt);
+    size_t              count() const;
+
+    int32_t             cost() const;
+    int32_t             sellCost() const;
+
+    const zenkit::IItem&                   handle() const { return *hitem; }
+    zenkit::IItem&                         handle() { return *hitem; }
+    const std::shared_ptr<zenkit::IItem>&  handlePtr()    { return hitem; }
+    size_t                                 clsId() const;
+
+  private:
+    World&                         owner;
+    std::shared_ptr<zenkit::IItem> hitem;
+    Tempest::Vec3                  pos;
+    size_t                         amount   = 1;
+    uint8_t                        equipped = 0;
+  };
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <Tempest/Point>
+
+#include <zenkit/addon/daedalus.hh>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+#include "game/constants.h"
+#include "game/inventory.h"
+#include "world/aiqueue.h"
+#include "world/sensecache.h"
+
+class World;
+class Item;
+class Interactive;
+class Effect;
+
+// Npc of the runner: attributes, talents and protection live in the C_NPC instance, as in
+// the game; position, body state and the ai queue are plain fields with no animation behind.
+class Npc final {
+  public:
+    Npc(World& owner, size_t instance, NpcProcessPolicy aiPolicy = NpcProcessPolicy::AiNormal);
+    Npc(const Npc&)=delete;
+    ~Npc();
+
+    bool       setPosition (float x,float y,float z);
+    bool       setPosition (const Tempest::Vec3& pos);
+    void       setDirectionY(float rotation);
+    auto       position()   const -> Tempest::Vec3 { return pos; }
+    float      rotation() const  { return angle;  }
+    float      rotationY() const { return angleY; }
+
+    bool       isPlayer() const;
+    void       setProcessPolicy(NpcProcessPolicy t) { aiPolicy = t; }
+    void       setWalkMode(WalkBit m) { wlkMode = m; }
+    auto       walkMode() const { return wlkMode; }
+
+    auto       world() -> World& { return owner; }
+
+    float      qDistTo(const Tempest::Vec3 pos) const;
+    float      qDistTo(const Npc& p) const;
+    float      qDistTo(const Interactive& p) const;
+    float      qDistTo(const Item& p) const;
+
+    std::string_view displayName() const;
+
+    void       setTalentSkill(Talent t,int32_t lvl);
+    int32_t    talentSkill(Talent t) const;
+    void       setTalentValue(Talent t,int32_t lvl);
+    int32_t    talentValue(Talent t) const;
+    int32_t    hitChance(Talent t) const;
+
+    int32_t    attribute (Attribute a) const;
+    void       changeAttribute(Attribute a, int32_t val, bool allowUnconscious);
+    int32_t    protection(Protection p) const;
+    void       changeProtection(Protection p, int32_t val);
+
+    uint32_t   instanceSymbol() const;
+    uint32_t   guild() const;
+    int32_t    level() const;
+    int32_t    experience() const;
+    int32_t    learningPoints() const;
+
+    void       setAttitude(Attitude att) { permAttitude = att; }
+    Attitude   attitude() const { return permAttitude; }
+
+    BodyState  bodyState() const { return bodySt; }
+    void       setBodyState(BodyState s) { bodySt = s; }
+    bool       hasState(BodyState s) const;
+
+    void       aiPush(AiQueue::AiAction&& a);
+    void       clearAiQueue();
+
+    int32_t    activeSpellLevel() const { return -1; }
+
+    bool       isDead() const { return dead; }
+    bool       isUnconscious() const { return unconscious; }
+    bool       isDown() const { return dead || unconscious; }
+    bool       isTalk() const { return talking; }
+
+    void       setPerceptionTime(uint64_t time) { perceptionTime = time; }
+    // perception of the runner, off unless enabled: the player is seen when no interactive is in
+    // the line of sight. Seen, the npc walks towards the player, otherwise it circles around him
+    void       setPerception(bool enable) { percEnabled = enable; }
+    uint64_t   percNextTime() const { return percNext; }
+    void       thinkPerception(const Npc& pl, bool verify);
+    void       perceptionProcess(const Npc& pl);
+    auto       senseStats() const -> const SenseCache::Stats& { return sense.stats(); }
+
+    zenkit::INpc&                        handle() { return *hnpc; }
+    const std::shared_ptr<zenkit::INpc>& handlePtr() const { return hnpc; }
+
+    auto       inventory() const -> const Inventory& { return invent; }
+    auto       inventory()       ->       Inventory& { return invent; }
+    size_t     itemCount  (size_t id) const;
+    Item*      activeWeapon();
+    Item*      getItem    (size_t id);
+    Item*      addItem    (size_t id, size_t amount);
+    Item*      addItem    (std::unique_ptr<Item>&& i);
+
+    void       setTarget(Npc* t) { currentTarget = t; }
+    Npc*       target() const { return currentTarget; }
+
+    void       runEffect(Effect&& e);
+
+  private:
+    bool       canSeeNpc(const Npc& pl) const;
+
+    World&                        owner;
+    std::shared_ptr<zenkit::INpc> hnpc;
+    Inventory                     invent;
+    NpcProcessPolicy              aiPolicy       = NpcProcessPolicy::AiNormal;
+    Tempest::Vec3                 pos;
+    float                         angle          = 0;
+    float                         angleY         = 0;
+    WalkBit                       wlkMode        = WalkBit::WM_Run;
+    Attitude                      permAttitude   = ATT_NULL;
+    BodyState                     bodySt         = BS_STAND;
+    bool                          dead           = false;
+    bool                          unconscious    = false;
+    bool                          talking        = false;
+    uint64_t                      perceptionTime = 0;
+    bool                          percEnabled    = false;
+    uint64_t                      percNext       = 0;
+    mutable SenseCache            sense;
+    Npc*                          currentTarget  = nullptr;
+    AiQueue                       aiQueue;
+
+    std::array<int32_t,TALENT_MAX_G2> talentsSk = {};
+    std::array<int32_t,TALENT_MAX_G2> talentsVl = {};
+  };
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <Tempest/Point>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "game/gamescript.h"
+#include "game/gametime.h"
+#include "world/objects/interactive.h"
+#include "world/objects/item.h"
+#include "world/objects/npc.h"
+
+class Effect;
+
+// Counters and settings of the npc think and ai-lod passes, as declared by the game.
+class WorldObjects final {
+  public:
+    enum class NpcThink : uint8_t {
+      Serial,
+      Parallel,
+      Verify,
+      };
+    struct ThinkStats {
+      uint64_t       ticks      = 0;
+      uint64_t       npcs       = 0;
+      uint64_t       thinkRays  = 0;
+      uint64_t       hits       = 0;
+      uint64_t       misses     = 0;
+      uint64_t       mismatches = 0;
+      uint64_t       serialHash   = 14695981039346656037ull;
+      uint64_t       parallelHash = 14695981039346656037ull;
+      };
+    struct AiLod {
+      uint32_t       farPeriod  = 2;
+      uint32_t       far2Period = 8;
+      uint32_t       farBudget  = 0;
+      uint32_t       far2Budget = 0;
+      };
+    struct AiLodStats {
+      static constexpr size_t PolicyCount = 4;
+      uint64_t       frames                = 0;
+      uint32_t       ticked  [PolicyCount] = {};
+      uint32_t       skipped [PolicyCount] = {};
+      uint32_t       deferred              = 0;
+      uint64_t       total   [PolicyCount] = {};
+      };
+  };
+
+// World of the runner: npcs, ground items and interactives in flat lists, a game clock and
+// the waypoints of the scene. No rendering or AI; the only physics are rays against the
+// interactives, for the perception pass of tick. Objects notify the script hooks of Gothic
+// where the game does.
+class World final {
+  public:
+    World();
+    World(const World&)=delete;
+    ~World();
+
+    uint32_t             npcCount() const { return uint32_t(npcArr.size()); }
+    Npc*                 npcById(uint32_t id);
+    Interactive*         mobsiById(uint32_t id);
+
+    void                 detectNpc (const Tempest::Vec3& p, const float r, const std::function<void(Npc&)>& f);
+    void                 findNearestNpcs(const Tempest::Vec3& p, const float r, size_t k, const Npc* exclude, std::vector<Npc*>& out) const;
+    void                 detectItem(const Tempest::Vec3& p, const float r, const std::function<void(Item&)>& f);
+
+    void                 setNpcThink(WorldObjects::NpcThink m) { thinkMode = m; }
+    auto                 npcThink() const -> WorldObjects::NpcThink { return thinkMode; }
+    auto                 thinkStats() const -> const WorldObjects::ThinkStats& { return thinkSt; }
+    void                 resetThinkStats() { thinkSt = WorldObjects::ThinkStats(); }
+    // FNV-1a over npc position, rotation, hp, mana and state
+    uint64_t             stateHash() const;
+    // true if an interactive is in the way
+    bool                 ray(const Tempest::Vec3& from, const Tempest::Vec3& to) const;
+    void                 setAiLod(const WorldObjects::AiLod& l) { lod = l; }
+    auto                 aiLod() const -> const WorldObjects::AiLod& { return lod; }
+    auto                 aiLodStats() const -> const WorldObjects::AiLodStats& { return lodSt; }
+    void                 resetAiLodStats() { lodSt = WorldObjects::AiLodStats(); }
+
+    GameScript&          script() const { return *game; }
+
+    void                 runEffect(Effect&& e);
+
+    Npc*                 player() const { return npcPlayer; }
+    void                 setPlayer(Npc* npc);
+    Npc*                 findNpcByInstance(size_t instance, size_t n = 0);
+    Item*                findItemByInstance(size_t instance, size_t n = 0);
+
+    // one game minute per second of frame time; runs the perception pass as WorldObjects::tick does
+    void                 tick(uint64_t dt);
+    uint64_t             tickCount() const { return tickCnt; }
+    void                 setDayTime(int32_t h,int32_t min);
+    gtime                time() const { return wtime; }
+
+    Npc*                 addNpc     (size_t npcInstance,    std::string_view     at);
+    Npc*                 addNpc     (size_t npcInstance,    const Tempest::Vec3& at);
+    void                 removeNpc  (Npc& npc);
+
+    Item*                addItem    (size_t itemInstance,   std::string_view     at);
+    Item*                addItem    (size_t itemInstance, const Tempest::Vec3&      pos);
+    void                 removeItem (Item& it);
+
+    Interactive*         addInteractive(std::unique_ptr<Interactive>&& mob);
+    void                 addWayPoint(std::string_view name, const Tempest::Vec3& pos);
+
+  private:
+    const Tempest::Vec3* findPoint(std::string_view name) const;
+    void                 tickPerception();
+
+    std::unique_ptr<GameScript>                 game;
+    std::vector<std::unique_ptr<Npc>>           npcArr;
+    std::vector<std::unique_ptr<Item>>          itemArr;
+    std::vector<std::unique_ptr<Interactive>>   interactiveObj;
+    std::unordered_map<std::string, Tempest::Vec3> wayPoints;
+    Npc*                                        npcPlayer = nullptr;
+
+    gtime                                       wtime = gtime(1, 8, 0);
+    uint64_t                                    tickCnt = 0;
+    std::vector<Npc*>                           thinkNpc;
+    WorldObjects::NpcThink                      thinkMode = WorldObjects::NpcThink::Parallel;
+    WorldObjects::ThinkStats                    thinkSt;
+    WorldObjects::AiLod                         lod;
+    WorldObjects::AiLodStats                    lodSt;
+  };
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Stand-in for the zenkit symbol table, as far as ScriptEngine reads it: symbols keep their
+// values in place and are addressed by index; there is no bytecode.
+namespace zenkit {
+  enum class DaedalusDataType : uint32_t {
+    VOID      = 0,
+    FLOAT     = 1,
+    INT       = 2,
+    STRING    = 3,
+    CLASS     = 4,
+    FUNCTION  = 5,
+    PROTOTYPE = 6,
+    INSTANCE  = 7,
+    };
+
+  class DaedalusInstance {
+    public:
+      virtual ~DaedalusInstance() = default;
+
+      uint32_t symbol_index() const { return symbolIndex; }
+
+      void*    user_ptr = nullptr;
+
+    private:
+      uint32_t symbolIndex = uint32_t(-1);
+
+    friend class DaedalusVm;
+    };
+
+  class DaedalusSymbol final {
+    public:
+      const std::string& name()        const { return symName;  }
+      uint32_t           index()       const { return symIndex; }
+      uint32_t           count()       const { return symCount; }
+      uint32_t           parent()      const { return symParent; }
+      DaedalusDataType   type()        const { return symType;  }
+      DaedalusDataType   rtype()       const { return symRtype; }
+      uint32_t           address()     const { return symAddress; }
+      bool               is_const()    const { return isConst;  }
+      bool               is_external() const { return isExternal; }
+
+      int32_t            get_int   (uint16_t index = 0) const { return index<ints.size()    ? ints[index]    : 0;   }
+      float              get_float (uint16_t index = 0) const { return index<floats.size()  ? floats[index]  : 0.f; }
+      const std::string& get_string(uint16_t index = 0) const;
+      auto               get_instance() const -> const std::shared_ptr<DaedalusInstance>& { return instance; }
+
+      void               set_int     (int32_t v, uint16_t index = 0);
+      void               set_float   (float v,   uint16_t index = 0);
+      void               set_string  (std::string_view v, uint16_t index = 0);
+      void               set_instance(const std::shared_ptr<DaedalusInstance>& v) { instance = v; }
+
+    private:
+      std::string                       symName;
+      uint32_t                          symIndex   = 0;
+      uint32_t                          symCount   = 0;
+      uint32_t                          symParent  = uint32_t(-1);
+      DaedalusDataType                  symType    = DaedalusDataType::VOID;
+      DaedalusDataType                  symRtype   = DaedalusDataType::VOID;
+      uint32_t                          symAddress = 0;
+      bool                              isConst    = false;
+      bool                              isExternal = false;
+
+      std::vector<int32_t>              ints;
+      std::vector<float>                floats;
+      std::vector<std::string>          strings;
+      std::shared_ptr<DaedalusInstance> instance;
+
+    friend class DaedalusVm;
+    };
+  }
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "DaedalusScript.hh"
+
+// Stand-in for zenkit::DaedalusVm: the call interface ScriptEngine uses (value stack, unsafe_call,
+// externals, overrides, SELF/OTHER/VICTIM/ITEM) over a symbol table that is built in-process.
+// Script functions are C++ callables working on the value stack, like compiled Daedalus code would.
+namespace zenkit {
+  struct DaedalusNakedCall {};
+
+  class DaedalusVm final {
+    public:
+      using NakedFn = std::function<DaedalusNakedCall(DaedalusVm&)>;
+      using InitFn  = std::function<void(DaedalusInstance&)>;
+
+      DaedalusVm();
+      DaedalusVm(const DaedalusVm&) = delete;
+
+      DaedalusSymbol*         find_symbol_by_name (std::string_view name);
+      DaedalusSymbol*         find_symbol_by_index(uint32_t index);
+      std::span<DaedalusSymbol> find_parameters_for_function(const DaedalusSymbol* fn);
+      auto                    symbols() const -> const std::vector<DaedalusSymbol>& { return syms; }
+      // size of the code segment: script functions have an address below it
+      uint32_t                size() const { return uint32_t(code.size()); }
+
+      DaedalusSymbol*         global_self()   { return find_symbol_by_name("SELF");   }
+      DaedalusSymbol*         global_other()  { return find_symbol_by_name("OTHER");  }
+      DaedalusSymbol*         global_victim() { return find_symbol_by_name("VICTIM"); }
+      DaedalusSymbol*         global_item()   { return find_symbol_by_name("ITEM");   }
+
+      template<class T>
+      std::shared_ptr<T>      init_instance(DaedalusSymbol* sym) {
+        auto inst = std::make_shared<T>();
+        inst->symbolIndex = sym->index();
+        sym->instance     = inst;
+        initInstance(*sym, *inst);
+        return inst;
+        }
+
+      void                    push_int     (int32_t v);
+      void                    push_float   (float v);
+      void                    push_string  (std::string_view v);
+      void                    push_instance(std::shared_ptr<DaedalusInstance> v);
+      int32_t                 pop_int();
+      float                   pop_float();
+      const std::string&      pop_string();
+      auto                    pop_instance() -> std::shared_ptr<DaedalusInstance>;
+
+      // runs an override if there is one, else the external callback or the script function
+      void                    unsafe_call(const DaedalusSymbol* fn);
+      void                    register_external(std::string_view name, const NakedFn& fn);
+      template<class F>
+      void                    override_function(std::string_view name, const F& fn) { overrideFunction(name, NakedFn(fn)); }
+
+      // image builder of the runner
+      uint32_t                add_class   (std::string_view name);
+      // 'init' plays the part of the instance body and fills the fields on init_instance
+      uint32_t                add_instance(std::string_view name, uint32_t cls, InitFn init = nullptr);
+      uint32_t                add_var     (std::string_view name, DaedalusDataType type, uint32_t count = 1);
+      uint32_t                add_const   (std::string_view name, int32_t value);
+      uint32_t                add_function(std::string_view name, DaedalusDataType rtype,
+                                           std::initializer_list<DaedalusDataType> params, NakedFn body);
+      uint32_t                add_external(std::string_view name, DaedalusDataType rtype,
+                                           std::initializer_list<DaedalusDataType> params);
+
+    private:
+      struct Value {
+        DaedalusDataType                  type = DaedalusDataType::INT;
+        int32_t                           i    = 0;
+        float                             f    = 0;
+        std::string                       s;
+        std::shared_ptr<DaedalusInstance> inst;
+        };
+
+      DaedalusSymbol&         add(std::string_view name, DaedalusDataType type);
+      uint32_t                addFunction(std::string_view name, DaedalusDataType rtype,
+                                          std::initializer_list<DaedalusDataType> params);
+      void                    overrideFunction(std::string_view name, NakedFn fn);
+      void                    initInstance(const DaedalusSymbol& sym, DaedalusInstance& inst);
+      Value                   pop();
+
+      std::vector<DaedalusSymbol>               syms;
+      std::unordered_map<std::string, uint32_t> byName;
+      std::vector<NakedFn>                      code;
+      std::unordered_map<uint32_t, NakedFn>     externals;
+      std::unordered_map<uint32_t, NakedFn>     overrides;
+      std::unordered_map<uint32_t, InitFn>      inits;
+      std::vector<Value>                        stack;
+      std::string                               popped;
+    };
+  }
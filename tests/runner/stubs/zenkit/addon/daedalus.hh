@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "../DaedalusScript.hh"
+
+// Script classes of the runner: the fields of C_NPC, C_ITEM and C_SPELL that the stub world
+// and ScriptEngine read, under their zenkit names.
+namespace zenkit {
+  namespace DamageType {
+    static constexpr uint32_t NUM = 8;
+    }
+
+  struct INpc : DaedalusInstance {
+    int32_t     id                         = 0;
+    std::string name[5];
+    int32_t     attribute [8]              = {};
+    int32_t     hitchance [5]              = {};
+    int32_t     protection[DamageType::NUM] = {};
+    int32_t     damage_type                = 0;
+    int32_t     guild                      = 0;
+    int32_t     level                      = 0;
+    int32_t     exp                        = 0;
+    int32_t     lp                         = 0;
+    };
+
+  struct IItem : DaedalusInstance {
+    int32_t     id                         = 0;
+    std::string name;
+    std::string description;
+    int32_t     main_flag                  = 0;
+    int32_t     flags                      = 0;
+    int32_t     weight                     = 0;
+    int32_t     value                      = 0;
+    int32_t     damage_type                = 0;
+    int32_t     damage_total               = 0;
+    int32_t     protection[DamageType::NUM] = {};
+    int32_t     range                      = 0;
+    int32_t     amount                     = 1;
+    };
+
+  struct ISpell : DaedalusInstance {
+    float       time_per_mana              = 0;
+    int32_t     damage_per_level           = 0;
+    int32_t     damage_type                = 0;
+    int32_t     spell_type                 = 0;
+    };
+  }
@@ -0,0 +1,137 @@
+#include "stubscene.h"
+
+#include "world/world.h"
+#include "world/objects/npc.h"
+#include "world/objects/item.h"
+#include "world/objects/interactive.h"
+#include "game/constants.h"
+
+namespace {
+  using DT = zenkit::DaedalusDataType;
+
+  // instance bodies of the scene, as the C_NPC and C_ITEM prototypes would fill them
+  zenkit::DaedalusVm::InitFn npcBody(const char* name, int32_t hp, Guild guild) {
+    return [name, hp, guild](zenkit::DaedalusInstance& inst) {
+      auto& npc = static_cast<zenkit::INpc&>(inst);
+      npc.name[0] = name;
+      npc.guild   = int32_t(guild);
+      npc.level   = 1;
+      npc.attribute[ATR_HITPOINTS]    = hp;
+      npc.attribute[ATR_HITPOINTSMAX] = hp;
+      };
+    }
+
+  zenkit::DaedalusVm::InitFn itemBody(const char* name, int32_t value, int32_t mainFlag, int32_t flags,
+                                      void (*more)(zenkit::IItem&) = nullptr) {
+    return [name, value, mainFlag, flags, more](zenkit::DaedalusInstance& inst) {
+      auto& item = static_cast<zenkit::IItem&>(inst);
+      item.name      = name;
+      item.value     = value;
+      item.main_flag = mainFlag;
+      item.flags     = flags;
+      if(more!=nullptr)
+        more(item);
+      };
+    }
+  }
+
+void buildScene(World& world) {
+  auto& vm = world.script().getVm();
+
+  const uint32_t cNpc  = vm.add_class("C_NPC");
+  const uint32_t cItem = vm.add_class("C_ITEM");
+  const uint32_t cInfo = vm.add_class("C_INFO");
+  const uint32_t cMob  = vm.add_class("C_MOB");
+
+  const uint32_t pcHero    = vm.add_instance("PC_HERO",   cNpc, [](zenkit::DaedalusInstance& inst) {
+    npcBody("Hero", 40, GIL_NONE)(inst);
+    auto& npc = static_cast<zenkit::INpc&>(inst);
+    npc.attribute[ATR_MANA]      = 10;
+    npc.attribute[ATR_MANAMAX]   = 10;
+    npc.attribute[ATR_STRENGTH]  = 10;
+    npc.attribute[ATR_DEXTERITY] = 10;
+    });
+  const uint32_t scavenger = vm.add_instance("SCAVENGER", cNpc, npcBody("Scavenger", 35, GIL_SCAVENGER));
+  const uint32_t wolf      = vm.add_instance("WOLF",      cNpc, npcBody("Wolf",      60, GIL_WOLF));
+  const uint32_t apple     = vm.add_instance("ITFO_APPLE", cItem, itemBody("Apple", 8,  ITM_CAT_FOOD, 0));
+  const uint32_t bread     = vm.add_instance("ITFO_BREAD", cItem, itemBody("Bread", 12, ITM_CAT_FOOD, 0));
+  const uint32_t gold      = vm.add_instance("ITMI_GOLD",  cItem, itemBody("Gold",  1,  ITM_CAT_NONE, ITM_MULTI));
+  const uint32_t sword     = vm.add_instance("ITMW_SHORTSWORD", cItem, itemBody("Short Sword", 70, ITM_CAT_NF, ITM_SWD, [](zenkit::IItem& it) {
+    it.damage_total = 20;
+    it.damage_type  = 1 << PROT_EDGE;
+    it.range        = 80;
+    it.weight       = 2;
+    }));
+  const uint32_t armor     = vm.add_instance("ITAR_LEATHER_L",  cItem, itemBody("Leather Armor", 250, ITM_CAT_ARMOR, 0, [](zenkit::IItem& it) {
+    it.protection[PROT_EDGE]  = 15;
+    it.protection[PROT_POINT] = 15;
+    }));
+  vm.add_instance("MOB_CHEST",        cMob);
+  vm.add_instance("MOB_DOOR",         cMob);
+  vm.add_instance("INFO_HELLO",       cInfo);
+  vm.add_instance("INFO_TEST_WINDOW", cInfo);
+
+  for(auto name : {"SELF", "OTHER", "VICTIM", "ITEM"})
+    vm.add_var(name, DT::INSTANCE);
+  vm.find_symbol_by_index(vm.add_var("PLAYER_CHAPTER", DT::INT))->set_int(1);
+
+  vm.add_external("Npc_IsInState",      DT::INT,  {DT::INSTANCE, DT::INT});
+  vm.add_external("Npc_GetStateTime",   DT::INT,  {DT::INSTANCE});
+  vm.add_external("Hlp_StrCmp",         DT::INT,  {DT::STRING, DT::STRING});
+  vm.add_external("Log_CreateTopic",    DT::VOID, {DT::STRING, DT::INT});
+  vm.add_external("Log_AddEntry",       DT::VOID, {DT::STRING, DT::STRING});
+  vm.add_external("Log_SetTopicStatus", DT::VOID, {DT::STRING, DT::INT});
+  vm.add_function("B_GivePlayerXP", DT::VOID, {DT::INT}, [&world](zenkit::DaedalusVm& vm) {
+    const int32_t xp = vm.pop_int();
+    if(auto* pl = world.player())
+      pl->handle().exp += xp;
+    return zenkit::DaedalusNakedCall();
+    });
+  // replaced from Lua by test_lua_externals.lua
+  vm.add_function("TEST_LUAEXTERNAL", DT::INT, {DT::INSTANCE, DT::INT, DT::STRING}, [](zenkit::DaedalusVm& vm) {
+    vm.pop_string();
+    vm.pop_int();
+    vm.pop_instance();
+    vm.push_int(0);
+    return zenkit::DaedalusNakedCall();
+    });
+
+  world.script().setGoldId(vm.find_symbol_by_index(gold));
+
+  world.addWayPoint("START",        {0.f,    0.f, 0.f});
+  world.addWayPoint("WP_FOREST_01", {1500.f, 0.f, 800.f});
+
+  // player
+  Npc* hero = world.addNpc(pcHero, Tempest::Vec3(0.f, 0.f, 0.f));
+  world.setPlayer(hero);
+  hero->setAttitude(ATT_FRIENDLY);
+  hero->addItem(sword, 1);
+  hero->inventory().equip(sword, *hero, true);
+  hero->addItem(apple, 5);
+  hero->addItem(gold,  100);
+
+  // surroundings
+  world.addNpc(scavenger, Tempest::Vec3(600.f,  0.f, 400.f));
+  world.addNpc(scavenger, Tempest::Vec3(900.f,  0.f, -300.f));
+  world.addNpc(wolf,      Tempest::Vec3(2500.f, 0.f, 1200.f));
+  world.addItem(apple, Tempest::Vec3(150.f, 0.f, 100.f));
+  world.addItem(gold,  Tempest::Vec3(300.f, 0.f, -50.f));
+
+  Interactive::Desc chestDesc;
+  chestDesc.focusName = "Chest";
+  chestDesc.scheme    = "CHESTSMALL";
+  chestDesc.container = true;
+  chestDesc.pos       = Tempest::Vec3(200.f, 0.f, 200.f);
+  auto* chest = world.addInteractive(std::make_unique<Interactive>(world, std::move(chestDesc)));
+  chest->inventory().addItem(bread, 3,  world);
+  chest->inventory().addItem(gold,  25, world);
+  chest->inventory().addItem(armor, 1,  world);
+
+  Interactive::Desc doorDesc;
+  doorDesc.focusName = "Door";
+  doorDesc.scheme    = "DOOR_WOODEN";
+  doorDesc.door      = true;
+  doorDesc.locked    = true;
+  doorDesc.pos       = Tempest::Vec3(-400.f, 0.f, 0.f);
+  world.addInteractive(std::make_unique<Interactive>(world, std::move(doorDesc)));
+  }
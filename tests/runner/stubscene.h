@@ -0,0 +1,8 @@
+#pragma once
+
+class World;
+
+// Fills the script image and the world with the fixed scene the tests/lua suites expect:
+// Gothic 2 style symbols (PC_HERO, SCAVENGER, ITFO_APPLE, SELF/OTHER/VICTIM/ITEM, a few
+// externals), the player with gear, a handful of npcs, ground items, a chest and a door.
+void buildScene(World& world);
@@ -0,0 +1,254 @@
+#include <zenkit/DaedalusVm.hh>
+
+#include <cctype>
+#include <stdexcept>
+
+#include "game/gamescript.h"
+
+namespace {
+  // Daedalus symbol names are case-insensitive, the VM stores them upper-case
+  std::string upper(std::string_view name) {
+    std::string ret(name);
+    for(auto& c : ret)
+      c = char(std::toupper(uint8_t(c)));
+    return ret;
+    }
+  }
+
+using namespace zenkit;
+
+const std::string& DaedalusSymbol::get_string(uint16_t index) const {
+  static const std::string empty;
+  return index<strings.size() ? strings[index] : empty;
+  }
+
+void DaedalusSymbol::set_int(int32_t v, uint16_t index) {
+  if(index<ints.size())
+    ints[index] = v;
+  }
+
+void DaedalusSymbol::set_float(float v, uint16_t index) {
+  if(index<floats.size())
+    floats[index] = v;
+  }
+
+void DaedalusSymbol::set_string(std::string_view v, uint16_t index) {
+  if(index<strings.size())
+    strings[index] = v;
+  }
+
+DaedalusVm::DaedalusVm() {
+  }
+
+DaedalusSymbol* DaedalusVm::find_symbol_by_name(std::string_view name) {
+  auto it = byName.find(upper(name));
+  if(it==byName.end())
+    return nullptr;
+  return &syms[it->second];
+  }
+
+DaedalusSymbol* DaedalusVm::find_symbol_by_index(uint32_t index) {
+  if(index>=syms.size())
+    return nullptr;
+  return &syms[index];
+  }
+
+std::span<DaedalusSymbol> DaedalusVm::find_parameters_for_function(const DaedalusSymbol* fn) {
+  // as in zenkit, parameters are the symbols right after the function
+  if(fn==nullptr || fn->type()!=DaedalusDataType::FUNCTION)
+    return {};
+  return std::span<DaedalusSymbol>(syms.data()+fn->index()+1, fn->count());
+  }
+
+void DaedalusVm::push_int(int32_t v) {
+  Value x;
+  x.type = DaedalusDataType::INT;
+  x.i    = v;
+  stack.push_back(std::move(x));
+  }
+
+void DaedalusVm::push_float(float v) {
+  Value x;
+  x.type = DaedalusDataType::FLOAT;
+  x.f    = v;
+  stack.push_back(std::move(x));
+  }
+
+void DaedalusVm::push_string(std::string_view v) {
+  Value x;
+  x.type = DaedalusDataType::STRING;
+  x.s    = v;
+  stack.push_back(std::move(x));
+  }
+
+void DaedalusVm::push_instance(std::shared_ptr<DaedalusInstance> v) {
+  Value x;
+  x.type = DaedalusDataType::INSTANCE;
+  x.inst = std::move(v);
+  stack.push_back(std::move(x));
+  }
+
+DaedalusVm::Value DaedalusVm::pop() {
+  if(stack.empty())
+    throw std::runtime_error("stack underflow");
+  Value v = std::move(stack.back());
+  stack.pop_back();
+  return v;
+  }
+
+int32_t DaedalusVm::pop_int() {
+  auto v = pop();
+  return v.type==DaedalusDataType::FLOAT ? int32_t(v.f) : v.i;
+  }
+
+float DaedalusVm::pop_float() {
+  auto v = pop();
+  return v.type==DaedalusDataType::INT ? float(v.i) : v.f;
+  }
+
+const std::string& DaedalusVm::pop_string() {
+  popped = pop().s;
+  return popped;
+  }
+
+std::shared_ptr<DaedalusInstance> DaedalusVm::pop_instance() {
+  return pop().inst;
+  }
+
+void DaedalusVm::unsafe_call(const DaedalusSymbol* fn) {
+  if(fn==nullptr || fn->type()!=DaedalusDataType::FUNCTION)
+    throw std::runtime_error("not a function");
+
+  if(auto o = overrides.find(fn->index()); o!=overrides.end()) {
+    o->second(*this);
+    return;
+    }
+  if(fn->is_external()) {
+    auto e = externals.find(fn->index());
+    if(e==externals.end())
+      throw std::runtime_error("external '" + fn->name() + "' is not registered");
+    e->second(*this);
+    return;
+    }
+  code[fn->address()](*this);
+  }
+
+void DaedalusVm::register_external(std::string_view name, const NakedFn& fn) {
+  if(auto* sym = find_symbol_by_name(name))
+    externals[sym->index()] = fn;
+  }
+
+void DaedalusVm::overrideFunction(std::string_view name, NakedFn fn) {
+  if(auto* sym = find_symbol_by_name(name))
+    overrides[sym->index()] = std::move(fn);
+  }
+
+void DaedalusVm::initInstance(const DaedalusSymbol& sym, DaedalusInstance& inst) {
+  if(auto i = inits.find(sym.index()); i!=inits.end() && i->second)
+    i->second(inst);
+  }
+
+DaedalusSymbol& DaedalusVm::add(std::string_view name, DaedalusDataType type) {
+  DaedalusSymbol s;
+  s.symName  = upper(name);
+  s.symIndex = uint32_t(syms.size());
+  s.symType  = type;
+  s.symCount = 1;
+  byName[s.symName] = s.symIndex;
+  syms.push_back(std::move(s));
+  return syms.back();
+  }
+
+uint32_t DaedalusVm::add_class(std::string_view name) {
+  return add(name, DaedalusDataType::CLASS).index();
+  }
+
+uint32_t DaedalusVm::add_instance(std::string_view name, uint32_t cls, InitFn init) {
+  auto& s = add(name, DaedalusDataType::INSTANCE);
+  s.isConst   = true;
+  s.symParent = cls;
+  if(init)
+    inits[s.index()] = std::move(init);
+  return s.index();
+  }
+
+uint32_t DaedalusVm::add_var(std::string_view name, DaedalusDataType type, uint32_t count) {
+  auto& s = add(name, type);
+  s.symCount = count;
+  s.ints   .resize(type==DaedalusDataType::INT    ? count : 0);
+  s.floats .resize(type==DaedalusDataType::FLOAT  ? count : 0);
+  s.strings.resize(type==DaedalusDataType::STRING ? count : 0);
+  return s.index();
+  }
+
+uint32_t DaedalusVm::add_const(std::string_view name, int32_t value) {
+  const uint32_t id = add_var(name, DaedalusDataType::INT);
+  syms[id].isConst = true;
+  syms[id].ints[0] = value;
+  return id;
+  }
+
+uint32_t DaedalusVm::addFunction(std::string_view name, DaedalusDataType rtype,
+                                 std::initializer_list<DaedalusDataType> params) {
+  const uint32_t id = add(name, DaedalusDataType::FUNCTION).index();
+  syms[id].isConst  = true;
+  syms[id].symRtype = rtype;
+  syms[id].symCount = uint32_t(params.size());
+  uint32_t n = 0;
+  for(auto p : params)
+    add(std::string(name) + ".PAR" + std::to_string(n++), p);
+  return id;
+  }
+
+uint32_t DaedalusVm::add_function(std::string_view name, DaedalusDataType rtype,
+                                  std::initializer_list<DaedalusDataType> params, NakedFn body) {
+  const uint32_t id = addFunction(name, rtype, params);
+  syms[id].symAddress = uint32_t(code.size());
+  code.push_back(std::move(body));
+  return id;
+  }
+
+uint32_t DaedalusVm::add_external(std::string_view name, DaedalusDataType rtype,
+                                  std::initializer_list<DaedalusDataType> params) {
+  const uint32_t id = addFunction(name, rtype, params);
+  syms[id].isExternal = true;
+  syms[id].symAddress = uint32_t(-1);
+  return id;
+  }
+
+
+GameScript::GameScript() {
+  }
+
+zenkit::DaedalusSymbol* GameScript::findSymbol(std::string_view s) {
+  return vm.find_symbol_by_name(s);
+  }
+
+zenkit::DaedalusSymbol* GameScript::findSymbol(const size_t s) {
+  return vm.find_symbol_by_index(uint32_t(s));
+  }
+
+size_t GameScript::findSymbolIndex(std::string_view s) {
+  auto sym = vm.find_symbol_by_name(s);
+  return sym==nullptr ? size_t(-1) : sym->index();
+  }
+
+size_t GameScript::symbolsCount() const {
+  return vm.symbols().size();
+  }
+
+std::span<const uint32_t> GameScript::symbolsWithParent(size_t parent) {
+  auto it = symByParent.find(parent);
+  if(it==symByParent.end()) {
+    auto& ret = symByParent[parent];
+    for(auto& s : vm.symbols())
+      if(s.parent()==parent)
+        ret.push_back(s.index());
+    return ret;
+    }
+  return it->second;
+  }
+
+const zenkit::ISpell& GameScript::spellDesc(int32_t) {
+  return noSpell;
+  }
@@ -0,0 +1,784 @@
+#include "world/world.h"
+#include "world/objects/npc.h"
+#include "world/objects/item.h"
+#include "world/objects/interactive.h"
+#include "world/aiqueue.h"
+#include "game/damagecalculator.h"
+#include "game/inventory.h"
+#include "graphics/effect.h"
+#include "gothic.h"
+#include "utils/workers.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace Tempest;
+
+// inventory item is about to be destroyed: scripts may still hold it
+static void notifyItemRemove(const Item& it) {
+  if(Gothic::inst().onItemRemove)
+    Gothic::inst().onItemRemove(it);
+  }
+
+AiQueue::AiQueue() {
+  }
+
+void AiQueue::clear() {
+  aiActions.clear();
+  }
+
+void AiQueue::pushBack(AiAction&& a) {
+  aiActions.emplace_back(std::move(a));
+  }
+
+AiQueue::AiAction AiQueue::aiAttack() {
+  AiAction a;
+  a.act = AI_Attack;
+  return a;
+  }
+
+AiQueue::AiAction AiQueue::aiFlee() {
+  AiAction a;
+  a.act = AI_Flee;
+  return a;
+  }
+
+
+DamageCalculator::Val DamageCalculator::damageValue(Npc&, Npc& other, const Bullet*, bool, const DamageCalculator::Damage& splDmg, const CollideMask) {
+  // no weapons or bullets to simulate: the damage array against the victim protection
+  int32_t value = 0;
+  for(uint8_t i=0; i<PROT_MAX; ++i)
+    value += std::max(0, splDmg.val[i]-other.protection(Protection(i)));
+  return Val(value,value>0);
+  }
+
+int32_t DamageCalculator::damageTypeMask(Npc& npc) {
+  if(auto w = npc.inventory().activeWeapon())
+    return w->handle().damage_type;
+  return npc.handle().damage_type;
+  }
+
+
+Effect::Effect(const VisualFx& vfx, World&, const Vec3& pos)
+  :root(&vfx), pos(pos) {
+  }
+
+
+Inventory::Inventory() {
+  }
+
+Inventory::~Inventory() {
+  }
+
+const Item& Inventory::Iterator::operator*() const {
+  return *owner->items[at];
+  }
+
+const Item* Inventory::Iterator::operator->() const {
+  return owner->items[at].get();
+  }
+
+size_t Inventory::Iterator::count() const {
+  return owner->items[at]->count();
+  }
+
+bool Inventory::Iterator::isEquipped() const {
+  return owner->items[at]->isEquipped();
+  }
+
+Inventory::Iterator& Inventory::Iterator::operator++() {
+  ++at;
+  skipHidden();
+  return *this;
+  }
+
+bool Inventory::Iterator::isValid() const {
+  return at<owner->items.size();
+  }
+
+Inventory::Iterator::Iterator(IteratorType t, const Inventory* owner)
+  :type(t), owner(owner) {
+  skipHidden();
+  }
+
+void Inventory::Iterator::skipHidden() {
+  auto& it = owner->items;
+  if(type==T_Trade) {
+    while(at<it.size() && (it[at]->isEquipped() || it[at]->isGold()))
+      ++at;
+    }
+  if(type==T_Ransack) {
+    while(at<it.size() && it[at]->isEquipped())
+      ++at;
+    }
+  }
+
+Inventory::Iterator Inventory::iterator(IteratorType t) const {
+  return Iterator(t,this);
+  }
+
+size_t Inventory::itemCount(const size_t id) const {
+  for(auto& i:items)
+    if(i->clsId()==id)
+      return i->count();
+  return 0;
+  }
+
+void Inventory::transfer(Inventory& to, Inventory& from, Npc*, size_t itemSymbol, size_t count, World& wrld) {
+  if(&to==&from)
+    return;
+  for(size_t i=0; i<from.items.size(); ++i) {
+    auto& it = *from.items[i];
+    if(it.clsId()!=itemSymbol)
+      continue;
+
+    if(count>it.count())
+      count = it.count();
+
+    if(it.count()==count) {
+      from.items[i]->setAsEquipped(false);
+      to.addItem(std::move(from.items[i]));
+      from.items.erase(from.items.begin()+int(i));
+      } else {
+      it.setCount(it.count()-count);
+      to.addItem(itemSymbol,count,wrld);
+      }
+    return;
+    }
+  }
+
+Item* Inventory::getItem(size_t instance) {
+  for(auto& i:items)
+    if(i->clsId()==instance)
+      return i.get();
+  return nullptr;
+  }
+
+Item* Inventory::addItem(std::unique_ptr<Item>&& p) {
+  if(p==nullptr)
+    return nullptr;
+  Item* it = getItem(p->clsId());
+  if(it==nullptr) {
+    items.emplace_back(std::move(p));
+    return items.back().get();
+    }
+  it->setCount(it->count()+p->count());
+  notifyItemRemove(*p);
+  return it;
+  }
+
+Item* Inventory::addItem(size_t cls, size_t count, World& owner) {
+  if(count<=0)
+    return nullptr;
+  if(Item* it = getItem(cls)) {
+    it->setCount(it->count()+count);
+    return it;
+    }
+  try {
+    std::unique_ptr<Item> ptr{new Item(owner,cls,Item::T_Inventory)};
+    ptr->setCount(count);
+    items.emplace_back(std::move(ptr));
+    return items.back().get();
+    }
+  catch(const std::runtime_error&) {
+    return nullptr;
+    }
+  }
+
+bool Inventory::equip(size_t cls, Npc&, bool) {
+  Item* it = getItem(cls);
+  if(it==nullptr)
+    return false;
+  it->setAsEquipped(true);
+  return true;
+  }
+
+const Item* Inventory::activeWeapon() const {
+  for(auto& i:items)
+    if(i->isEquipped() && (i->mainFlag() & (ITM_CAT_NF | ITM_CAT_FF)))
+      return i.get();
+  return nullptr;
+  }
+
+Item* Inventory::activeWeapon() {
+  return const_cast<Item*>(static_cast<const Inventory&>(*this).activeWeapon());
+  }
+
+
+Item::Item(World& owner, size_t inst, Type)
+  :owner(owner) {
+  auto* sym = owner.script().findSymbol(inst);
+  if(sym==nullptr || sym->type()!=zenkit::DaedalusDataType::INSTANCE)
+    throw std::runtime_error("invalid item instance");
+  hitem = owner.script().getVm().init_instance<zenkit::IItem>(sym);
+  hitem->user_ptr = this;
+  amount          = size_t(std::max(1, hitem->amount));
+  }
+
+Item::~Item() {
+  }
+
+bool Item::isMission() const {
+  return (hitem->flags & ITM_MISSION);
+  }
+
+std::string_view Item::displayName() const {
+  return hitem->name;
+  }
+
+std::string_view Item::description() const {
+  return hitem->description;
+  }
+
+bool Item::isGold() const {
+  auto* gold = owner.script().goldId();
+  return gold!=nullptr && clsId()==gold->index();
+  }
+
+ItmFlags Item::mainFlag() const {
+  return ItmFlags(hitem->main_flag);
+  }
+
+int32_t Item::itemFlag() const {
+  return hitem->flags;
+  }
+
+bool Item::isMulti() const {
+  return (hitem->flags & ITM_MULTI);
+  }
+
+bool Item::is2H() const {
+  return (hitem->flags & (ITM_2HD_SWD | ITM_2HD_AXE));
+  }
+
+bool Item::isCrossbow() const {
+  return (hitem->flags & ITM_CROSSBOW);
+  }
+
+bool Item::isRing() const {
+  return (hitem->flags & ITM_RING);
+  }
+
+bool Item::isArmor() const {
+  return (hitem->main_flag & ITM_CAT_ARMOR);
+  }
+
+bool Item::isSpellShoot() const {
+  return isSpell();
+  }
+
+bool Item::isSpellOrRune() const {
+  return (hitem->main_flag & ITM_CAT_RUNE);
+  }
+
+bool Item::isSpell() const {
+  return isSpellOrRune() && (hitem->flags & ITM_MULTI);
+  }
+
+bool Item::isRune() const {
+  return isSpellOrRune() && !isSpell();
+  }
+
+void Item::setCount(size_t cnt) {
+  amount = cnt;
+  }
+
+size_t Item::count() const {
+  return amount;
+  }
+
+int32_t Item::cost() const {
+  return hitem->value;
+  }
+
+int32_t Item::sellCost() const {
+  return int32_t(std::ceil(owner.script().tradeValueMultiplier()*float(hitem->value)));
+  }
+
+size_t Item::clsId() const {
+  return hitem->symbol_index();
+  }
+
+
+Npc::Npc(World& owner, size_t instance, NpcProcessPolicy aiPolicy)
+  :owner(owner), aiPolicy(aiPolicy) {
+  auto* sym = owner.script().findSymbol(instance);
+  if(sym==nullptr || sym->type()!=zenkit::DaedalusDataType::INSTANCE)
+    throw std::runtime_error("invalid npc instance");
+  hnpc = owner.script().getVm().init_instance<zenkit::INpc>(sym);
+  hnpc->user_ptr = this;
+  }
+
+Npc::~Npc() {
+  }
+
+bool Npc::setPosition(float x, float y, float z) {
+  return setPosition(Vec3(x,y,z));
+  }
+
+bool Npc::setPosition(const Vec3& p) {
+  if(pos.x==p.x && pos.y==p.y && pos.z==p.z)
+    return false;
+  pos = p;
+  return true;
+  }
+
+void Npc::setDirectionY(float rotation) {
+  angleY = std::clamp(rotation,-90.f,90.f);
+  }
+
+bool Npc::isPlayer() const {
+  return aiPolicy==NpcProcessPolicy::Player;
+  }
+
+float Npc::qDistTo(const Vec3 p) const {
+  return (p-pos).quadLength();
+  }
+
+float Npc::qDistTo(const Npc& p) const {
+  return qDistTo(p.position());
+  }
+
+float Npc::qDistTo(const Interactive& p) const {
+  return qDistTo(p.position());
+  }
+
+float Npc::qDistTo(const Item& p) const {
+  return qDistTo(p.position());
+  }
+
+std::string_view Npc::displayName() const {
+  return hnpc->name[0];
+  }
+
+void Npc::setTalentSkill(Talent t, int32_t lvl) {
+  if(t<TALENT_MAX_G2)
+    talentsSk[t] = lvl;
+  }
+
+int32_t Npc::talentSkill(Talent t) const {
+  if(t<TALENT_MAX_G2)
+    return talentsSk[t];
+  return 0;
+  }
+
+void Npc::setTalentValue(Talent t, int32_t lvl) {
+  if(t<TALENT_MAX_G2)
+    talentsVl[t] = lvl;
+  }
+
+int32_t Npc::talentValue(Talent t) const {
+  if(t<TALENT_MAX_G2)
+    return talentsVl[t];
+  return 0;
+  }
+
+int32_t Npc::hitChance(Talent t) const {
+  if(t<std::size(hnpc->hitchance))
+    return hnpc->hitchance[t];
+  return 0;
+  }
+
+int32_t Npc::attribute(Attribute a) const {
+  if(a<ATR_MAX)
+    return hnpc->attribute[a];
+  return 0;
+  }
+
+void Npc::changeAttribute(Attribute a, int32_t val, bool /*allowUnconscious*/) {
+  if(a>=ATR_MAX || val==0 || dead)
+    return;
+
+  hnpc->attribute[a]+=val;
+  if(hnpc->attribute[a]<0)
+    hnpc->attribute[a]=0;
+  if(a==ATR_HITPOINTS && hnpc->attribute[a]>hnpc->attribute[ATR_HITPOINTSMAX])
+    hnpc->attribute[a] = hnpc->attribute[ATR_HITPOINTSMAX];
+  if(a==ATR_MANA && hnpc->attribute[a]>hnpc->attribute[ATR_MANAMAX])
+    hnpc->attribute[a] = hnpc->attribute[ATR_MANAMAX];
+
+  if(a==ATR_HITPOINTS && hnpc->attribute[a]==0) {
+    // no killer and no unconscious state in the runner: zero hitpoints is death
+    if(Gothic::inst().onNpcDeath && Gothic::inst().onNpcDeath(*this,nullptr,true))
+      return;
+    dead = true;
+    }
+  }
+
+int32_t Npc::protection(Protection p) const {
+  if(p<PROT_MAX)
+    return hnpc->protection[p];
+  return 0;
+  }
+
+void Npc::changeProtection(Protection p, int32_t val) {
+  if(p<PROT_MAX)
+    hnpc->protection[p]=val;
+  }
+
+uint32_t Npc::instanceSymbol() const {
+  return uint32_t(hnpc->symbol_index());
+  }
+
+uint32_t Npc::guild() const {
+  return std::min(uint32_t(hnpc->guild), uint32_t(GIL_MAX-1));
+  }
+
+int32_t Npc::level() const {
+  return hnpc->level;
+  }
+
+int32_t Npc::experience() const {
+  return hnpc->exp;
+  }
+
+int32_t Npc::learningPoints() const {
+  return hnpc->lp;
+  }
+
+bool Npc::hasState(BodyState s) const {
+  return bodySt==s;
+  }
+
+void Npc::aiPush(AiQueue::AiAction&& a) {
+  aiQueue.pushBack(std::move(a));
+  }
+
+void Npc::clearAiQueue() {
+  aiQueue.clear();
+  }
+
+size_t Npc::itemCount(size_t id) const {
+  return invent.itemCount(id);
+  }
+
+Item* Npc::activeWeapon() {
+  return invent.activeWeapon();
+  }
+
+Item* Npc::getItem(size_t id) {
+  return invent.getItem(id);
+  }
+
+Item* Npc::addItem(size_t id, size_t amount) {
+  return invent.addItem(id,amount,owner);
+  }
+
+Item* Npc::addItem(std::unique_ptr<Item>&& i) {
+  return invent.addItem(std::move(i));
+  }
+
+void Npc::runEffect(Effect&& e) {
+  owner.runEffect(std::move(e));
+  }
+
+bool Npc::canSeeNpc(const Npc& pl) const {
+  const float range = 2000.f;
+  if(qDistTo(pl)>range*range)
+    return false;
+  const Vec3 eye = pos           + Vec3(0,180.f,0);
+  const Vec3 at  = pl.position() + Vec3(0,180.f,0);
+  return !sense.ray(owner.tickCount(),eye,at,[this](const Vec3& a, const Vec3& b){
+    return owner.ray(a,b);
+    });
+  }
+
+void Npc::thinkPerception(const Npc& pl, bool verify) {
+  sense.begin(owner.tickCount());
+  if(percEnabled)
+    canSeeNpc(pl);
+  sense.end(verify);
+  }
+
+void Npc::perceptionProcess(const Npc& pl) {
+  percNext = owner.tickCount() + perceptionTime;
+  if(!percEnabled)
+    return;
+  const Vec3  d    = pl.position()-pos;
+  const float len  = d.length();
+  const float step = 20.f;
+  if(len<1.f)
+    return;
+  if(canSeeNpc(pl)) {
+    if(len>150.f)
+      pos = pos + d*(step/len);
+    } else {
+    pos = pos + Vec3(-d.z,0,d.x)*(step/len);
+    }
+  angle = std::atan2(d.x,d.z)*180.f/float(M_PI);
+  }
+
+
+Interactive::Interactive(World&, Desc&& d)
+  :desc(std::move(d)) {
+  }
+
+bool Interactive::isTrueDoor(const Npc&) const {
+  return desc.door;
+  }
+
+bool Interactive::needToLockpick(const Npc&) const {
+  return desc.locked && !isLockCracked;
+  }
+
+float Interactive::qDistTo(const Npc& npc) const {
+  return npc.qDistTo(*this);
+  }
+
+bool Interactive::attach(Npc&) {
+  if(state!=0)
+    return false;
+  state = 1;
+  return true;
+  }
+
+bool Interactive::detach(Npc&, bool) {
+  if(state==0)
+    return false;
+  state = 0;
+  return true;
+  }
+
+
+World::World()
+  :game(new GameScript()) {
+  }
+
+World::~World() {
+  }
+
+Npc* World::npcById(uint32_t id) {
+  if(id<npcArr.size())
+    return npcArr[id].get();
+  return nullptr;
+  }
+
+Interactive* World::mobsiById(uint32_t id) {
+  if(id<interactiveObj.size())
+    return interactiveObj[id].get();
+  return nullptr;
+  }
+
+void World::detectNpc(const Vec3& p, const float r, const std::function<void(Npc&)>& f) {
+  for(size_t i=0; i<npcArr.size(); ++i) {
+    auto& npc = *npcArr[i];
+    if(npc.qDistTo(p)<=r*r)
+      f(npc);
+    }
+  }
+
+void World::findNearestNpcs(const Vec3& p, const float r, size_t k, const Npc* exclude, std::vector<Npc*>& out) const {
+  out.clear();
+  for(auto& npc : npcArr)
+    if(npc.get()!=exclude && npc->qDistTo(p)<=r*r)
+      out.push_back(npc.get());
+  std::sort(out.begin(), out.end(), [&p](Npc* a, Npc* b) {
+    return a->qDistTo(p) < b->qDistTo(p);
+    });
+  if(out.size()>k)
+    out.resize(k);
+  }
+
+void World::detectItem(const Vec3& p, const float r, const std::function<void(Item&)>& f) {
+  for(size_t i=0; i<itemArr.size(); ++i) {
+    auto& it = *itemArr[i];
+    if((it.position()-p).quadLength()<=r*r)
+      f(it);
+    }
+  }
+
+uint64_t World::stateHash() const {
+  uint64_t h   = 14695981039346656037ull;
+  auto     mix = [&h](const void* data, size_t size) {
+    auto b = reinterpret_cast<const uint8_t*>(data);
+    for(size_t i=0; i<size; ++i) {
+      h ^= b[i];
+      h *= 1099511628211ull;
+      }
+    };
+  for(auto& npc : npcArr) {
+    const auto    p     = npc->position();
+    const float   pos[] = {p.x, p.y, p.z, npc->rotation()};
+    const int32_t val[] = {npc->attribute(ATR_HITPOINTS), npc->attribute(ATR_MANA),
+                           int32_t(npc->bodyState()), npc->isDead() ? 1 : 0};
+    mix(pos, sizeof(pos));
+    mix(val, sizeof(val));
+    }
+  return h;
+  }
+
+void World::runEffect(Effect&&) {
+  }
+
+void World::setPlayer(Npc* npc) {
+  if(npcPlayer!=nullptr)
+    npcPlayer->setProcessPolicy(NpcProcessPolicy::AiNormal);
+  npcPlayer = npc;
+  if(npcPlayer!=nullptr)
+    npcPlayer->setProcessPolicy(NpcProcessPolicy::Player);
+  }
+
+Npc* World::findNpcByInstance(size_t instance, size_t n) {
+  for(auto& npc : npcArr)
+    if(npc->instanceSymbol()==instance && n--==0)
+      return npc.get();
+  return nullptr;
+  }
+
+Item* World::findItemByInstance(size_t instance, size_t n) {
+  for(auto& it : itemArr)
+    if(it->clsId()==instance && n--==0)
+      return it.get();
+  return nullptr;
+  }
+
+bool World::ray(const Vec3& from, const Vec3& to) const {
+  // interactives block as spheres around their middle
+  const float r = 120.f;
+  const Vec3  d = to-from;
+  const float l = Vec3::dotProduct(d,d);
+  for(auto& i:interactiveObj) {
+    const Vec3 c = i->position() + Vec3(0,100.f,0);
+    const float t = l>0 ? std::clamp(Vec3::dotProduct(c-from,d)/l,0.f,1.f) : 0.f;
+    if((from+d*t-c).quadLength()<r*r)
+      return true;
+    }
+  return false;
+  }
+
+void World::tick(uint64_t dt) {
+  ++lodSt.frames;
+  tickCnt += dt;
+  wtime.addMilis(dt*60);
+  tickPerception();
+  }
+
+// perception pass of WorldObjects::tick: npc's near the player that are due cast their rays
+// ahead on the workers, then perceive one after another in npc order
+void World::tickPerception() {
+  thinkNpc.clear();
+  if(npcPlayer==nullptr)
+    return;
+  const Npc&  pl       = *npcPlayer;
+  const float nearDist = 3000*3000;
+  for(auto& i:npcArr) {
+    if(i->isPlayer() || i->isDead() || i->qDistTo(pl)>=nearDist)
+      continue;
+    if(i->percNextTime()<=tickCnt)
+      thinkNpc.push_back(i.get());
+    }
+
+  const bool ahead  = (thinkMode!=WorldObjects::NpcThink::Serial);
+  const bool verify = (thinkMode==WorldObjects::NpcThink::Verify);
+  if(ahead) {
+    Workers::parallelTasks(thinkNpc.size(),[this,&pl,verify](size_t i){
+      thinkNpc[i]->thinkPerception(pl,verify);
+      });
+    }
+  for(auto npc:thinkNpc)
+    npc->perceptionProcess(pl);
+
+  thinkSt.ticks++;
+  if(!ahead)
+    return;
+  for(auto npc:thinkNpc) {
+    auto& st = npc->senseStats();
+    thinkSt.npcs++;
+    thinkSt.thinkRays  += st.thinkRays;
+    thinkSt.hits       += st.hits;
+    thinkSt.misses     += st.misses;
+    thinkSt.mismatches += st.mismatches;
+    if(verify) {
+      thinkSt.serialHash   = (thinkSt.serialHash  ^st.serialHash  )*1099511628211ull;
+      thinkSt.parallelHash = (thinkSt.parallelHash^st.parallelHash)*1099511628211ull;
+      }
+    }
+  }
+
+void World::setDayTime(int32_t h, int32_t min) {
+  wtime = gtime(wtime.day(), std::clamp(h,0,23), std::clamp(min,0,59));
+  }
+
+Npc* World::addNpc(size_t npcInstance, std::string_view at) {
+  auto* p = findPoint(at);
+  if(p==nullptr)
+    return nullptr;
+  return addNpc(npcInstance,*p);
+  }
+
+Npc* World::addNpc(size_t npcInstance, const Vec3& at) {
+  std::unique_ptr<Npc> npc;
+  try {
+    npc.reset(new Npc(*this,npcInstance));
+    }
+  catch(const std::runtime_error&) {
+    return nullptr;
+    }
+  npc->setPosition(at);
+  npcArr.emplace_back(std::move(npc));
+  auto* ret = npcArr.back().get();
+  if(Gothic::inst().onNpcSpawn)
+    Gothic::inst().onNpcSpawn(*ret);
+  return ret;
+  }
+
+void World::removeNpc(Npc& npc) {
+  if(&npc==npcPlayer)
+    return;
+  auto it = std::find_if(npcArr.begin(), npcArr.end(), [&npc](auto& n) { return n.get()==&npc; });
+  if(it==npcArr.end())
+    return;
+  for(auto& n : npcArr)
+    if(n->target()==&npc)
+      n->setTarget(nullptr);
+  if(Gothic::inst().onNpcRemove)
+    Gothic::inst().onNpcRemove(npc);
+  for(auto i = npc.inventory().iterator(Inventory::T_Inventory); i.isValid(); ++i)
+    notifyItemRemove(*i);
+  npcArr.erase(it);
+  }
+
+Item* World::addItem(size_t itemInstance, std::string_view at) {
+  auto* p = findPoint(at);
+  if(p==nullptr)
+    return nullptr;
+  return addItem(itemInstance,*p);
+  }
+
+Item* World::addItem(size_t itemInstance, const Vec3& pos) {
+  std::unique_ptr<Item> it;
+  try {
+    it.reset(new Item(*this,itemInstance,Item::T_World));
+    }
+  catch(const std::runtime_error&) {
+    return nullptr;
+    }
+  it->setPosition(pos.x,pos.y,pos.z);
+  itemArr.emplace_back(std::move(it));
+  return itemArr.back().get();
+  }
+
+void World::removeItem(Item& it) {
+  auto i = std::find_if(itemArr.begin(), itemArr.end(), [&it](auto& p) { return p.get()==&it; });
+  if(i==itemArr.end())
+    return;
+  notifyItemRemove(it);
+  itemArr.erase(i);
+  }
+
+Interactive* World::addInteractive(std::unique_ptr<Interactive>&& mob) {
+  interactiveObj.emplace_back(std::move(mob));
+  return interactiveObj.back().get();
+  }
+
+void World::addWayPoint(std::string_view name, const Vec3& pos) {
+  wayPoints[std::string(name)] = pos;
+  }
+
+const Vec3* World::findPoint(std::string_view name) const {
+  auto it = wayPoints.find(std::string(name));
+  if(it==wayPoints.end())
+    return nullptr;
+  return &it->second;
+  }